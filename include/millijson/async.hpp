@@ -0,0 +1,335 @@
+#ifndef MILLIJSON_ASYNC_HPP
+#define MILLIJSON_ASYNC_HPP
+
+#include "millijson.hpp"
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file async.hpp
+ * @brief Asynchronous parsing of JSON files and strings.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Parse JSON files and strings on worker threads.
+ *
+ * Parsing is performed on an internal thread pool or on a user-supplied executor, so that the calling thread is not blocked.
+ * Completion can be signalled in three ways:
+ *
+ * - By returning a `std::future`.
+ * - By invoking a callback on the worker thread.
+ * - By queueing a callback to be run on the caller's thread by `dispatch()`.
+ *   On Linux, each queued completion also increments an eventfd, which can be registered with `epoll()` or `poll()` to determine when to call `dispatch()`.
+ *
+ * Destruction of an `AsyncParser` blocks until all submitted jobs are complete.
+ */
+class AsyncParser {
+public:
+    /**
+     * Function that accepts a task and runs it, typically on another thread.
+     */
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    /**
+     * Function to be called on completion.
+     * The first argument contains the parsed JSON value, and the second argument contains any exception raised during parsing.
+     * Exactly one of these arguments will be non-NULL.
+     * Exceptions thrown by callbacks that run on a worker thread are discarded,
+     * while exceptions thrown by callbacks in `dispatch()` are propagated to its caller.
+     */
+    typedef std::function<void(std::shared_ptr<Base>, std::exception_ptr)> Callback;
+
+public:
+    /**
+     * @param num_threads Number of threads in the internal thread pool.
+     */
+    AsyncParser(size_t num_threads = 1) {
+        initialize();
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+        my_workers.reserve(num_threads);
+        for (size_t t = 0; t < num_threads; ++t) {
+            my_workers.emplace_back([this]() -> void { work(); });
+        }
+    }
+
+    /**
+     * @param executor User-supplied executor, e.g., to submit tasks to an existing thread pool.
+     */
+    AsyncParser(Executor executor) : my_executor(std::move(executor)) {
+        initialize();
+    }
+
+    /**
+     * @cond
+     */
+    AsyncParser(const AsyncParser&) = delete;
+    AsyncParser& operator=(const AsyncParser&) = delete;
+
+    ~AsyncParser() {
+        {
+            std::unique_lock<std::mutex> lck(my_mutex);
+            my_idle.wait(lck, [&]() -> bool { return my_outstanding == 0; });
+            my_stop = true;
+        }
+        my_ready.notify_all();
+        for (auto& w : my_workers) {
+            w.join();
+        }
+
+#if defined(__linux__)
+        if (my_fd >= 0) {
+            ::close(my_fd);
+        }
+#endif
+    }
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param path Path to a JSON file.
+     * @param buffer_size Size of the buffer to use for reading the file.
+     * @return Future containing a pointer to the parsed JSON value.
+     */
+    std::future<std::shared_ptr<Base> > parse_file_async(std::string path, size_t buffer_size = 65536) {
+        return submit_future([path = std::move(path), buffer_size]() -> std::shared_ptr<Base> { return parse_file(path.c_str(), buffer_size); });
+    }
+
+    /**
+     * @param path Path to a JSON file.
+     * @param callback Function to be called on the worker thread after parsing is complete.
+     * @param buffer_size Size of the buffer to use for reading the file.
+     */
+    void parse_file_async(std::string path, Callback callback, size_t buffer_size = 65536) {
+        submit_callback([path = std::move(path), buffer_size]() -> std::shared_ptr<Base> { return parse_file(path.c_str(), buffer_size); }, std::move(callback), false);
+    }
+
+    /**
+     * @param path Path to a JSON file.
+     * @param callback Function to be called by `dispatch()` after parsing is complete.
+     * @param buffer_size Size of the buffer to use for reading the file.
+     */
+    void parse_file_queued(std::string path, Callback callback, size_t buffer_size = 65536) {
+        submit_callback([path = std::move(path), buffer_size]() -> std::shared_ptr<Base> { return parse_file(path.c_str(), buffer_size); }, std::move(callback), true);
+    }
+
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * This should remain valid until parsing is complete.
+     * @param len Length of the array.
+     * @return Future containing a pointer to the parsed JSON value.
+     */
+    std::future<std::shared_ptr<Base> > parse_string_async(const char* ptr, size_t len) {
+        return submit_future([ptr, len]() -> std::shared_ptr<Base> { return parse_string(ptr, len); });
+    }
+
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * This should remain valid until parsing is complete.
+     * @param len Length of the array.
+     * @param callback Function to be called on the worker thread after parsing is complete.
+     */
+    void parse_string_async(const char* ptr, size_t len, Callback callback) {
+        submit_callback([ptr, len]() -> std::shared_ptr<Base> { return parse_string(ptr, len); }, std::move(callback), false);
+    }
+
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * This should remain valid until parsing is complete.
+     * @param len Length of the array.
+     * @param callback Function to be called by `dispatch()` after parsing is complete.
+     */
+    void parse_string_queued(const char* ptr, size_t len, Callback callback) {
+        submit_callback([ptr, len]() -> std::shared_ptr<Base> { return parse_string(ptr, len); }, std::move(callback), true);
+    }
+
+public:
+    /**
+     * @return File descriptor of an eventfd that becomes readable when queued callbacks are available for `dispatch()`.
+     * This is -1 on platforms without eventfd support.
+     */
+    int event_fd() const {
+        return my_fd;
+    }
+
+    /**
+     * Run all queued callbacks from `parse_file_queued()` and `parse_string_queued()` whose parsing is complete.
+     * This should be called on the thread that is to handle the parsed values, e.g., the event loop.
+     *
+     * All callbacks are run even if some of them throw.
+     * The first exception is then rethrown to the caller, after which the queue is empty.
+     *
+     * @return Number of callbacks that were run.
+     */
+    size_t dispatch() {
+        std::deque<std::function<void()> > completed;
+        {
+            std::lock_guard<std::mutex> lck(my_mutex);
+            completed.swap(my_completed);
+#if defined(__linux__)
+            if (my_fd >= 0) {
+                eventfd_t discard;
+                ::eventfd_read(my_fd, &discard);
+            }
+#endif
+        }
+
+        std::exception_ptr first;
+        for (auto& fun : completed) {
+            try {
+                fun();
+            } catch (...) {
+                if (!first) {
+                    first = std::current_exception();
+                }
+            }
+        }
+        if (first) {
+            std::rethrow_exception(first);
+        }
+        return completed.size();
+    }
+
+private:
+    Executor my_executor;
+    std::vector<std::thread> my_workers;
+
+    std::mutex my_mutex;
+    std::condition_variable my_ready, my_idle;
+    std::deque<std::function<void()> > my_tasks;
+    std::deque<std::function<void()> > my_completed;
+    size_t my_outstanding = 0;
+    bool my_stop = false;
+    int my_fd = -1;
+
+    void initialize() {
+#if defined(__linux__)
+        my_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (my_fd < 0) {
+            throw std::runtime_error("failed to create an eventfd");
+        }
+#endif
+    }
+
+    void work() {
+        while (1) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lck(my_mutex);
+                my_ready.wait(lck, [&]() -> bool { return my_stop || !my_tasks.empty(); });
+                if (my_tasks.empty()) {
+                    return;
+                }
+                task = std::move(my_tasks.front());
+                my_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    void run(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lck(my_mutex);
+            ++my_outstanding;
+        }
+
+        auto wrapped = [this, task = std::move(task)]() -> void {
+            try {
+                task();
+            } catch (...) {
+                // Nowhere to report this, but we must still decrement the counter so that the destructor doesn't wait forever.
+            }
+
+            // Notifying while holding the lock, as the destructor could otherwise return and destroy 'my_idle' before notify_all() is called.
+            std::lock_guard<std::mutex> lck(my_mutex);
+            --my_outstanding;
+            my_idle.notify_all();
+        };
+
+        if (my_executor) {
+            try {
+                my_executor(std::move(wrapped));
+            } catch (...) {
+                // Assuming that the task was not submitted, so it will never decrement the counter itself.
+                std::lock_guard<std::mutex> lck(my_mutex);
+                --my_outstanding;
+                my_idle.notify_all();
+                throw;
+            }
+        } else {
+            {
+                std::lock_guard<std::mutex> lck(my_mutex);
+                my_tasks.push_back(std::move(wrapped));
+            }
+            my_ready.notify_one();
+        }
+    }
+
+    template<class Function_>
+    std::future<std::shared_ptr<Base> > submit_future(Function_ fun) {
+        auto promise = std::make_shared<std::promise<std::shared_ptr<Base> > >();
+        auto output = promise->get_future();
+        run([fun = std::move(fun), promise]() -> void {
+            try {
+                promise->set_value(fun());
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return output;
+    }
+
+    template<class Function_>
+    void submit_callback(Function_ fun, Callback callback, bool queued) {
+        run([this, fun = std::move(fun), callback = std::move(callback), queued]() -> void {
+            std::shared_ptr<Base> result;
+            std::exception_ptr error;
+            try {
+                result = fun();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            if (!queued) {
+                try {
+                    callback(std::move(result), std::move(error));
+                } catch (...) {
+                    // Exceptions cannot propagate out of a worker thread, so they are discarded.
+                }
+                return;
+            }
+
+            std::lock_guard<std::mutex> lck(my_mutex);
+            my_completed.push_back([callback = std::move(callback), result = std::move(result), error = std::move(error)]() -> void {
+                callback(std::move(result), std::move(error));
+            });
+#if defined(__linux__)
+            ::eventfd_write(my_fd, 1);
+#endif
+        });
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,657 @@
+#ifndef MILLIJSON_CORPUS_HPP
+#define MILLIJSON_CORPUS_HPP
+
+#include "millijson.hpp"
+#include "events.hpp"
+#include "patch.hpp"
+#include "directory.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * @file corpus.hpp
+ * @brief Inverted index of keys and values across a corpus of JSON files.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Bloom filter of 64-bit hashes.
+ *
+ * Membership queries may return false positives at approximately the rate requested in the constructor, but never false negatives.
+ */
+class BloomFilter {
+public:
+    /**
+     * @param num_items Expected number of items to be inserted.
+     * @param false_positive_rate Target false positive rate, between 0 and 1.
+     */
+    BloomFilter(size_t num_items, double false_positive_rate) {
+        if (!(false_positive_rate > 0 && false_positive_rate < 1)) {
+            throw std::runtime_error("false positive rate should lie in (0, 1)");
+        }
+        const double ln2 = std::log(2.0);
+        double nbits = std::ceil(-static_cast<double>(num_items) * std::log(false_positive_rate) / (ln2 * ln2));
+        size_t nwords = std::max(static_cast<size_t>(1), static_cast<size_t>((nbits + 63) / 64));
+        my_words.resize(nwords);
+        my_num_hashes = (num_items ? static_cast<size_t>(std::round(nwords * 64.0 / num_items * ln2)) : 1);
+        my_num_hashes = std::min(std::max(my_num_hashes, static_cast<size_t>(1)), static_cast<size_t>(16));
+    }
+
+    /**
+     * @cond
+     */
+    BloomFilter() = default;
+
+    BloomFilter(std::vector<uint64_t> words, size_t num_hashes) : my_words(std::move(words)), my_num_hashes(num_hashes) {}
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param hash Hash of the item to insert.
+     */
+    void insert(uint64_t hash) {
+        probe(hash, [&](size_t bit) -> bool {
+            my_words[bit / 64] |= (static_cast<uint64_t>(1) << (bit % 64));
+            return true;
+        });
+    }
+
+    /**
+     * @param hash Hash of the item to query.
+     * @return Whether the item may have been inserted.
+     * If false, the item was definitely not inserted.
+     */
+    bool maybe_contains(uint64_t hash) const {
+        return probe(hash, [&](size_t bit) -> bool {
+            return (my_words[bit / 64] >> (bit % 64)) & 1;
+        });
+    }
+
+    /**
+     * @return Words of the bit array.
+     */
+    const std::vector<uint64_t>& words() const {
+        return my_words;
+    }
+
+    /**
+     * @return Number of bits that are set for each item.
+     */
+    size_t num_hashes() const {
+        return my_num_hashes;
+    }
+
+private:
+    std::vector<uint64_t> my_words;
+    size_t my_num_hashes = 0;
+
+    template<class Function_>
+    bool probe(uint64_t hash, Function_ fun) const {
+        if (my_words.empty()) {
+            return false;
+        }
+        // Double hashing, deriving all probes from the two halves of the hash.
+        uint64_t nbits = my_words.size() * 64;
+        uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+        for (size_t i = 0; i < my_num_hashes; ++i) {
+            if (!fun(static_cast<size_t>((h1 + i * h2) % nbits))) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Options for a `CorpusIndex`.
+ */
+struct CorpusIndexOptions {
+    /**
+     * Whether to index the scalar values in each file, in addition to its key paths.
+     */
+    bool values = true;
+
+    /**
+     * Target false positive rate of the per-file Bloom filters for values.
+     */
+    double false_positive_rate = 0.01;
+
+    /**
+     * Number of threads to use in `CorpusIndex::add_directory()`.
+     */
+    size_t num_threads = 4;
+
+    /**
+     * File extension of the JSON files to be indexed by `CorpusIndex::add_directory()`.
+     * If empty, all regular files are indexed.
+     */
+    std::string extension = ".json";
+};
+
+/**
+ * @cond
+ */
+inline uint64_t corpus_hash(const std::string& term) {
+    // Fixed seed so that hashes in a saved index remain valid in other processes.
+    KeyHash hasher(0x636f72707573696eull, 0x6d696c6c696a736full);
+    return hasher(term);
+}
+
+inline std::string corpus_value_term(Type type, const std::string& string, double number, bool boolean) {
+    std::string output(1, static_cast<char>('0' + type));
+    if (type == STRING) {
+        output += string;
+    } else if (type == NUMBER) {
+        if (number == 0) {
+            number = 0; // treating -0 and 0 as the same value.
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(double));
+        for (int i = 0; i < 8; ++i) {
+            output += static_cast<char>((bits >> (i * 8)) & 0xff); // independent of the platform's endianness.
+        }
+    } else if (type == BOOLEAN) {
+        output += (boolean ? 't' : 'f');
+    }
+    return output;
+}
+
+inline uint64_t corpus_pair_hash(const std::string& path, uint64_t value) {
+    std::string term = path;
+    term += '\0';
+    for (int i = 0; i < 8; ++i) {
+        term += static_cast<char>((value >> (i * 8)) & 0xff);
+    }
+    return corpus_hash(term);
+}
+
+struct CorpusTerms {
+    std::vector<std::string> keys;
+    std::vector<uint64_t> values;
+};
+
+template<class Input>
+class CorpusCollector {
+public:
+    CorpusCollector(EventReader<Input>& reader, bool values) : my_reader(reader), my_values(values) {}
+
+    CorpusTerms collect() {
+        visit(my_reader.next());
+        my_reader.next(); // checking for trailing characters.
+
+        CorpusTerms output;
+        output.keys.insert(output.keys.end(), my_keys.begin(), my_keys.end());
+        std::sort(my_hashes.begin(), my_hashes.end());
+        my_hashes.erase(std::unique(my_hashes.begin(), my_hashes.end()), my_hashes.end());
+        output.values.swap(my_hashes);
+        return output;
+    }
+
+private:
+    EventReader<Input>& my_reader;
+    bool my_values;
+    std::string my_path;
+    std::unordered_set<std::string, KeyHash> my_keys;
+    std::vector<uint64_t> my_hashes;
+
+    void visit(Event current) {
+        if (!my_path.empty()) {
+            my_keys.insert(my_path);
+        }
+
+        if (current == Event::START_ARRAY) {
+            size_t original = my_path.size();
+            my_path += "/*";
+            while (1) {
+                auto next = my_reader.next();
+                if (next == Event::END_ARRAY) {
+                    break;
+                }
+                visit(next);
+            }
+            my_path.resize(original);
+
+        } else if (current == Event::START_OBJECT) {
+            size_t original = my_path.size();
+            while (my_reader.next() == Event::KEY) {
+                append_pointer(my_path, my_reader.get_string());
+                visit(my_reader.next());
+                my_path.resize(original);
+            }
+
+        } else if (my_values) {
+            std::string term;
+            if (current == Event::NUMBER) {
+                term = corpus_value_term(NUMBER, std::string(), my_reader.get_number(), false);
+            } else if (current == Event::STRING) {
+                term = corpus_value_term(STRING, my_reader.get_string(), 0, false);
+            } else if (current == Event::BOOLEAN) {
+                term = corpus_value_term(BOOLEAN, std::string(), 0, my_reader.get_boolean());
+            } else {
+                term = corpus_value_term(NOTHING, std::string(), 0, false);
+            }
+            auto value = corpus_hash(term);
+            my_hashes.push_back(value);
+            my_hashes.push_back(corpus_pair_hash(my_path, value));
+        }
+    }
+};
+
+template<class Input>
+CorpusTerms collect_corpus_terms(Input& input, bool values) {
+    EventReader<Input> reader(input);
+    CorpusCollector<Input> collector(reader, values);
+    return collector.collect();
+}
+
+inline void corpus_write_varint(std::string& output, uint64_t x) {
+    while (x >= 0x80) {
+        output += static_cast<char>((x & 0x7f) | 0x80);
+        x >>= 7;
+    }
+    output += static_cast<char>(x);
+}
+
+inline void corpus_write_string(std::string& output, const std::string& x) {
+    corpus_write_varint(output, x.size());
+    output += x;
+}
+
+struct CorpusCursor {
+    const std::string& data;
+    size_t position = 0;
+
+    uint64_t varint() {
+        uint64_t output = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position == data.size()) {
+                throw std::runtime_error("invalid corpus index, unexpected end of file");
+            }
+            auto byte = static_cast<unsigned char>(data[position++]);
+            output |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return output;
+            }
+        }
+        throw std::runtime_error("invalid corpus index, malformed integer at position " + std::to_string(position));
+    }
+
+    std::string string() {
+        auto len = varint();
+        if (len > data.size() - position) {
+            throw std::runtime_error("invalid corpus index, unexpected end of file");
+        }
+        std::string output = data.substr(position, len);
+        position += len;
+        return output;
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Inverted index of the keys and values in a corpus of JSON files.
+ *
+ * For each file, this records the set of key paths and, optionally, a Bloom filter of its scalar values.
+ * Queries can then identify the files that contain a key or value without parsing every file in the corpus.
+ *
+ * Key paths are JSON pointers in which all elements of an array are represented by a `*` token.
+ * For example, the document `{"a":{"b":[1,2]}}` contains the key paths `/a` and `/a/b`, along with `/a/b/` followed by `*` for the array elements.
+ * Note that `*` is also a valid object key, so the index does not distinguish between array elements and keys named `*`.
+ *
+ * Key queries are exact, as the key paths of each file are stored in full.
+ * Value queries use the Bloom filters and may return a small fraction of false positives, so the candidate files should be parsed to confirm a match.
+ */
+class CorpusIndex {
+public:
+    /**
+     * @param options Further options.
+     */
+    CorpusIndex(CorpusIndexOptions options = CorpusIndexOptions()) : my_options(std::move(options)) {}
+
+public:
+    /**
+     * Index an in-memory JSON document.
+     * An error is raised if the document is invalid, in which case the index is not modified.
+     *
+     * @param name Name of the document, e.g., its path.
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * @param len Length of the array.
+     * @return Identifier of the document in the index.
+     */
+    size_t add_string(std::string name, const char* ptr, size_t len) {
+        RawReader input(ptr, len);
+        return add_terms(std::move(name), collect_corpus_terms(input, my_options.values));
+    }
+
+    /**
+     * Index a JSON file.
+     * An error is raised if the file is invalid, in which case the index is not modified.
+     *
+     * @param path Path to the file.
+     * @param name Name of the file in the index.
+     * If empty, `path` is used.
+     * @return Identifier of the file in the index.
+     */
+    size_t add_file(const std::string& path, std::string name = std::string()) {
+        auto terms = read_file_terms(path);
+        return add_terms(name.empty() ? path : std::move(name), std::move(terms));
+    }
+
+    /**
+     * Index all JSON files in a directory tree, in parallel.
+     * Files are added in lexicographic order of their paths relative to the directory, which are also used as their names.
+     *
+     * @param directory Path to the directory.
+     * @return Names and error messages of the files that could not be parsed.
+     * These files are not added to the index.
+     */
+    std::vector<std::pair<std::string, std::string> > add_directory(const std::string& directory) {
+        namespace fs = std::filesystem;
+        std::vector<std::string> relative;
+        for (const auto& entry : fs::recursive_directory_iterator(directory)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            const auto& path = entry.path();
+            if (!my_options.extension.empty() && path.extension() != my_options.extension) {
+                continue;
+            }
+            relative.push_back(path.lexically_relative(directory).generic_string());
+        }
+        std::sort(relative.begin(), relative.end());
+
+        std::vector<CorpusTerms> collected(relative.size());
+        std::vector<std::string> errors(relative.size());
+        run_parallel_jobs(relative.size(), my_options.num_threads, [&](size_t i) -> void {
+            try {
+                collected[i] = read_file_terms((fs::path(directory) / relative[i]).string());
+            } catch (std::exception& e) {
+                errors[i] = e.what();
+                if (errors[i].empty()) {
+                    errors[i] = "unknown error";
+                }
+            }
+        });
+
+        std::vector<std::pair<std::string, std::string> > failed;
+        for (size_t i = 0, end = relative.size(); i < end; ++i) {
+            if (errors[i].empty()) {
+                add_terms(std::move(relative[i]), std::move(collected[i]));
+            } else {
+                failed.emplace_back(std::move(relative[i]), std::move(errors[i]));
+            }
+        }
+        return failed;
+    }
+
+public:
+    /**
+     * @return Number of indexed files.
+     */
+    size_t size() const {
+        return my_names.size();
+    }
+
+    /**
+     * @param i Identifier of a file, less than `size()`.
+     * @return Name of the file.
+     */
+    const std::string& name(size_t i) const {
+        return my_names[i];
+    }
+
+    /**
+     * @return Number of distinct key paths across all files.
+     */
+    size_t num_keys() const {
+        return my_postings.size();
+    }
+
+    /**
+     * @param path Key path, see the class documentation for details.
+     * @return Sorted identifiers of the files that contain this key path.
+     */
+    std::vector<size_t> with_key(const std::string& path) const {
+        std::vector<size_t> output;
+        auto it = my_postings.find(path);
+        if (it != my_postings.end()) {
+            output.insert(output.end(), it->second.begin(), it->second.end());
+        }
+        return output;
+    }
+
+    /**
+     * @param value A scalar JSON value, i.e., a string, number, boolean or null.
+     * @return Sorted identifiers of the candidate files that may contain this value at any position.
+     * This may include a small fraction of false positives.
+     */
+    std::vector<size_t> with_value(const Base& value) const {
+        check_values();
+        auto hash = corpus_hash(value_term(value));
+        std::vector<size_t> output;
+        for (size_t i = 0, end = my_filters.size(); i < end; ++i) {
+            if (my_filters[i].maybe_contains(hash)) {
+                output.push_back(i);
+            }
+        }
+        return output;
+    }
+
+    /**
+     * @param path Key path, see the class documentation for details.
+     * @param value A scalar JSON value, i.e., a string, number, boolean or null.
+     * @return Sorted identifiers of the candidate files that may contain this value at this key path.
+     * This may include a small fraction of false positives, but only among the files that contain the key path.
+     */
+    std::vector<size_t> with_value(const std::string& path, const Base& value) const {
+        check_values();
+        auto hash = corpus_pair_hash(path, corpus_hash(value_term(value)));
+        std::vector<size_t> output;
+        auto it = my_postings.find(path);
+        if (it != my_postings.end()) {
+            for (auto i : it->second) {
+                if (my_filters[i].maybe_contains(hash)) {
+                    output.push_back(i);
+                }
+            }
+        }
+        return output;
+    }
+
+public:
+    /**
+     * Save the index to a compact binary file.
+     * The file is first written to a temporary file and then renamed, so an existing index is not corrupted by an interrupted save.
+     *
+     * @param path Path to the output file.
+     */
+    void save(const std::string& path) const {
+        std::string output("MJCI", 4);
+        corpus_write_varint(output, 1); // version.
+        corpus_write_varint(output, my_options.values);
+
+        corpus_write_varint(output, my_names.size());
+        for (size_t i = 0, end = my_names.size(); i < end; ++i) {
+            corpus_write_string(output, my_names[i]);
+            const auto& words = my_filters[i].words();
+            corpus_write_varint(output, my_filters[i].num_hashes());
+            corpus_write_varint(output, words.size());
+            for (auto w : words) {
+                for (int b = 0; b < 8; ++b) {
+                    output += static_cast<char>((w >> (b * 8)) & 0xff);
+                }
+            }
+        }
+
+        // Sorting the keys so that the output is deterministic.
+        std::vector<const std::pair<const std::string, std::vector<uint32_t> >*> sorted;
+        sorted.reserve(my_postings.size());
+        for (const auto& x : my_postings) {
+            sorted.push_back(&x);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](auto left, auto right) -> bool { return left->first < right->first; });
+
+        corpus_write_varint(output, sorted.size());
+        for (auto x : sorted) {
+            corpus_write_string(output, x->first);
+            corpus_write_varint(output, x->second.size());
+            uint32_t last = 0;
+            for (auto i : x->second) {
+                corpus_write_varint(output, i - last); // delta-encoding the sorted identifiers.
+                last = i;
+            }
+        }
+
+        write_file_atomically(path, [&](auto writer) -> void {
+            writer(output.data(), output.size());
+        });
+    }
+
+    /**
+     * Load an index from a file created by `save()`, replacing the contents of this index.
+     * Whether the index contains values is also taken from the file.
+     * An error is raised if the file is invalid.
+     *
+     * @param path Path to the file.
+     */
+    void load(const std::string& path) {
+        std::string contents;
+        {
+            FileReader input(path.c_str(), 65536);
+            while (input.valid()) {
+                contents.append(input.current(), input.remaining());
+                input.skip(input.remaining());
+            }
+        }
+
+        if (contents.compare(0, 4, "MJCI") != 0) {
+            throw std::runtime_error("invalid corpus index, unrecognized file format");
+        }
+        CorpusCursor cursor{ contents, 4 };
+        if (cursor.varint() != 1) {
+            throw std::runtime_error("unsupported corpus index version");
+        }
+        bool values = cursor.varint();
+
+        size_t nfiles = cursor.varint();
+        std::vector<std::string> names;
+        std::vector<BloomFilter> filters;
+        for (size_t i = 0; i < nfiles; ++i) {
+            names.push_back(cursor.string());
+            size_t nhashes = cursor.varint();
+            if (nhashes > 16 || (values && nhashes == 0)) { // same limits as the BloomFilter constructor.
+                throw std::runtime_error("invalid corpus index, invalid number of hashes for file " + std::to_string(i));
+            }
+            size_t nwords = cursor.varint();
+            if (nwords > (contents.size() - cursor.position) / 8) {
+                throw std::runtime_error("invalid corpus index, unexpected end of file");
+            }
+            std::vector<uint64_t> words(nwords);
+            for (auto& w : words) {
+                for (int b = 0; b < 8; ++b) {
+                    w |= static_cast<uint64_t>(static_cast<unsigned char>(contents[cursor.position++])) << (b * 8);
+                }
+            }
+            filters.emplace_back(std::move(words), nhashes);
+        }
+
+        size_t nkeys = cursor.varint();
+        std::unordered_map<std::string, std::vector<uint32_t>, KeyHash> postings;
+        for (size_t k = 0; k < nkeys; ++k) {
+            auto& current = postings[cursor.string()];
+            size_t n = cursor.varint();
+            uint64_t last = 0;
+            for (size_t j = 0; j < n; ++j) {
+                last += cursor.varint();
+                if (last >= nfiles) {
+                    throw std::runtime_error("invalid corpus index, out-of-range file identifier");
+                }
+                current.push_back(last);
+            }
+        }
+
+        if (cursor.position != contents.size()) {
+            throw std::runtime_error("invalid corpus index, trailing bytes at position " + std::to_string(cursor.position + 1));
+        }
+
+        my_options.values = values;
+        my_names.swap(names);
+        my_filters.swap(filters);
+        my_postings.swap(postings);
+    }
+
+private:
+    CorpusIndexOptions my_options;
+    std::vector<std::string> my_names;
+    std::vector<BloomFilter> my_filters;
+    std::unordered_map<std::string, std::vector<uint32_t>, KeyHash> my_postings;
+
+    CorpusTerms read_file_terms(const std::string& path) const {
+        FileReadOptions ropt;
+        ropt.single_read = true; // most corpus files are small, so we might as well read them in one go.
+        FileReader input(path.c_str(), ropt);
+        return collect_corpus_terms(input, my_options.values);
+    }
+
+    size_t add_terms(std::string name, CorpusTerms terms) {
+        size_t id = my_names.size();
+        if (id > static_cast<size_t>(static_cast<uint32_t>(-1))) {
+            throw std::runtime_error("too many files in the corpus index");
+        }
+        my_names.push_back(std::move(name));
+
+        if (my_options.values) {
+            BloomFilter filter(terms.values.size(), my_options.false_positive_rate);
+            for (auto h : terms.values) {
+                filter.insert(h);
+            }
+            my_filters.push_back(std::move(filter));
+        } else {
+            my_filters.emplace_back();
+        }
+
+        for (auto& k : terms.keys) {
+            my_postings[std::move(k)].push_back(id);
+        }
+        return id;
+    }
+
+    void check_values() const {
+        if (!my_options.values) {
+            throw std::runtime_error("values were not indexed");
+        }
+    }
+
+    static std::string value_term(const Base& value) {
+        auto type = value.type();
+        if (type == STRING) {
+            return corpus_value_term(STRING, value.get_string(), 0, false);
+        } else if (type == NUMBER) {
+            return corpus_value_term(NUMBER, std::string(), value.get_number(), false);
+        } else if (type == BOOLEAN) {
+            return corpus_value_term(BOOLEAN, std::string(), 0, value.get_boolean());
+        } else if (type == NOTHING) {
+            return corpus_value_term(NOTHING, std::string(), 0, false);
+        }
+        throw std::runtime_error("only scalar values can be queried in a corpus index");
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,498 @@
+#ifndef MILLIJSON_DIFF_HPP
+#define MILLIJSON_DIFF_HPP
+
+#include "millijson.hpp"
+#include "events.hpp"
+#include "patch.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+/**
+ * @file diff.hpp
+ * @brief Streaming structural comparison of JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * Type of change between two JSON documents.
+ */
+enum class ChangeType {
+    ADD,
+    REMOVE,
+    REPLACE
+};
+
+/**
+ * @brief Change between two JSON documents.
+ *
+ * Changes are reported in the order in which they should be applied, consistent with the operations in a JSON patch.
+ */
+struct Change {
+    /**
+     * Type of the change.
+     */
+    ChangeType type;
+
+    /**
+     * JSON pointer to the location of the change.
+     */
+    std::string path;
+
+    /**
+     * New value for `ChangeType::ADD` and `ChangeType::REPLACE`.
+     * This is NULL for `ChangeType::REMOVE`.
+     */
+    std::shared_ptr<Base> value;
+};
+
+/**
+ * @brief Options for `diff()`.
+ */
+struct DiffOptions {
+    /**
+     * Maximum number of object entries to buffer when the keys of corresponding objects appear in different orders.
+     * An error is raised if this limit is exceeded.
+     */
+    size_t max_buffered = 1000000;
+
+    /**
+     * Maximum number of bytes to use for buffering object entries when the keys of corresponding objects appear in different orders.
+     * This is an estimate of the memory used by the buffered keys and values (including all of their children) across all objects that are buffered at the same time.
+     * An error is raised as soon as this limit is exceeded, i.e., without first buffering the rest of the offending value.
+     */
+    size_t max_buffered_bytes = 268435456;
+
+    /**
+     * Whether to skip arrays and objects that are byte-for-byte identical in both documents, without parsing their contents.
+     * This is only possible if both inputs support bulk access, and only if the entire array or object is available in the current window of each input.
+     * Skipped bytes are only checked for balanced brackets and strings, so invalid contents (e.g., malformed numbers, duplicate keys) will not be reported if they are identical in both documents.
+     */
+    bool skip_identical = true;
+};
+
+/**
+ * @cond
+ */
+struct DiffState {
+    size_t buffered_bytes = 0; // shared by all nested Differs, as buffered entries of enclosing objects are still alive.
+
+    // Positions of the arrays/objects in each document that were open at the last mismatch in match_raw().
+    // These are known to differ so we don't bother re-scanning them when we get to them.
+    std::vector<std::pair<size_t, size_t> > differing;
+    std::vector<size_t> open;
+};
+
+// Compares the bytes of two arrays/objects, starting immediately after their opening brackets.
+// Returns the number of bytes up to and including the closing bracket if they are identical, or zero otherwise.
+// On a mismatch, 'open' contains the offsets of the opening brackets of nested arrays/objects that enclose the first differing byte;
+// 'mismatch' is false if we ran out of bytes or encountered unbalanced brackets before finding a difference.
+inline size_t match_raw(const char* a, size_t a_len, const char* b, size_t b_len, char closing, std::vector<size_t>& open, bool& mismatch) {
+    open.clear();
+    mismatch = false;
+    size_t len = std::min(a_len, b_len);
+    bool in_string = false, escaped = false;
+
+    for (size_t i = 0; i < len; ++i) {
+        char x = a[i];
+        if (x != b[i]) {
+            mismatch = true;
+            return 0;
+        }
+
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+            } else if (x == '\\') {
+                escaped = true;
+            } else if (x == '"') {
+                in_string = false;
+            }
+        } else if (x == '"') {
+            in_string = true;
+        } else if (x == '[' || x == '{') {
+            open.push_back(i);
+        } else if (x == ']' || x == '}') {
+            char expected = (open.empty() ? closing : (a[open.back()] == '[' ? ']' : '}'));
+            if (x != expected) {
+                return 0; // leave it to the event parser to report the error.
+            }
+            if (open.empty()) {
+                return i + 1;
+            }
+            open.pop_back();
+        }
+    }
+
+    return 0;
+}
+
+template<class Reader, class = void>
+struct has_raw_access : std::false_type {};
+
+template<class Reader>
+struct has_raw_access<Reader, std::void_t<decltype(std::declval<const Reader&>().raw_pointer())> > : std::true_type {};
+
+template<class ReaderA, class ReaderB, class Callback>
+struct Differ {
+    Differ(ReaderA& a, ReaderB& b, std::string& path, Callback& callback, const DiffOptions& options, DiffState& state) :
+        a(a), b(b), path(path), callback(callback), options(options), state(state) {}
+
+    ReaderA& a;
+    ReaderB& b;
+    std::string& path;
+    Callback& callback;
+    const DiffOptions& options;
+    DiffState& state;
+
+    void charge(size_t bytes) {
+        state.buffered_bytes += bytes;
+        if (state.buffered_bytes > options.max_buffered_bytes) {
+            throw std::runtime_error("exceeded the maximum number of buffered bytes for objects with different key orders");
+        }
+    }
+
+    // Same as collect(), but charging the estimated size of each node as it is created.
+    template<class Reader>
+    std::shared_ptr<Base> buffer(Reader& reader, Event current) {
+        constexpr size_t control_block = 3 * sizeof(void*);
+        switch (current) {
+            case Event::NUMBER:
+                charge(sizeof(Number) + control_block);
+                return std::shared_ptr<Base>(new Number(reader.get_number()));
+            case Event::STRING:
+                charge(sizeof(String) + control_block + reader.get_string().size());
+                return std::shared_ptr<Base>(new String(reader.get_string()));
+            case Event::BOOLEAN:
+                charge(sizeof(Boolean) + control_block);
+                return std::shared_ptr<Base>(new Boolean(reader.get_boolean()));
+            case Event::NOTHING:
+                charge(sizeof(Nothing) + control_block);
+                return std::shared_ptr<Base>(new Nothing);
+            case Event::START_ARRAY:
+                {
+                    charge(sizeof(Array) + control_block);
+                    auto ptr = new Array;
+                    std::shared_ptr<Base> output(ptr);
+                    while (1) {
+                        auto event = reader.next();
+                        if (event == Event::END_ARRAY) {
+                            break;
+                        }
+                        charge(sizeof(std::shared_ptr<Base>));
+                        ptr->add(buffer(reader, event));
+                    }
+                    return output;
+                }
+            case Event::START_OBJECT:
+                {
+                    charge(sizeof(Object) + control_block);
+                    auto ptr = new Object;
+                    std::shared_ptr<Base> output(ptr);
+                    while (reader.next() == Event::KEY) {
+                        auto key = reader.get_string();
+                        charge(entry_size(key));
+                        ptr->add(std::move(key), buffer(reader, reader.next()));
+                    }
+                    return output;
+                }
+            default:
+                throw std::runtime_error("event does not represent the start of a value");
+        }
+    }
+
+    static size_t entry_size(const std::string& key) {
+        // Each entry is stored in a hash table node with a 'next' pointer, a cached hash and a bucket pointer.
+        return sizeof(ObjectMap::value_type) + 3 * sizeof(void*) + key.size();
+    }
+
+    void report(ChangeType type, std::shared_ptr<Base> value) {
+        callback(Change{ type, path, std::move(value) });
+    }
+
+    static bool is_scalar(Event e) {
+        return e != Event::START_ARRAY && e != Event::START_OBJECT;
+    }
+
+    // Called immediately after both readers emit the same START_ARRAY or START_OBJECT event.
+    bool skip_identical(char closing) {
+        if constexpr(has_raw_access<ReaderA>::value && has_raw_access<ReaderB>::value) {
+            if (!options.skip_identical) {
+                return false;
+            }
+            auto a_ptr = a.raw_pointer();
+            auto b_ptr = b.raw_pointer();
+            if (a_ptr == nullptr || b_ptr == nullptr) {
+                return false;
+            }
+
+            size_t a_pos = a.position(), b_pos = b.position();
+            for (const auto& d : state.differing) {
+                if (d.first == a_pos && d.second == b_pos) {
+                    return false;
+                }
+            }
+
+            bool mismatch;
+            size_t n = match_raw(a_ptr, a.raw_available(), b_ptr, b.raw_available(), closing, state.open, mismatch);
+            if (n) {
+                a.skip_raw(n);
+                b.skip_raw(n);
+                return true;
+            }
+
+            if (mismatch) {
+                // Offsets in 'open' are relative to the byte after the opening bracket, hence the +1.
+                state.differing.clear();
+                for (auto o : state.open) {
+                    state.differing.emplace_back(a_pos + 1 + o, b_pos + 1 + o);
+                }
+            }
+            return false;
+
+        } else {
+            (void)closing;
+            return false;
+        }
+    }
+
+    void value(Event ea, Event eb) {
+        if (ea == eb) {
+            if (ea == Event::START_ARRAY) {
+                if (!skip_identical(']')) {
+                    array();
+                }
+                return;
+            } else if (ea == Event::START_OBJECT) {
+                if (!skip_identical('}')) {
+                    object();
+                }
+                return;
+            } else if (ea == Event::NOTHING) {
+                return;
+            } else if (ea == Event::NUMBER && a.get_number() == b.get_number()) {
+                return;
+            } else if (ea == Event::STRING && a.get_string() == b.get_string()) {
+                return;
+            } else if (ea == Event::BOOLEAN && a.get_boolean() == b.get_boolean()) {
+                return;
+            }
+        }
+
+        skip(a, ea);
+        report(ChangeType::REPLACE, collect(b, eb));
+    }
+
+    void array() {
+        size_t i = 0;
+        auto original = path.size();
+        while (1) {
+            auto ea = a.next();
+            auto eb = b.next();
+
+            if (ea == Event::END_ARRAY) {
+                while (eb != Event::END_ARRAY) {
+                    path += '/';
+                    path += std::to_string(i);
+                    report(ChangeType::ADD, collect(b, eb));
+                    path.resize(original);
+                    ++i;
+                    eb = b.next();
+                }
+                return;
+            }
+
+            path += '/';
+            path += std::to_string(i);
+            if (eb == Event::END_ARRAY) {
+                // Removing the same index repeatedly, as each removal shifts the remaining elements.
+                while (ea != Event::END_ARRAY) {
+                    skip(a, ea);
+                    report(ChangeType::REMOVE, nullptr);
+                    ea = a.next();
+                }
+                path.resize(original);
+                return;
+            }
+
+            value(ea, eb);
+            path.resize(original);
+            ++i;
+        }
+    }
+
+    void object() {
+        auto original = path.size();
+
+        // Walking through both objects in lockstep while the keys are the same.
+        Event ea, eb;
+        while (1) {
+            ea = a.next();
+            eb = b.next();
+            if (ea != Event::KEY || eb != Event::KEY || a.get_string() != b.get_string()) {
+                break;
+            }
+            append_pointer(path, a.get_string());
+            value(a.next(), b.next());
+            path.resize(original);
+        }
+
+        if (ea == Event::END_OBJECT && eb == Event::END_OBJECT) {
+            return;
+        }
+
+        // Otherwise, we buffer the remaining entries of both objects and compare them in sorted key order.
+        // Matching values are compared via DomEventReaders that also emit sorted keys,
+        // so that nested objects always line up and don't need to be buffered again.
+        ObjectMap remaining_a, remaining_b;
+        size_t initial_bytes = state.buffered_bytes;
+        buffer_entries(a, ea, remaining_a, remaining_b.size());
+        buffer_entries(b, eb, remaining_b, remaining_a.size());
+
+        std::vector<const std::string*> keys;
+        keys.reserve(remaining_a.size() + remaining_b.size());
+        for (const auto& x : remaining_a) {
+            keys.push_back(&(x.first));
+        }
+        for (const auto& x : remaining_b) {
+            if (remaining_a.find(x.first) == remaining_a.end()) {
+                keys.push_back(&(x.first));
+            }
+        }
+        std::sort(keys.begin(), keys.end(), [](const std::string* left, const std::string* right) -> bool { return *left < *right; });
+
+        for (auto key : keys) {
+            append_pointer(path, *key);
+            auto it_a = remaining_a.find(*key);
+            auto it_b = remaining_b.find(*key);
+            if (it_a == remaining_a.end()) {
+                report(ChangeType::ADD, it_b->second);
+            } else if (it_b == remaining_b.end()) {
+                report(ChangeType::REMOVE, nullptr);
+            } else {
+                DomEventReader dom_a(*(it_a->second), true);
+                DomEventReader dom_b(*(it_b->second), true);
+                Differ<DomEventReader, DomEventReader, Callback> sub(dom_a, dom_b, path, callback, options, state);
+                sub.value(dom_a.next(), dom_b.next());
+            }
+            path.resize(original);
+        }
+
+        state.buffered_bytes = initial_bytes; // releasing everything buffered for this object.
+    }
+
+    template<class Reader>
+    void buffer_entries(Reader& reader, Event current, ObjectMap& remaining, size_t other) {
+        while (current != Event::END_OBJECT) {
+            if (remaining.size() + other == options.max_buffered) {
+                throw std::runtime_error("exceeded the maximum number of buffered entries for objects with different key orders");
+            }
+            std::string key = reader.get_string();
+            charge(entry_size(key));
+            auto val = buffer(reader, reader.next());
+            remaining[std::move(key)] = std::move(val);
+            current = reader.next();
+        }
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Compare two JSON documents by walking through them in lockstep, without building a DOM for either document.
+ * Identical subtrees are compared event-by-event without allocating any nodes, and only the new values of changed subtrees are materialized.
+ * If both inputs support bulk access, arrays and objects with byte-identical contents are skipped without parsing, see `DiffOptions::skip_identical`.
+ * If two corresponding objects have keys in different orders, the remaining entries of both objects are buffered from the point of divergence and compared in sorted key order;
+ * this is limited by `DiffOptions::max_buffered` and `DiffOptions::max_buffered_bytes`.
+ *
+ * Arrays are compared by position, i.e., an insertion in the middle of an array is reported as a series of replacements followed by an addition.
+ *
+ * @tparam InputA Any class that supplies input characters, see `parse()` for details.
+ * @tparam InputB Any class that supplies input characters, see `parse()` for details.
+ * @tparam Callback Any callable that accepts a `Change`.
+ *
+ * @param a Instance of an `InputA` class, referring to the bytes of the old document.
+ * @param b Instance of an `InputB` class, referring to the bytes of the new document.
+ * @param callback Function to be called on each change.
+ * @param options Further options.
+ */
+template<class InputA, class InputB, class Callback>
+void diff(InputA& a, InputB& b, Callback callback, const DiffOptions& options = DiffOptions()) {
+    EventReader<InputA> ra(a);
+    EventReader<InputB> rb(b);
+    std::string path;
+    DiffState state;
+    Differ<EventReader<InputA>, EventReader<InputB>, Callback> differ(ra, rb, path, callback, options, state);
+    differ.value(ra.next(), rb.next());
+
+    // Checking for trailing characters.
+    ra.next();
+    rb.next();
+}
+
+/**
+ * @tparam Callback Any callable that accepts a `Change`.
+ *
+ * @param[in] a_ptr Pointer to an array containing the old JSON string.
+ * @param a_len Length of the array at `a_ptr`.
+ * @param[in] b_ptr Pointer to an array containing the new JSON string.
+ * @param b_len Length of the array at `b_ptr`.
+ * @param callback Function to be called on each change.
+ * @param options Further options.
+ */
+template<class Callback>
+void diff_strings(const char* a_ptr, size_t a_len, const char* b_ptr, size_t b_len, Callback callback, const DiffOptions& options = DiffOptions()) {
+    RawReader a(a_ptr, a_len);
+    RawReader b(b_ptr, b_len);
+    diff(a, b, std::move(callback), options);
+}
+
+/**
+ * @tparam Callback Any callable that accepts a `Change`.
+ *
+ * @param[in] a_path Path to the old JSON file.
+ * @param[in] b_path Path to the new JSON file.
+ * @param callback Function to be called on each change.
+ * @param options Further options.
+ * @param buffer_size Size of the buffer to use for reading each file.
+ */
+template<class Callback>
+void diff_files(const char* a_path, const char* b_path, Callback callback, const DiffOptions& options = DiffOptions(), size_t buffer_size = 65536) {
+    FileReader a(a_path, buffer_size);
+    FileReader b(b_path, buffer_size);
+    diff(a, b, std::move(callback), options);
+}
+
+/**
+ * @param changes Changes reported by `diff()`.
+ * @return A JSON patch, i.e., an array of operations, that converts the old document into the new document.
+ * This can be used in `apply_patch()`.
+ */
+inline std::shared_ptr<Base> to_patch(const std::vector<Change>& changes) {
+    auto output = new Array;
+    std::shared_ptr<Base> ptr(output);
+    for (const auto& change : changes) {
+        auto operation = new Object;
+        output->add(std::shared_ptr<Base>(operation));
+
+        const char* op = (change.type == ChangeType::ADD ? "add" : (change.type == ChangeType::REMOVE ? "remove" : "replace"));
+        operation->add("op", std::shared_ptr<Base>(new String(op)));
+        operation->add("path", std::shared_ptr<Base>(new String(change.path)));
+        if (change.value) {
+            operation->add("value", change.value);
+        }
+    }
+    return ptr;
+}
+
+}
+
+#endif
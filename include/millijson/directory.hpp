@@ -0,0 +1,440 @@
+#ifndef MILLIJSON_DIRECTORY_HPP
+#define MILLIJSON_DIRECTORY_HPP
+
+#include "millijson.hpp"
+#include "serialize.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @file directory.hpp
+ * @brief Incrementally index a directory of JSON files.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Options for a `DirectoryIndex`.
+ */
+struct DirectoryIndexOptions {
+    /**
+     * File extension of the JSON files to be indexed.
+     * If empty, all regular files are indexed.
+     */
+    std::string extension = ".json";
+
+    /**
+     * Number of threads to use for parsing new or modified files.
+     */
+    size_t num_threads = 4;
+
+    /**
+     * Function to extract the relevant parts of each parsed document, to be stored in the index and its cache.
+     * This accepts the path to the file (relative to the directory) and the parsed document, and returns the value to be stored.
+     * It is called concurrently from multiple threads.
+     * If not provided, the entire document is stored.
+     */
+    std::function<std::shared_ptr<Base>(const std::string&, std::shared_ptr<Base>)> extract;
+};
+
+/**
+ * @brief Indexed file in a `DirectoryIndex`.
+ */
+struct IndexedFile {
+    /**
+     * Size of the file in bytes.
+     */
+    uint64_t size = 0;
+
+    /**
+     * Modification time of the file, in the units of the file system clock.
+     */
+    int64_t mtime = 0;
+
+    /**
+     * 64-bit hash of the file contents.
+     */
+    uint64_t hash = 0;
+
+    /**
+     * Parsed (and possibly extracted) value for this file, or NULL if parsing failed.
+     */
+    std::shared_ptr<Base> value;
+
+    /**
+     * Error message if parsing failed, otherwise empty.
+     */
+    std::string error;
+};
+
+/**
+ * @brief Summary of the changes detected by `DirectoryIndex::refresh()`.
+ */
+struct DirectoryRefresh {
+    /**
+     * Number of new files.
+     */
+    size_t added = 0;
+
+    /**
+     * Number of files with modified contents.
+     */
+    size_t modified = 0;
+
+    /**
+     * Number of files that were removed from the directory.
+     */
+    size_t removed = 0;
+
+    /**
+     * Number of files with unchanged contents.
+     * This includes files with a new modification time but the same hash.
+     */
+    size_t unchanged = 0;
+
+    /**
+     * Number of new or modified files that could not be parsed.
+     */
+    size_t failed = 0;
+};
+
+/**
+ * @cond
+ */
+inline uint64_t hash_contents(const std::string& contents) {
+    // Fixed seed so that hashes are comparable across processes.
+    KeyHash hasher(0x6d696c6c696a736full, 0x6469726563746f72ull);
+    return hasher(contents);
+}
+
+inline std::string read_contents(const std::string& path) {
+    FILE* handle = std::fopen(path.c_str(), "rb");
+    if (!handle) {
+        throw std::runtime_error("failed to open file at '" + path + "'");
+    }
+
+    std::string output;
+    char buffer[65536];
+    while (1) {
+        size_t n = std::fread(buffer, 1, sizeof(buffer), handle);
+        output.append(buffer, n);
+        if (n < sizeof(buffer)) {
+            break;
+        }
+    }
+
+    bool failed = std::ferror(handle);
+    std::fclose(handle);
+    if (failed) {
+        throw std::runtime_error("failed to read file at '" + path + "'");
+    }
+    return output;
+}
+
+// Calls 'fun(i)' for each 'i' in [0, n) on a pool of worker threads, each of which takes the next job from a shared counter.
+// 'fun' should not throw, so any errors should be caught and stored for each job.
+template<class Function_>
+void run_parallel_jobs(size_t n, size_t num_threads, Function_ fun) {
+    std::atomic<size_t> next(0);
+    auto work = [&]() -> void {
+        while (1) {
+            size_t i = next++;
+            if (i >= n) {
+                return;
+            }
+            fun(i);
+        }
+    };
+
+    size_t nthreads = std::min(std::max(num_threads, static_cast<size_t>(1)), n);
+    std::vector<std::thread> workers;
+    workers.reserve(nthreads);
+    for (size_t t = 0; t < nthreads; ++t) {
+        workers.emplace_back(work);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+// Writes to a temporary file that is then renamed to 'path', so that an existing file is not corrupted by an interrupted write.
+// 'fun' is called with a writer that accepts a pointer to a chunk of bytes and its length.
+template<class Function_>
+void write_file_atomically(const std::string& path, Function_ fun) {
+    auto tmp = path + ".tmp";
+    FILE* handle = std::fopen(tmp.c_str(), "wb");
+    if (!handle) {
+        throw std::runtime_error("failed to open file at '" + tmp + "'");
+    }
+    try {
+        fun([&](const char* ptr, size_t len) -> void {
+            if (std::fwrite(ptr, sizeof(char), len, handle) != len) {
+                throw std::runtime_error("failed to write to file at '" + tmp + "'");
+            }
+        });
+    } catch (...) {
+        std::fclose(handle);
+        std::remove(tmp.c_str());
+        throw;
+    }
+    if (std::fclose(handle)) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("failed to close file at '" + tmp + "'");
+    }
+
+    std::filesystem::rename(tmp, path);
+}
+
+inline const Base& cache_field(const Base& object, const char* name, Type type) {
+    if (object.type() != OBJECT) {
+        throw std::runtime_error("invalid directory index cache, expected an object");
+    }
+    const auto& values = object.get_object();
+    auto it = values.find(name);
+    if (it == values.end() || it->second->type() != type) {
+        throw std::runtime_error("invalid directory index cache, missing or invalid '" + std::string(name) + "'");
+    }
+    return *(it->second);
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Incrementally updated index of a directory of JSON files.
+ *
+ * This records the size, modification time and content hash of each JSON file in a directory tree, along with its parsed contents.
+ * On `refresh()`, only files with a new size or modification time are read, and only those with a new content hash are re-parsed.
+ * Parsing of these files is performed in parallel.
+ *
+ * The index can be persisted to a cache file with `save()` and restored with `load()`, so that a new process only needs to parse the files that changed in the meantime.
+ */
+class DirectoryIndex {
+public:
+    /**
+     * @param directory Path to the directory to be indexed.
+     * @param options Further options.
+     */
+    DirectoryIndex(std::string directory, DirectoryIndexOptions options = DirectoryIndexOptions()) : my_directory(std::move(directory)), my_options(std::move(options)) {}
+
+public:
+    /**
+     * Scan the directory and update the index.
+     * Files that cannot be parsed are still indexed, with their `IndexedFile::error` set.
+     *
+     * @return Summary of the detected changes.
+     */
+    DirectoryRefresh refresh() {
+        namespace fs = std::filesystem;
+        DirectoryRefresh summary;
+        std::map<std::string, IndexedFile> updated;
+
+        struct Pending {
+            std::string relative;
+            IndexedFile* file;
+            const IndexedFile* previous;
+        };
+        std::vector<Pending> pending;
+
+        for (const auto& entry : fs::recursive_directory_iterator(my_directory)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            const auto& path = entry.path();
+            if (!my_options.extension.empty() && path.extension() != my_options.extension) {
+                continue;
+            }
+
+            auto relative = path.lexically_relative(my_directory).generic_string();
+            auto& current = updated[relative];
+            current.size = entry.file_size();
+            current.mtime = entry.last_write_time().time_since_epoch().count();
+
+            auto it = my_files.find(relative);
+            if (it != my_files.end() && it->second.size == current.size && it->second.mtime == current.mtime) {
+                current = std::move(it->second);
+                ++summary.unchanged;
+            } else {
+                pending.push_back(Pending{ std::move(relative), &current, (it == my_files.end() ? nullptr : &(it->second)) });
+            }
+        }
+
+        // Reading, hashing and (if necessary) parsing each candidate file in parallel.
+        std::vector<char> changed(pending.size());
+        run_parallel_jobs(pending.size(), my_options.num_threads, [&](size_t i) -> void {
+            auto& job = pending[i];
+            auto& file = *(job.file);
+            try {
+                auto contents = read_contents((fs::path(my_directory) / job.relative).string());
+                file.size = contents.size();
+                file.hash = hash_contents(contents);
+                if (job.previous && job.previous->hash == file.hash) {
+                    file.value = job.previous->value;
+                    file.error = job.previous->error;
+                    return;
+                }
+                changed[i] = 1;
+                auto value = parse_string(contents.data(), contents.size());
+                if (my_options.extract) {
+                    value = my_options.extract(job.relative, std::move(value));
+                }
+                file.value = std::move(value);
+            } catch (std::exception& e) {
+                changed[i] = 1;
+                file.value.reset();
+                file.error = e.what();
+            }
+        });
+
+        for (size_t i = 0, end = pending.size(); i < end; ++i) {
+            const auto& job = pending[i];
+            if (!changed[i]) {
+                ++summary.unchanged;
+            } else {
+                if (job.previous) {
+                    ++summary.modified;
+                } else {
+                    ++summary.added;
+                }
+                if (!job.file->error.empty()) {
+                    ++summary.failed;
+                }
+            }
+        }
+
+        for (const auto& x : my_files) {
+            if (updated.find(x.first) == updated.end()) {
+                ++summary.removed;
+            }
+        }
+
+        my_files.swap(updated);
+        return summary;
+    }
+
+public:
+    /**
+     * @return Path to the indexed directory.
+     */
+    const std::string& directory() const {
+        return my_directory;
+    }
+
+    /**
+     * @return All indexed files, keyed by their paths relative to the directory (with forward slashes).
+     */
+    const std::map<std::string, IndexedFile>& files() const {
+        return my_files;
+    }
+
+    /**
+     * @param relative Path to a file, relative to the directory.
+     * @return The parsed value for this file, or NULL if the file is not indexed or could not be parsed.
+     */
+    std::shared_ptr<Base> get(const std::string& relative) const {
+        auto it = my_files.find(relative);
+        if (it == my_files.end()) {
+            return std::shared_ptr<Base>();
+        }
+        return it->second.value;
+    }
+
+public:
+    /**
+     * Save the index to a cache file, as a JSON document containing the metadata and values of all files.
+     * The cache is first written to a temporary file and then renamed, so an existing cache is not corrupted by an interrupted save.
+     *
+     * @param path Path to the cache file.
+     */
+    void save(const std::string& path) const {
+        Object root;
+        root.add("version", std::shared_ptr<Base>(new Number(1)));
+        root.add("directory", std::shared_ptr<Base>(new String(my_directory)));
+
+        auto files = new Object;
+        root.add("files", std::shared_ptr<Base>(files));
+        for (const auto& x : my_files) {
+            auto current = new Object;
+            files->add(x.first, std::shared_ptr<Base>(current));
+            // 64-bit quantities are stored as strings as they cannot be exactly represented by doubles.
+            current->add("size", std::shared_ptr<Base>(new String(std::to_string(x.second.size))));
+            current->add("mtime", std::shared_ptr<Base>(new String(std::to_string(x.second.mtime))));
+            current->add("hash", std::shared_ptr<Base>(new String(std::to_string(x.second.hash))));
+            if (x.second.value) {
+                current->add("value", x.second.value);
+            } else {
+                current->add("error", std::shared_ptr<Base>(new String(x.second.error)));
+            }
+        }
+
+        write_file_atomically(path, [&](auto writer) -> void {
+            serialize(root, writer);
+        });
+    }
+
+    /**
+     * Load the index from a cache file created by `save()`.
+     * The next `refresh()` will then only read and parse the files that were added or modified since the cache was saved.
+     *
+     * @param path Path to the cache file.
+     * @return Whether the cache was loaded.
+     * This is false if the cache file does not exist or was created for a different directory, in which case the index is not modified.
+     * An error is raised if the cache file is invalid.
+     */
+    bool load(const std::string& path) {
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        auto root = parse_file(path.c_str());
+        if (cache_field(*root, "version", NUMBER).get_number() != 1) {
+            throw std::runtime_error("unsupported directory index cache version");
+        }
+        if (cache_field(*root, "directory", STRING).get_string() != my_directory) {
+            return false;
+        }
+
+        std::map<std::string, IndexedFile> loaded;
+        for (const auto& x : cache_field(*root, "files", OBJECT).get_object()) {
+            auto& current = loaded[x.first];
+            try {
+                current.size = std::stoull(cache_field(*(x.second), "size", STRING).get_string());
+                current.mtime = std::stoll(cache_field(*(x.second), "mtime", STRING).get_string());
+                current.hash = std::stoull(cache_field(*(x.second), "hash", STRING).get_string());
+            } catch (std::logic_error&) {
+                throw std::runtime_error("invalid directory index cache, non-integer metadata for '" + x.first + "'");
+            }
+
+            const auto& fields = x.second->get_object();
+            auto vIt = fields.find("value");
+            if (vIt != fields.end()) {
+                current.value = vIt->second;
+            } else {
+                current.error = cache_field(*(x.second), "error", STRING).get_string();
+            }
+        }
+
+        my_files.swap(loaded);
+        return true;
+    }
+
+private:
+    std::string my_directory;
+    DirectoryIndexOptions my_options;
+    std::map<std::string, IndexedFile> my_files;
+};
+
+}
+
+#endif
@@ -0,0 +1,567 @@
+#ifndef MILLIJSON_EVENTS_HPP
+#define MILLIJSON_EVENTS_HPP
+
+#include "millijson.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file events.hpp
+ * @brief Event-based parsing of JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * Events emitted by an `EventReader` or `DomEventReader`.
+ */
+enum class Event {
+    START_ARRAY,
+    END_ARRAY,
+    START_OBJECT,
+    END_OBJECT,
+    KEY,
+    NUMBER,
+    STRING,
+    BOOLEAN,
+    NOTHING,
+    END
+};
+
+/**
+ * @brief Pull-based event parser for JSON documents.
+ *
+ * Each call to `next()` parses the next token from the input and returns the corresponding event, without building a DOM.
+ * This allows callers to process arbitrarily large documents with memory proportional to the nesting depth.
+ * Multiple readers can also be advanced in lockstep, e.g., to compare documents.
+ * The same validity checks are performed as in `parse()`, including for duplicate keys.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ */
+template<class Input>
+class EventReader {
+public:
+    /**
+     * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+     * This should outlive the `EventReader`.
+     */
+    EventReader(Input& input) : my_input(input) {}
+
+    /**
+     * @return The next event.
+     * `Event::END` is returned once the document is complete, after checking that there are no trailing non-space characters.
+     * An error is raised if the document is invalid.
+     */
+    Event next() {
+        chomp(my_input);
+
+        switch (my_state) {
+            case DONE:
+                return Event::END;
+
+            case VALUE:
+                if (!my_input.valid()) {
+                    throw std::runtime_error("no JSON value found at position " + std::to_string(my_input.position() + 1));
+                }
+                return read_value();
+
+            case AFTER_KEY:
+                check_unterminated();
+                if (my_input.get() != ':') {
+                    throw std::runtime_error("expected ':' to separate keys and values at position " + std::to_string(my_input.position() + 1));
+                }
+                my_input.advance();
+                chomp(my_input);
+                check_unterminated();
+                return read_value();
+
+            case FIRST_IN_ARRAY:
+                check_unterminated();
+                if (my_input.get() == ']') {
+                    return close();
+                }
+                return read_value();
+
+            case FIRST_IN_OBJECT:
+                check_unterminated();
+                if (my_input.get() == '}') {
+                    return close();
+                }
+                return read_key();
+
+            case AFTER_VALUE:
+                break;
+        }
+
+        if (my_stack.empty()) {
+            if (my_input.valid()) {
+                throw std::runtime_error("invalid json with trailing non-space characters at position " + std::to_string(my_input.position() + 1));
+            }
+            my_state = DONE;
+            return Event::END;
+        }
+
+        check_unterminated();
+        char next = my_input.get();
+        bool is_array = my_stack.back() == '[';
+        if (next == (is_array ? ']' : '}')) {
+            return close();
+        } else if (next != ',') {
+            throw std::runtime_error("unknown character '" + std::string(1, next) + "' in " + (is_array ? "array" : "object") + " at position " + std::to_string(my_input.position() + 1));
+        }
+
+        my_input.advance();
+        chomp(my_input);
+        check_unterminated();
+        if (is_array) {
+            return read_value();
+        } else {
+            return read_key();
+        }
+    }
+
+    /**
+     * @return The number, if the current event is `Event::NUMBER`.
+     */
+    double get_number() const {
+        return my_number;
+    }
+
+    /**
+     * @return The string, if the current event is `Event::STRING` or `Event::KEY`.
+     */
+    const std::string& get_string() const {
+        return my_string;
+    }
+
+    /**
+     * @return The boolean, if the current event is `Event::BOOLEAN`.
+     */
+    bool get_boolean() const {
+        return my_boolean;
+    }
+
+    /**
+     * @return Number of arrays and objects that enclose the current position.
+     * For `Event::START_ARRAY` and `Event::START_OBJECT`, this includes the newly started container.
+     */
+    size_t depth() const {
+        return my_stack.size();
+    }
+
+    /**
+     * @return Position of the first byte of the token for the current event.
+     * For `Event::END`, this is the length of the input.
+     */
+    size_t position() const {
+        return my_token;
+    }
+
+    /**
+     * @return Pointer to the input bytes that are currently available, starting immediately after the token for the current event.
+     * This is NULL if `Input` does not support bulk access via `current()`, `remaining()` and `skip()`.
+     */
+    const char* raw_pointer() const {
+        if constexpr(has_bulk_access<Input>::value) {
+            return (my_input.valid() ? my_input.current() : nullptr);
+        } else {
+            return nullptr;
+        }
+    }
+
+    /**
+     * @return Number of bytes available from `raw_pointer()`.
+     * This may be less than the remaining length of the input, e.g., if the input is read in chunks.
+     * It is always zero if `Input` does not support bulk access.
+     */
+    size_t raw_available() const {
+        if constexpr(has_bulk_access<Input>::value) {
+            return (my_input.valid() ? my_input.remaining() : 0);
+        } else {
+            return 0;
+        }
+    }
+
+    /**
+     * Skip the rest of the current array or object without parsing it.
+     * This should only be called immediately after `Event::START_ARRAY` or `Event::START_OBJECT`.
+     * The next event is the one after the end of the array or object, i.e., the corresponding `Event::END_ARRAY` or `Event::END_OBJECT` is not emitted.
+     *
+     * The skipped bytes are not validated, so this is only appropriate if they have already been checked,
+     * e.g., for balanced brackets and strings by comparison to a known structure.
+     *
+     * @param n Number of bytes from `raw_pointer()` up to and including the closing bracket of the current array or object.
+     * This should be no greater than `raw_available()`.
+     */
+    void skip_raw(size_t n) {
+        if constexpr(has_bulk_access<Input>::value) {
+            my_input.skip(n);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                my_input.advance();
+            }
+        }
+
+        my_token = my_input.position() - 1;
+        if (my_stack.back() == '{') {
+            my_keys.pop_back();
+        }
+        my_stack.pop_back();
+        my_starts.pop_back();
+        my_state = AFTER_VALUE;
+    }
+
+private:
+    Input& my_input;
+
+    enum State { VALUE, FIRST_IN_ARRAY, FIRST_IN_OBJECT, AFTER_VALUE, AFTER_KEY, DONE };
+    State my_state = VALUE;
+
+    std::vector<char> my_stack;
+    std::vector<size_t> my_starts;
+    std::vector<std::unordered_set<std::string, KeyHash> > my_keys;
+
+    double my_number = 0;
+    std::string my_string;
+    bool my_boolean = false;
+    size_t my_token = 0;
+
+    void check_unterminated() const {
+        if (!my_input.valid()) {
+            if (my_stack.back() == '[') {
+                throw std::runtime_error("unterminated array starting at position " + std::to_string(my_starts.back()));
+            } else {
+                throw std::runtime_error("unterminated object starting at position " + std::to_string(my_starts.back()));
+            }
+        }
+    }
+
+    Event close() {
+        my_token = my_input.position();
+        char current = my_stack.back();
+        my_stack.pop_back();
+        my_starts.pop_back();
+        my_input.advance();
+        my_state = AFTER_VALUE;
+
+        if (current == '[') {
+            return Event::END_ARRAY;
+        } else {
+            my_keys.pop_back();
+            return Event::END_OBJECT;
+        }
+    }
+
+    Event read_key() {
+        my_token = my_input.position();
+        if (my_input.get() != '"') {
+            throw std::runtime_error("expected a string as the object key at position " + std::to_string(my_input.position() + 1));
+        }
+        my_string = extract_string(my_input);
+        if (!my_keys.back().insert(my_string).second) {
+            throw std::runtime_error("detected duplicate keys in the object at position " + std::to_string(my_input.position() + 1));
+        }
+        my_state = AFTER_KEY;
+        return Event::KEY;
+    }
+
+    Event read_value() {
+        my_token = my_input.position();
+        size_t start = my_token + 1;
+        const char current = my_input.get();
+        my_state = AFTER_VALUE;
+
+        if (current == '[') {
+            my_stack.push_back('[');
+            my_starts.push_back(start);
+            my_input.advance();
+            my_state = FIRST_IN_ARRAY;
+            return Event::START_ARRAY;
+
+        } else if (current == '{') {
+            my_stack.push_back('{');
+            my_starts.push_back(start);
+            my_keys.emplace_back();
+            my_input.advance();
+            my_state = FIRST_IN_OBJECT;
+            return Event::START_OBJECT;
+
+        } else if (current == 't') {
+            if (!is_expected_string(my_input, "true")) {
+                throw std::runtime_error("expected a 'true' string at position " + std::to_string(start));
+            }
+            my_boolean = true;
+            return Event::BOOLEAN;
+
+        } else if (current == 'f') {
+            if (!is_expected_string(my_input, "false")) {
+                throw std::runtime_error("expected a 'false' string at position " + std::to_string(start));
+            }
+            my_boolean = false;
+            return Event::BOOLEAN;
+
+        } else if (current == 'n') {
+            if (!is_expected_string(my_input, "null")) {
+                throw std::runtime_error("expected a 'null' string at position " + std::to_string(start));
+            }
+            return Event::NOTHING;
+
+        } else if (current == '"') {
+            my_string = extract_string(my_input);
+            return Event::STRING;
+
+        } else if (current == '-') {
+            if (!my_input.advance()) {
+                throw std::runtime_error("incomplete number starting at position " + std::to_string(start));
+            }
+            my_number = -extract_number(my_input);
+            return Event::NUMBER;
+
+        } else if (current >= '0' && current <= '9') {
+            my_number = extract_number(my_input);
+            return Event::NUMBER;
+        }
+
+        throw std::runtime_error(std::string("unknown type starting with '") + std::string(1, current) + "' at position " + std::to_string(start));
+    }
+};
+
+/**
+ * @brief Events for an existing DOM.
+ *
+ * This emits the same events as `EventReader` for a parsed JSON value, so that code written for event streams can also be applied to DOMs.
+ * Object keys are emitted in the iteration order of the underlying `std::unordered_map`, or in sorted order if requested.
+ */
+class DomEventReader {
+public:
+    /**
+     * @param value A JSON value.
+     * This should outlive the `DomEventReader`.
+     * @param sorted Whether to emit the keys of each object in sorted order.
+     * This ensures that two readers emit the keys of equal objects in the same order.
+     */
+    DomEventReader(const Base& value, bool sorted = false) : my_root(&value), my_sorted(sorted) {}
+
+    /**
+     * @return The next event.
+     * `Event::END` is returned once all events have been emitted.
+     */
+    Event next() {
+        if (my_root) {
+            auto root = my_root;
+            my_root = nullptr;
+            return emit(*root);
+        }
+
+        if (my_stack.empty()) {
+            return Event::END;
+        }
+
+        auto& frame = my_stack.back();
+        if (frame.node->type() == ARRAY) {
+            const auto& array = frame.node->get_array();
+            if (frame.index == array.size()) {
+                my_stack.pop_back();
+                return Event::END_ARRAY;
+            }
+            const Base* child = array[frame.index].get();
+            ++frame.index;
+            return emit(*child);
+        }
+
+        if (my_sorted) {
+            if (frame.pending) {
+                frame.pending = false;
+                const Base* child = frame.entries[frame.index]->second.get();
+                ++frame.index;
+                return emit(*child);
+            }
+            if (frame.index == frame.entries.size()) {
+                my_stack.pop_back();
+                return Event::END_OBJECT;
+            }
+            my_string = frame.entries[frame.index]->first;
+            frame.pending = true;
+            return Event::KEY;
+        }
+
+        if (frame.pending) {
+            frame.pending = false;
+            const Base* child = frame.it->second.get();
+            ++frame.it;
+            return emit(*child);
+        }
+        if (frame.it == frame.node->get_object().end()) {
+            my_stack.pop_back();
+            return Event::END_OBJECT;
+        }
+        my_string = frame.it->first;
+        frame.pending = true;
+        return Event::KEY;
+    }
+
+    /**
+     * @return The number, if the current event is `Event::NUMBER`.
+     */
+    double get_number() const {
+        return my_number;
+    }
+
+    /**
+     * @return The string, if the current event is `Event::STRING` or `Event::KEY`.
+     */
+    const std::string& get_string() const {
+        return my_string;
+    }
+
+    /**
+     * @return The boolean, if the current event is `Event::BOOLEAN`.
+     */
+    bool get_boolean() const {
+        return my_boolean;
+    }
+
+    /**
+     * @return Number of arrays and objects that enclose the current position.
+     */
+    size_t depth() const {
+        return my_stack.size();
+    }
+
+private:
+    const Base* my_root;
+    bool my_sorted;
+
+    struct Frame {
+        Frame(const Base* n, bool sorted) : node(n) {
+            if (n->type() == OBJECT) {
+                const auto& object = n->get_object();
+                if (sorted) {
+                    entries.reserve(object.size());
+                    for (const auto& x : object) {
+                        entries.push_back(&x);
+                    }
+                    std::sort(entries.begin(), entries.end(), [](const auto* left, const auto* right) -> bool { return left->first < right->first; });
+                } else {
+                    it = object.begin();
+                }
+            }
+        }
+        const Base* node;
+        size_t index = 0; // for arrays, and for objects in sorted mode.
+        ObjectMap::const_iterator it;
+        std::vector<const ObjectMap::value_type*> entries; // only used in sorted mode.
+        bool pending = false;
+    };
+    std::vector<Frame> my_stack;
+
+    double my_number = 0;
+    std::string my_string;
+    bool my_boolean = false;
+
+    Event emit(const Base& value) {
+        switch (value.type()) {
+            case NUMBER:
+                my_number = value.get_number();
+                return Event::NUMBER;
+            case STRING:
+                my_string = value.get_string();
+                return Event::STRING;
+            case BOOLEAN:
+                my_boolean = value.get_boolean();
+                return Event::BOOLEAN;
+            case NOTHING:
+                return Event::NOTHING;
+            case ARRAY:
+                my_stack.emplace_back(&value, false);
+                return Event::START_ARRAY;
+            case OBJECT:
+                my_stack.emplace_back(&value, my_sorted);
+                return Event::START_OBJECT;
+        }
+        return Event::END; // Technically unreachable, but whatever.
+    }
+};
+
+/**
+ * Skip the current value in an event stream.
+ * For arrays and objects, this consumes all events up to and including the matching end.
+ *
+ * @tparam Reader An `EventReader` or `DomEventReader`.
+ * @param reader Instance of a `Reader`.
+ * @param current The current event, i.e., the last one returned by `reader.next()`.
+ * This should be the start of a value.
+ */
+template<class Reader>
+void skip(Reader& reader, Event current) {
+    if (current != Event::START_ARRAY && current != Event::START_OBJECT) {
+        return;
+    }
+    size_t open = 1;
+    while (open) {
+        auto event = reader.next();
+        if (event == Event::START_ARRAY || event == Event::START_OBJECT) {
+            ++open;
+        } else if (event == Event::END_ARRAY || event == Event::END_OBJECT) {
+            --open;
+        }
+    }
+}
+
+/**
+ * Build a DOM for the current value in an event stream.
+ * For arrays and objects, this consumes all events up to and including the matching end.
+ *
+ * @tparam Reader An `EventReader` or `DomEventReader`.
+ * @param reader Instance of a `Reader`.
+ * @param current The current event, i.e., the last one returned by `reader.next()`.
+ * This should be the start of a value.
+ * @return Pointer to the JSON value.
+ */
+template<class Reader>
+std::shared_ptr<Base> collect(Reader& reader, Event current) {
+    switch (current) {
+        case Event::NUMBER:
+            return std::shared_ptr<Base>(new Number(reader.get_number()));
+        case Event::STRING:
+            return std::shared_ptr<Base>(new String(reader.get_string()));
+        case Event::BOOLEAN:
+            return std::shared_ptr<Base>(new Boolean(reader.get_boolean()));
+        case Event::NOTHING:
+            return std::shared_ptr<Base>(new Nothing);
+        case Event::START_ARRAY:
+            {
+                auto ptr = new Array;
+                std::shared_ptr<Base> output(ptr);
+                while (1) {
+                    auto event = reader.next();
+                    if (event == Event::END_ARRAY) {
+                        break;
+                    }
+                    ptr->add(collect(reader, event));
+                }
+                return output;
+            }
+        case Event::START_OBJECT:
+            {
+                auto ptr = new Object;
+                std::shared_ptr<Base> output(ptr);
+                while (reader.next() == Event::KEY) {
+                    auto key = reader.get_string();
+                    ptr->add(std::move(key), collect(reader, reader.next()));
+                }
+                return output;
+            }
+        default:
+            throw std::runtime_error("event does not represent the start of a value");
+    }
+}
+
+}
+
+#endif
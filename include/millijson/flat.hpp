@@ -0,0 +1,272 @@
+#ifndef MILLIJSON_FLAT_HPP
+#define MILLIJSON_FLAT_HPP
+
+#include "millijson.hpp"
+#include "patch.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file flat.hpp
+ * @brief Flattened index of JSON pointers in a document.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Index from JSON pointers to the values of a document.
+ *
+ * This maps the full JSON pointer of every value in the document to the value itself,
+ * so that deeply nested values can be retrieved with a single hash lookup instead of one lookup per path component.
+ * Pointers are also kept in sorted order to iterate over all values under a given prefix.
+ *
+ * This trades memory for speed and is intended for read-mostly documents.
+ * The index holds references to the values in the document, but it is not updated when the document is modified;
+ * after any structural modification, a new index should be constructed.
+ */
+class PointerIndex {
+public:
+    /**
+     * Construct an empty index.
+     */
+    PointerIndex() = default;
+
+    /**
+     * @param root Root of a JSON document.
+     * @param leaves_only Whether to only index scalar values and empty arrays/objects.
+     * This reduces memory usage if only the leaves will be retrieved.
+     */
+    PointerIndex(const std::shared_ptr<Base>& root, bool leaves_only = false) : my_leaves_only(leaves_only) {
+        std::string path;
+        walk(root, path);
+        finalize();
+    }
+
+    /**
+     * @cond
+     */
+    // Sorted pointers need to be regenerated for the copied map.
+    PointerIndex(const PointerIndex& other) : my_map(other.my_map), my_leaves_only(other.my_leaves_only) {
+        finalize();
+    }
+
+    PointerIndex& operator=(const PointerIndex& other) {
+        if (this != &other) {
+            my_map = other.my_map;
+            my_leaves_only = other.my_leaves_only;
+            finalize();
+        }
+        return *this;
+    }
+
+    PointerIndex(PointerIndex&&) = default;
+    PointerIndex& operator=(PointerIndex&&) = default;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param pointer JSON pointer to a value, e.g., `"/a/b/0/c"`.
+     * An empty string refers to the root.
+     * @return Pointer to the value, or NULL if no value is indexed at `pointer`.
+     */
+    std::shared_ptr<Base> get(const std::string& pointer) const {
+        auto it = my_map.find(pointer);
+        if (it == my_map.end()) {
+            return std::shared_ptr<Base>();
+        }
+        return it->second;
+    }
+
+    /**
+     * @param pointer JSON pointer to a value.
+     * @return Whether a value is indexed at `pointer`.
+     */
+    bool has(const std::string& pointer) const {
+        return my_map.find(pointer) != my_map.end();
+    }
+
+    /**
+     * Iterate over all indexed values at or below a prefix, in sorted order of their pointers.
+     *
+     * @tparam Function_ Callable that accepts a `const std::string&` (the JSON pointer) and a `const std::shared_ptr<Base>&` (the value).
+     * @param prefix JSON pointer to a value, e.g., `"/a/b"`.
+     * This matches `"/a/b"` and `"/a/b/c"` but not `"/a/bc"`.
+     * An empty string matches all values.
+     * @param fun Instance of a `Function_`.
+     * @return Number of values that were visited.
+     */
+    template<class Function_>
+    size_t for_each_prefix(const std::string& prefix, Function_ fun) const {
+        size_t count = 0;
+        auto it = my_map.find(prefix);
+        if (it != my_map.end()) {
+            fun(it->first, it->second);
+            ++count;
+        }
+
+        // All descendants are contiguous in the sorted order, as they all start with the prefix and a slash.
+        std::string start = prefix + "/";
+        auto sIt = std::lower_bound(my_sorted.begin(), my_sorted.end(), start, [](const MapEntry* left, const std::string& right) -> bool { return left->first < right; });
+        for (; sIt != my_sorted.end(); ++sIt) {
+            const auto& key = (*sIt)->first;
+            if (key.compare(0, start.size(), start) != 0) {
+                break;
+            }
+            fun(key, (*sIt)->second);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @return Number of indexed values.
+     */
+    size_t size() const {
+        return my_map.size();
+    }
+
+private:
+    typedef std::pair<const std::string, std::shared_ptr<Base> > MapEntry;
+    ObjectMap my_map;
+    std::vector<const MapEntry*> my_sorted; // keys of unordered_maps have stable addresses.
+    bool my_leaves_only = false;
+
+    void walk(const std::shared_ptr<Base>& node, std::string& path) {
+        auto type = node->type();
+        size_t n = 0;
+        if (type == ARRAY) {
+            const auto& array = node->get_array();
+            n = array.size();
+            size_t original = path.size();
+            for (size_t i = 0; i < n; ++i) {
+                path += '/';
+                path += std::to_string(i);
+                walk(array[i], path);
+                path.resize(original);
+            }
+        } else if (type == OBJECT) {
+            const auto& object = node->get_object();
+            n = object.size();
+            size_t original = path.size();
+            for (const auto& x : object) {
+                append_pointer(path, x.first);
+                walk(x.second, path);
+                path.resize(original);
+            }
+        }
+
+        if (!my_leaves_only || n == 0) {
+            my_map.emplace(path, node);
+        }
+    }
+
+    void finalize() {
+        my_sorted.clear();
+        my_sorted.reserve(my_map.size());
+        for (const auto& x : my_map) {
+            my_sorted.push_back(&x);
+        }
+        std::sort(my_sorted.begin(), my_sorted.end(), [](const MapEntry* left, const MapEntry* right) -> bool { return left->first < right->first; });
+    }
+
+    friend struct FlatProvisioner;
+};
+
+/**
+ * @cond
+ */
+// Adds each value to the index as soon as it is parsed, using the pointer tracked by the base class.
+struct FlatProvisioner : public TrackingProvisioner<true> {
+    FlatProvisioner(PointerIndex& index, bool leaves_only) : index(index) {
+        index.my_leaves_only = leaves_only;
+    }
+
+    PointerIndex& index;
+
+    template<class Input_>
+    void leave(const Input_& input, const std::shared_ptr<Base>& value) {
+        if (!index.my_leaves_only || stack.back().count == 0) {
+            index.my_map.emplace(path, value);
+        }
+        TrackingProvisioner<true>::leave(input, value);
+    }
+
+    void finish() {
+        index.finalize();
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @brief A JSON document with a flattened index of its pointers.
+ */
+struct FlatDocument {
+    /**
+     * Root of the document.
+     */
+    std::shared_ptr<Base> root;
+
+    /**
+     * Index of all values in `root`.
+     */
+    PointerIndex index;
+};
+
+/**
+ * Parse a JSON document while building a `PointerIndex` of its values.
+ * This avoids a second traversal of the document after parsing.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ *
+ * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+ * @param leaves_only Whether to only index the leaves, see `PointerIndex` for details.
+ *
+ * @return The parsed document and its index.
+ */
+template<class Input>
+FlatDocument parse_flat(Input& input, bool leaves_only = false) {
+    FlatDocument output;
+    chomp(input);
+    if (!input.valid()) {
+        throw std::runtime_error("no JSON value found at position " + std::to_string(input.position() + 1));
+    }
+    FlatProvisioner provisioner(output.index, leaves_only);
+    output.root = parse_thing_with_chomp(input, provisioner);
+    provisioner.finish();
+    return output;
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param leaves_only Whether to only index the leaves, see `PointerIndex` for details.
+ * @return The parsed document and its index, see `parse_flat()` for details.
+ */
+inline FlatDocument parse_string_flat(const char* ptr, size_t len, bool leaves_only = false) {
+    RawReader input(ptr, len);
+    return parse_flat(input, leaves_only);
+}
+
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param leaves_only Whether to only index the leaves, see `PointerIndex` for details.
+ * @param buffer_size Size of the buffer to use for reading the file.
+ * @return The parsed document and its index, see `parse_flat()` for details.
+ */
+inline FlatDocument parse_file_flat(const char* path, bool leaves_only = false, size_t buffer_size = 65536) {
+    FileReader input(path, buffer_size);
+    return parse_flat(input, leaves_only);
+}
+
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef MILLIJSON_FOLLOW_HPP
+#define MILLIJSON_FOLLOW_HPP
+
+#include "millijson.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
+
+/**
+ * @file follow.hpp
+ * @brief Follow a growing NDJSON file.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Parse records from a newline-delimited JSON file as it is being appended to.
+ *
+ * Each call to `poll()` reads the bytes that were appended since the previous call and parses all newly completed records.
+ * A partially written record at the end of the file is held back until its terminating newline is written.
+ * The offset of the first unparsed record is available from `offset()`, which can be saved and passed to the constructor to resume from the same place later.
+ *
+ * On Linux, `wait()` uses inotify to wake up as soon as the file is modified, and the inotify file descriptor is available from `fd()` for registration with `epoll()`.
+ * On other platforms, `wait()` falls back to periodic polling.
+ *
+ * If the file is truncated (e.g., by log rotation with `copytruncate`), reading restarts from the beginning of the file.
+ * However, rename-based rotation is not followed: the follower keeps reading the original file via its open descriptor,
+ * so a new `NdjsonFollower` should be constructed for any new file created at the same path.
+ */
+class NdjsonFollower {
+public:
+    /**
+     * @param path Path to the NDJSON file.
+     * @param offset Position in the file at which to start reading.
+     * This should be at the start of a record, e.g., a value previously returned by `offset()`.
+     * @param buffer_size Size of the buffer to use for reading the file.
+     */
+    NdjsonFollower(std::string path, size_t offset = 0, size_t buffer_size = 65536) : my_path(std::move(path)), my_offset(offset), my_buffer(buffer_size) {
+        my_handle = ::open(my_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (my_handle < 0) {
+            throw std::runtime_error("failed to open file at '" + my_path + "'");
+        }
+
+#if defined(__linux__)
+        my_notify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (my_notify < 0 || ::inotify_add_watch(my_notify, my_path.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE) < 0) {
+            cleanup();
+            throw std::runtime_error("failed to watch file at '" + my_path + "'");
+        }
+#endif
+    }
+
+    /**
+     * @cond
+     */
+    NdjsonFollower(const NdjsonFollower&) = delete;
+    NdjsonFollower& operator=(const NdjsonFollower&) = delete;
+
+    ~NdjsonFollower() {
+        cleanup();
+    }
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @return Position in the file of the first record that has not yet been parsed.
+     */
+    size_t offset() const {
+        return my_offset;
+    }
+
+    /**
+     * @return File descriptor that becomes readable when the file is modified.
+     * This is -1 on platforms without inotify support.
+     */
+    int fd() const {
+        return my_notify;
+    }
+
+    /**
+     * Parse all complete records that were appended since the last call.
+     * Empty lines are ignored.
+     * This does not block if no new records are available.
+     *
+     * @tparam Callback Any callable that accepts a `std::shared_ptr<Base>` containing the parsed record and a `size_t` containing the position of the record in the file.
+     * @param callback Function to be called on each record.
+     * @return Number of records that were parsed.
+     *
+     * If a complete record cannot be parsed, an error is raised after the offset is advanced past the invalid record.
+     * This allows subsequent calls to continue with the next record.
+     *
+     * If `callback` throws, the exception is propagated after committing all records for which `callback` has already returned.
+     * The record for which `callback` threw will be delivered again by the next call.
+     */
+    template<class Callback>
+    size_t poll(Callback callback) {
+        struct stat info;
+        if (::fstat(my_handle, &info) != 0) {
+            throw std::runtime_error("failed to inspect file at '" + my_path + "'");
+        }
+
+        size_t end = info.st_size;
+        size_t read_from = my_offset + my_pending.size();
+        if (end < read_from) {
+            // File was truncated, so we start again.
+            my_offset = 0;
+            my_pending.clear();
+            my_searched = 0;
+            read_from = 0;
+        }
+
+        // Finishing off any records left over after a parsing error in a previous call.
+        size_t nrecords = consume(callback);
+
+        while (read_from < end) {
+            auto got = ::pread(my_handle, my_buffer.data(), std::min(my_buffer.size(), end - read_from), read_from);
+            if (got < 0) {
+                throw std::runtime_error("failed to read file at '" + my_path + "'");
+            } else if (got == 0) {
+                break;
+            }
+            read_from += got;
+
+            my_pending.append(my_buffer.data(), got);
+            nrecords += consume(callback);
+        }
+
+        return nrecords;
+    }
+
+    /**
+     * Wait for the file to be modified and then parse any new complete records with `poll()`.
+     * Any records that are already available are parsed immediately without waiting.
+     *
+     * @tparam Callback Any callable that accepts a `std::shared_ptr<Base>` and `size_t`, see `poll()` for details.
+     * @param callback Function to be called on each record.
+     * @param timeout Maximum time to wait.
+     * @return Number of records that were parsed, which may be zero if the timeout expired.
+     */
+    template<class Callback>
+    size_t wait(Callback callback, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (1) {
+            auto n = poll(callback);
+            if (n) {
+                return n;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return 0;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+
+#if defined(__linux__)
+            pollfd pfd;
+            pfd.fd = my_notify;
+            pfd.events = POLLIN;
+            if (::poll(&pfd, 1, static_cast<int>(remaining.count()) + 1) > 0) {
+                // Draining the events, as we only care that something happened.
+                char events[4096];
+                while (::read(my_notify, events, sizeof(events)) > 0) {}
+            }
+#else
+            std::this_thread::sleep_for(std::min(remaining, std::chrono::milliseconds(50)));
+#endif
+        }
+    }
+
+private:
+    std::string my_path;
+    size_t my_offset;
+    std::vector<char> my_buffer;
+    std::string my_pending;
+    size_t my_searched = 0; // number of bytes in 'my_pending' that are known to lack newlines.
+    int my_handle = -1;
+    int my_notify = -1;
+
+    void cleanup() {
+        if (my_handle >= 0) {
+            ::close(my_handle);
+        }
+        if (my_notify >= 0) {
+            ::close(my_notify);
+        }
+    }
+
+    template<class Callback>
+    size_t consume(Callback& callback) {
+        size_t start = 0, nrecords = 0;
+        size_t base = my_offset;
+
+        try {
+            for (size_t i = my_searched, end = my_pending.size(); i < end; ++i) {
+                if (my_pending[i] != '\n') {
+                    continue;
+                }
+
+                size_t record_offset = base + start;
+                const char* ptr = my_pending.data() + start;
+                size_t len = i - start;
+
+                bool empty = std::all_of(ptr, ptr + len, [](char x) -> bool { return isspace(x); });
+                if (empty) {
+                    start = i + 1;
+                    my_offset = base + start;
+                    continue;
+                }
+
+                std::shared_ptr<Base> record;
+                try {
+                    record = parse_string(ptr, len);
+                } catch (std::exception& e) {
+                    start = i + 1;
+                    my_offset = base + start;
+                    throw std::runtime_error("failed to parse record at offset " + std::to_string(record_offset) + " (" + e.what() + ")");
+                }
+
+                callback(std::move(record), record_offset);
+                ++nrecords;
+
+                // Committing each record as soon as its callback returns, so that it is not delivered again if a later callback throws.
+                start = i + 1;
+                my_offset = base + start;
+            }
+
+        } catch (...) {
+            my_pending.erase(0, start);
+            my_searched = 0;
+            throw;
+        }
+
+        my_pending.erase(0, start);
+        my_searched = my_pending.size();
+        return nrecords;
+    }
+};
+
+}
+
+#endif
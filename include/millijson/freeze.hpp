@@ -0,0 +1,313 @@
+#ifndef MILLIJSON_FREEZE_HPP
+#define MILLIJSON_FREEZE_HPP
+
+#include "millijson.hpp"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <utility>
+
+/**
+ * @file freeze.hpp
+ * @brief Compact read-only copies of parsed JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * @cond
+ */
+struct FrozenNode {
+    Type type;
+
+    // String length, number of children or the boolean value.
+    size_t size;
+
+    union {
+        double number;
+        size_t offset; // into the characters for strings, into the nodes for arrays/objects.
+    };
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Read-only view of a value in a `Frozen` document.
+ *
+ * This is a lightweight handle that can be cheaply copied.
+ * It remains valid as long as the parent `Frozen` object exists, even if the latter is moved.
+ * Its accessors follow the names of those in `Base`, but it is not a `Base` and cannot be used where a `const Base&` is expected.
+ */
+class FrozenValue {
+public:
+    /**
+     * @cond
+     */
+    FrozenValue(const FrozenNode* nodes, const char* chars, size_t index) : my_nodes(nodes), my_chars(chars), my_index(index) {}
+    /**
+     * @endcond
+     */
+
+    /**
+     * @return Type of the JSON value.
+     */
+    Type type() const {
+        return node().type;
+    }
+
+    /**
+     * @return The number, if this value is a `NUMBER`.
+     */
+    double get_number() const {
+        return node().number;
+    }
+
+    /**
+     * @return The string, if this value is a `STRING`.
+     */
+    std::string_view get_string() const {
+        const auto& current = node();
+        return std::string_view(my_chars + current.offset, current.size);
+    }
+
+    /**
+     * @return The boolean, if this value is a `BOOLEAN`.
+     */
+    bool get_boolean() const {
+        return node().size;
+    }
+
+    /**
+     * @return Number of elements in the array, if this value is an `ARRAY`;
+     * or the number of key-value pairs, if this value is an `OBJECT`.
+     */
+    size_t size() const {
+        return node().size;
+    }
+
+    /**
+     * @param i Index of the element of interest.
+     * For objects, key-value pairs are sorted by key.
+     * @return The `i`-th array element, if this value is an `ARRAY`;
+     * or the value of the `i`-th key-value pair, if this value is an `OBJECT`.
+     */
+    FrozenValue element(size_t i) const {
+        const auto& current = node();
+        if (current.type == OBJECT) {
+            return FrozenValue(my_nodes, my_chars, current.offset + 2 * i + 1);
+        } else {
+            return FrozenValue(my_nodes, my_chars, current.offset + i);
+        }
+    }
+
+    /**
+     * @param i Index of the key-value pair of interest, if this value is an `OBJECT`.
+     * @return Key of the `i`-th key-value pair.
+     */
+    std::string_view key(size_t i) const {
+        return FrozenValue(my_nodes, my_chars, node().offset + 2 * i).get_string();
+    }
+
+    /**
+     * @param key String containing the key.
+     * @return Index of the key-value pair with key equal to `key`, if this value is an `OBJECT`.
+     * If `key` is not present, `size()` is returned instead.
+     */
+    size_t find(std::string_view key) const {
+        size_t left = 0, right = size();
+        while (left < right) {
+            size_t mid = left + (right - left) / 2;
+            auto candidate = this->key(mid);
+            if (candidate < key) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
+        }
+        if (left < size() && this->key(left) == key) {
+            return left;
+        }
+        return size();
+    }
+
+    /**
+     * @param key String containing the key.
+     * @return Whether `key` exists in the object.
+     */
+    bool has(std::string_view key) const {
+        return find(key) != size();
+    }
+
+private:
+    const FrozenNode* my_nodes;
+    const char* my_chars;
+    size_t my_index;
+
+    const FrozenNode& node() const {
+        return my_nodes[my_index];
+    }
+};
+
+/**
+ * @brief Compact read-only copy of a JSON document.
+ *
+ * All values are stored in a single contiguous array in depth-first order, with the children of each array or object stored next to each other.
+ * All string contents are similarly stored in a single contiguous buffer.
+ * Object keys are sorted to allow binary searches without any hash table.
+ * This improves memory locality and reduces the memory footprint of long-lived documents, at the cost of immutability.
+ *
+ * Note that a frozen document is read through `FrozenValue`, which is a separate API from `Base`.
+ * `FrozenValue` uses the same names for its scalar accessors, e.g., `type()`, `get_number()`, `get_string()`, so simple code can be ported by changing the types;
+ * however, it cannot be passed to functions that accept a `const Base&`, and array/object children are accessed by index via `element()` and `key()`.
+ */
+class Frozen {
+public:
+    /**
+     * Create an empty document, typically to be assigned to later.
+     */
+    Frozen() = default;
+
+    /**
+     * @param value A JSON value, typically the root of a document returned by `parse()`.
+     * A compact copy is created of `value` and all of its children.
+     */
+    explicit Frozen(const Base& value) {
+        size_t nnodes = 1, nchars = 0;
+        count(value, nnodes, nchars);
+        my_nodes.reserve(nnodes);
+        my_chars.reserve(nchars);
+        my_nodes.resize(1);
+        fill(0, value);
+    }
+
+public:
+    /**
+     * @return View of the root value of the document.
+     * This should only be called if the document was constructed from a value.
+     */
+    FrozenValue root() const {
+        return FrozenValue(my_nodes.data(), my_chars.data(), 0);
+    }
+
+    /**
+     * @return Approximate number of bytes used by this document.
+     */
+    size_t memory() const {
+        return sizeof(Frozen) + my_nodes.capacity() * sizeof(FrozenNode) + my_chars.capacity();
+    }
+
+private:
+    std::vector<FrozenNode> my_nodes;
+    std::vector<char> my_chars; // not a std::string, whose small-string buffer would move with the object and invalidate existing views.
+
+    static void count(const Base& value, size_t& nnodes, size_t& nchars) {
+        switch (value.type()) {
+            case STRING:
+                nchars += value.get_string().size();
+                break;
+            case ARRAY:
+                {
+                    const auto& array = value.get_array();
+                    nnodes += array.size();
+                    for (const auto& x : array) {
+                        count(*x, nnodes, nchars);
+                    }
+                }
+                break;
+            case OBJECT:
+                {
+                    const auto& object = value.get_object();
+                    nnodes += object.size() * 2;
+                    for (const auto& x : object) {
+                        nchars += x.first.size();
+                        count(*(x.second), nnodes, nchars);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void fill_string(size_t index, const std::string& value) {
+        auto& current = my_nodes[index];
+        current.type = STRING;
+        current.size = value.size();
+        current.offset = my_chars.size();
+        my_chars.insert(my_chars.end(), value.begin(), value.end());
+    }
+
+    void fill(size_t index, const Base& value) {
+        auto type = value.type();
+        switch (type) {
+            case NUMBER:
+                my_nodes[index].type = NUMBER;
+                my_nodes[index].size = 0;
+                my_nodes[index].number = value.get_number();
+                break;
+            case STRING:
+                fill_string(index, value.get_string());
+                break;
+            case BOOLEAN:
+                my_nodes[index].type = BOOLEAN;
+                my_nodes[index].size = value.get_boolean();
+                my_nodes[index].offset = 0;
+                break;
+            case NOTHING:
+                my_nodes[index].type = NOTHING;
+                my_nodes[index].size = 0;
+                my_nodes[index].offset = 0;
+                break;
+            case ARRAY:
+                {
+                    const auto& array = value.get_array();
+                    size_t start = my_nodes.size();
+                    my_nodes.resize(start + array.size()); // no reallocation as we reserved everything in advance.
+                    my_nodes[index].type = ARRAY;
+                    my_nodes[index].size = array.size();
+                    my_nodes[index].offset = start;
+                    for (size_t i = 0, end = array.size(); i < end; ++i) {
+                        fill(start + i, *(array[i]));
+                    }
+                }
+                break;
+            case OBJECT:
+                {
+                    const auto& object = value.get_object();
+                    std::vector<std::pair<const std::string*, const Base*> > sorted;
+                    sorted.reserve(object.size());
+                    for (const auto& x : object) {
+                        sorted.emplace_back(&(x.first), x.second.get());
+                    }
+                    std::sort(sorted.begin(), sorted.end(), [](const auto& left, const auto& right) -> bool { return *(left.first) < *(right.first); });
+
+                    size_t start = my_nodes.size();
+                    my_nodes.resize(start + 2 * sorted.size());
+                    my_nodes[index].type = OBJECT;
+                    my_nodes[index].size = sorted.size();
+                    my_nodes[index].offset = start;
+                    for (size_t i = 0, end = sorted.size(); i < end; ++i) {
+                        fill_string(start + 2 * i, *(sorted[i].first));
+                        fill(start + 2 * i + 1, *(sorted[i].second));
+                    }
+                }
+                break;
+        }
+    }
+};
+
+/**
+ * @param value A JSON value, typically the root of a document returned by `parse()`.
+ * @return A compact read-only copy of `value` and all of its children.
+ * This is read through `FrozenValue` rather than `Base`, see `Frozen` for details.
+ */
+inline Frozen freeze(const Base& value) {
+    return Frozen(value);
+}
+
+}
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef MILLIJSON_GENERATE_HPP
+#define MILLIJSON_GENERATE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @file generate.hpp
+ * @brief Deterministic generation of synthetic JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * Kinds of numbers to generate.
+ */
+enum NumberKind {
+    INTEGERS,
+    DECIMALS,
+    SCIENTIFIC,
+    MIXED
+};
+
+/**
+ * @brief Options for `generate()`.
+ */
+struct GenerateOptions {
+    /**
+     * Seed for the random number generator.
+     * The same seed and options will always produce the same output, on all platforms.
+     */
+    uint64_t seed = 0;
+
+    /**
+     * Maximum depth of nested arrays and objects.
+     * If zero, only scalars are generated.
+     */
+    size_t depth = 3;
+
+    /**
+     * Maximum number of children in each array or object.
+     * The actual number is sampled uniformly between zero and this value.
+     */
+    size_t fanout = 5;
+
+    /**
+     * Maximum length of each string (before escaping) and object key.
+     * The actual length is sampled uniformly between zero and this value, or one for keys.
+     */
+    size_t string_length = 10;
+
+    /**
+     * Probability that each character in a string is replaced by an escape sequence.
+     */
+    double escape_density = 0;
+
+    /**
+     * Kinds of numbers to generate.
+     */
+    NumberKind numbers = MIXED;
+
+    /**
+     * Whether to pretty-print the output with newlines and indentation.
+     * Ignored if `ndjson = true`.
+     */
+    bool pretty = false;
+
+    /**
+     * Whether to generate newline-delimited JSON, i.e., one value per line.
+     */
+    bool ndjson = false;
+
+    /**
+     * Approximate target size of the output, in bytes.
+     * If zero, a single value is generated.
+     * Otherwise, values are generated until the target size is reached, either as records (if `ndjson = true`) or as elements of a top-level array.
+     */
+    size_t size = 0;
+};
+
+/**
+ * @cond
+ */
+template<class Writer_>
+class Generator {
+public:
+    Generator(const GenerateOptions& options, Writer_& writer) : my_options(options), my_writer(writer), my_state(options.seed) {
+        my_buffer.reserve(buffer_size);
+    }
+
+    size_t run() {
+        const auto& opt = my_options;
+        if (opt.ndjson) {
+            do {
+                value(opt.depth, 0, false);
+                put('\n');
+            } while (my_written + my_buffer.size() < opt.size);
+
+        } else if (opt.size) {
+            put('[');
+            bool first = true;
+            while (my_written + my_buffer.size() < opt.size) {
+                if (!first) {
+                    put(',');
+                }
+                first = false;
+                newline(1, opt.pretty);
+                value(opt.depth, 1, opt.pretty);
+            }
+            newline(0, opt.pretty);
+            put(']');
+            put('\n');
+
+        } else {
+            value(opt.depth, 0, opt.pretty);
+            put('\n');
+        }
+
+        flush();
+        return my_written;
+    }
+
+private:
+    static constexpr size_t buffer_size = 65536;
+
+    const GenerateOptions& my_options;
+    Writer_& my_writer;
+    uint64_t my_state;
+    std::string my_buffer;
+    size_t my_written = 0;
+
+    // splitmix64, for portable determinism; the <random> distributions are implementation-defined.
+    uint64_t next() {
+        uint64_t z = (my_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t uniform(uint64_t n) { // in [0, n).
+        return next() % n;
+    }
+
+    double unit() { // in [0, 1).
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    void flush() {
+        if (!my_buffer.empty()) {
+            my_writer(my_buffer.data(), my_buffer.size());
+            my_written += my_buffer.size();
+            my_buffer.clear();
+        }
+    }
+
+    void put(char x) {
+        my_buffer += x;
+        if (my_buffer.size() >= buffer_size) {
+            flush();
+        }
+    }
+
+    void put(const char* x, size_t n) {
+        my_buffer.append(x, n);
+        if (my_buffer.size() >= buffer_size) {
+            flush();
+        }
+    }
+
+    void newline(size_t level, bool pretty) {
+        if (pretty) {
+            put('\n');
+            for (size_t i = 0; i < level; ++i) {
+                put("  ", 2);
+            }
+        }
+    }
+
+    void string(size_t length, const std::string& suffix) {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.";
+        static const char escapes[] = "\"\\/bfnrt";
+
+        put('"');
+        for (size_t i = 0; i < length; ++i) {
+            if (my_options.escape_density > 0 && unit() < my_options.escape_density) {
+                put('\\');
+                auto choice = uniform(sizeof(escapes)); // the last choice is a Unicode escape.
+                if (choice + 1 < sizeof(escapes)) {
+                    put(escapes[choice]);
+                } else {
+                    char buf[8];
+                    int n = std::snprintf(buf, sizeof(buf), "u%04x", static_cast<unsigned>(0x20 + uniform(0xd7ff - 0x20)));
+                    put(buf, n);
+                }
+            } else {
+                put(alphabet[uniform(sizeof(alphabet) - 1)]);
+            }
+        }
+        put(suffix.data(), suffix.size());
+        put('"');
+    }
+
+    void number() {
+        auto kind = my_options.numbers;
+        if (kind == MIXED) {
+            kind = static_cast<NumberKind>(uniform(3));
+        }
+
+        char buf[64];
+        int n;
+        long long mantissa = static_cast<long long>(uniform(2000001)) - 1000000;
+        if (kind == INTEGERS) {
+            n = std::snprintf(buf, sizeof(buf), "%lld", mantissa);
+        } else if (kind == DECIMALS) {
+            n = std::snprintf(buf, sizeof(buf), "%lld.%0*llu", mantissa, static_cast<int>(1 + uniform(6)), static_cast<unsigned long long>(uniform(1000000)));
+        } else {
+            n = std::snprintf(buf, sizeof(buf), "%lld.%03llue%c%llu", mantissa / 1000, static_cast<unsigned long long>(uniform(1000)), (uniform(2) ? '+' : '-'), static_cast<unsigned long long>(uniform(300)));
+        }
+        put(buf, n);
+    }
+
+    void value(size_t depth, size_t level, bool pretty) {
+        // Containers are favored when nesting is allowed, to give a controllable shape.
+        auto choice = uniform(depth ? 8 : 4);
+        switch (choice) {
+            case 0:
+                number();
+                break;
+            case 1:
+                string(uniform(my_options.string_length + 1), "");
+                break;
+            case 2:
+                if (uniform(2)) {
+                    put("true", 4);
+                } else {
+                    put("false", 5);
+                }
+                break;
+            case 3:
+                put("null", 4);
+                break;
+            case 4: case 5:
+                {
+                    put('[');
+                    auto n = uniform(my_options.fanout + 1);
+                    for (size_t i = 0; i < n; ++i) {
+                        if (i) {
+                            put(',');
+                        }
+                        newline(level + 1, pretty);
+                        value(depth - 1, level + 1, pretty);
+                    }
+                    if (n) {
+                        newline(level, pretty);
+                    }
+                    put(']');
+                }
+                break;
+            default:
+                {
+                    put('{');
+                    auto n = uniform(my_options.fanout + 1);
+                    for (size_t i = 0; i < n; ++i) {
+                        if (i) {
+                            put(',');
+                        }
+                        newline(level + 1, pretty);
+
+                        // Suffixing the key with its index to guarantee uniqueness within the object.
+                        string(1 + uniform(my_options.string_length ? my_options.string_length : 1), "_" + std::to_string(i));
+                        put(':');
+                        if (pretty) {
+                            put(' ');
+                        }
+                        value(depth - 1, level + 1, pretty);
+                    }
+                    if (n) {
+                        newline(level, pretty);
+                    }
+                    put('}');
+                }
+                break;
+        }
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Generate a synthetic JSON document, streaming it to a writer in chunks so that the full document is never held in memory.
+ *
+ * @tparam Writer_ Any callable that accepts a `const char*` and a `size_t`, specifying a pointer to a chunk of bytes and its length, respectively.
+ *
+ * @param options Options for generation.
+ * @param writer Instance of a `Writer_`.
+ * @return Number of bytes that were generated.
+ */
+template<class Writer_>
+size_t generate(const GenerateOptions& options, Writer_ writer) {
+    Generator<Writer_> gen(options, writer);
+    return gen.run();
+}
+
+/**
+ * @param options Options for generation.
+ * @return String containing the generated JSON document.
+ */
+inline std::string generate_string(const GenerateOptions& options) {
+    std::string output;
+    generate(options, [&](const char* ptr, size_t len) -> void { output.append(ptr, len); });
+    return output;
+}
+
+/**
+ * @param options Options for generation.
+ * @param[in] path Path to the output file.
+ * @return Number of bytes that were written.
+ */
+inline size_t generate_file(const GenerateOptions& options, const char* path) {
+    FILE* handle = std::fopen(path, "wb");
+    if (!handle) {
+        throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+    }
+
+    size_t output;
+    try {
+        output = generate(options, [&](const char* ptr, size_t len) -> void {
+            if (std::fwrite(ptr, sizeof(char), len, handle) != len) {
+                throw std::runtime_error("failed to write to file at '" + std::string(path) + "'");
+            }
+        });
+    } catch (...) {
+        std::fclose(handle);
+        throw;
+    }
+
+    if (std::fclose(handle)) {
+        throw std::runtime_error("failed to close file at '" + std::string(path) + "'");
+    }
+    return output;
+}
+
+}
+
+#endif
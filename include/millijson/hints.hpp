@@ -0,0 +1,173 @@
+#ifndef MILLIJSON_HINTS_HPP
+#define MILLIJSON_HINTS_HPP
+
+#include "millijson.hpp"
+
+#include <vector>
+#include <memory>
+#include <cmath>
+
+/**
+ * @file hints.hpp
+ * @brief Capacity hints for arrays and objects.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Predicted sizes of arrays and objects.
+ *
+ * This learns the typical size of arrays and objects at each nesting depth from previously parsed documents.
+ * On subsequent parses, the storage for each array or object is reserved in advance according to the prediction for its depth.
+ * This avoids repeated reallocations for families of documents with similar structure.
+ *
+ * The predictions are stored in public members, so they can be exported and imported by the user for warm starts.
+ */
+struct CapacityHints {
+    /**
+     * Predicted size of arrays at each depth, where the root has a depth of zero.
+     */
+    std::vector<double> arrays;
+
+    /**
+     * Predicted size of objects at each depth, where the root has a depth of zero.
+     */
+    std::vector<double> objects;
+
+    /**
+     * Weight of the latest document when updating the predictions.
+     * Larger values adapt more quickly to changes in the document structure.
+     */
+    double weight = 0.5;
+
+    /**
+     * Maximum number of elements to reserve for any array or object.
+     * This protects against excessive allocations from imported or unusually large predictions.
+     */
+    size_t max_reserve = 65536;
+
+    /**
+     * @cond
+     */
+    size_t predict(const std::vector<double>& sizes, size_t depth) const {
+        if (depth < sizes.size()) {
+            double predicted = sizes[depth];
+            // Also catches NaNs from imported predictions.
+            if (!(predicted > 0)) {
+                return 0;
+            }
+            if (predicted >= static_cast<double>(max_reserve)) {
+                return max_reserve;
+            }
+            return std::ceil(predicted);
+        }
+        return 0;
+    }
+
+    template<class Container_>
+    void update(std::vector<double>& sizes, const std::vector<std::pair<const Container_*, size_t> >& observed) const {
+        std::vector<double> totals;
+        std::vector<size_t> counts;
+        for (const auto& obs : observed) {
+            if (obs.second >= totals.size()) {
+                totals.resize(obs.second + 1);
+                counts.resize(obs.second + 1);
+            }
+            totals[obs.second] += obs.first->values.size();
+            ++counts[obs.second];
+        }
+
+        if (sizes.size() < totals.size()) {
+            sizes.resize(totals.size(), -1);
+        }
+        double w = (weight >= 0 && weight <= 1 ? weight : 0.5); // ignoring invalid imported weights.
+        for (size_t d = 0, end = totals.size(); d < end; ++d) {
+            bool unset = !(sizes[d] >= 0 && std::isfinite(sizes[d])); // also replacing invalid imported predictions.
+            if (counts[d]) {
+                double mean = totals[d] / counts[d];
+                if (unset) {
+                    sizes[d] = mean;
+                } else {
+                    sizes[d] = w * mean + (1 - w) * sizes[d];
+                }
+            } else if (unset) {
+                sizes[d] = 0;
+            }
+        }
+    }
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @cond
+ */
+struct HintedProvisioner : public DefaultProvisioner {
+    HintedProvisioner(const CapacityHints& h) : hints(h) {}
+
+    const CapacityHints& hints;
+    std::vector<std::pair<const Array*, size_t> > arrays;
+    std::vector<std::pair<const Object*, size_t> > objects;
+
+    Array* new_array(size_t depth) {
+        auto ptr = new Array;
+        ptr->values.reserve(hints.predict(hints.arrays, depth));
+        arrays.emplace_back(ptr, depth);
+        return ptr;
+    }
+
+    Object* new_object(size_t depth) {
+        auto ptr = new Object;
+        ptr->values.reserve(hints.predict(hints.objects, depth));
+        objects.emplace_back(ptr, depth);
+        return ptr;
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @tparam Input Any class that supplies input characters, see `parse()` for details. 
+ *
+ * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+ * @param hints Capacity hints, to be used to reserve storage for each array and object.
+ * On return, this is updated with the sizes observed in the current document.
+ *
+ * @return A pointer to a JSON value.
+ */
+template<class Input>
+std::shared_ptr<Base> parse(Input& input, CapacityHints& hints) {
+    HintedProvisioner provisioner(hints);
+    auto output = parse_thing_with_chomp(input, provisioner);
+    hints.update(hints.arrays, provisioner.arrays);
+    hints.update(hints.objects, provisioner.objects);
+    return output;
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param hints Capacity hints, see `parse()` for details.
+ * @return A pointer to a JSON value.
+ */
+inline std::shared_ptr<Base> parse_string(const char* ptr, size_t len, CapacityHints& hints) {
+    RawReader input(ptr, len);
+    return parse(input, hints);
+}
+
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param hints Capacity hints, see `parse()` for details.
+ * @param buffer_size Size of the buffer to use for reading the file.
+ * @return A pointer to a JSON value.
+ */
+inline std::shared_ptr<Base> parse_file(const char* path, CapacityHints& hints, size_t buffer_size = 65536) {
+    FileReader input(path, buffer_size);
+    return parse(input, hints);
+}
+
+}
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef MILLIJSON_INCREMENTAL_HPP
+#define MILLIJSON_INCREMENTAL_HPP
+
+#include "millijson.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file incremental.hpp
+ * @brief Incremental reparsing of JSON documents after localized edits.
+ */
+
+namespace millijson {
+
+/**
+ * @brief JSON value with the byte spans of its children.
+ *
+ * Instances are immutable after parsing so that untouched subtrees can be shared between successive versions of a document.
+ */
+struct SpannedValue {
+    /**
+     * The parsed JSON value.
+     */
+    std::shared_ptr<Base> value;
+
+    /**
+     * Length of the value in the source, in bytes.
+     */
+    size_t length = 0;
+
+    /**
+     * For arrays and objects, the start of each child value in the source, relative to the start of this value.
+     * Children are ordered as they appear in the source.
+     */
+    std::vector<size_t> offsets;
+
+    /**
+     * For objects, the key of each child value.
+     */
+    std::vector<std::string> keys;
+
+    /**
+     * For arrays and objects, spans for each child value.
+     * This is set to NULL for children that are not arrays or objects.
+     */
+    std::vector<std::shared_ptr<const SpannedValue> > children;
+};
+
+/**
+ * @brief JSON document with retained byte spans.
+ */
+struct SpannedDocument {
+    /**
+     * Root of the document.
+     */
+    std::shared_ptr<const SpannedValue> root;
+
+    /**
+     * Position of the root value in the source, i.e., after any leading whitespace.
+     */
+    size_t offset = 0;
+};
+
+/**
+ * @brief Replacement of a byte range in a JSON string.
+ */
+struct Edit {
+    /**
+     * Start of the replaced range in the old string.
+     */
+    size_t start;
+
+    /**
+     * Length of the replaced range in the old string.
+     * This may be zero for insertions.
+     */
+    size_t old_length;
+
+    /**
+     * Length of the replacement in the new string.
+     * This may be zero for deletions.
+     */
+    size_t new_length;
+};
+
+/**
+ * @cond
+ */
+struct SpannedProvisioner : public DefaultProvisioner {
+    struct Frame {
+        size_t start;
+        bool object;
+        std::shared_ptr<SpannedValue> span; // NULL for scalars.
+    };
+    std::vector<Frame> stack;
+    std::string pending_key;
+    std::shared_ptr<const SpannedValue> last; // span of the last completed value, NULL if it was a scalar.
+
+    // Called by parse_thing() at the start of each value, before its first character is consumed.
+    template<class Input_>
+    void enter(const Input_& input) {
+        size_t start = input.position();
+        if (!stack.empty()) {
+            auto& parent = stack.back();
+            parent.span->offsets.push_back(start - parent.start);
+            if (parent.object) {
+                parent.span->keys.push_back(std::move(pending_key));
+            }
+        }
+
+        char current = input.get();
+        std::shared_ptr<SpannedValue> span;
+        if (current == '[' || current == '{') {
+            span = std::make_shared<SpannedValue>();
+        }
+        stack.push_back(Frame{ start, current == '{', std::move(span) });
+    }
+
+    void key(const std::string& k) {
+        pending_key = k;
+    }
+
+    // Called by parse_thing() after each value is complete.
+    template<class Input_>
+    void leave(const Input_& input, const std::shared_ptr<Base>& value) {
+        auto span = std::move(stack.back().span);
+        if (span) {
+            span->value = value;
+            span->length = input.position() - stack.back().start;
+        }
+        stack.pop_back();
+
+        if (!stack.empty()) {
+            stack.back().span->children.push_back(span);
+        }
+        last = std::move(span);
+    }
+};
+
+inline std::shared_ptr<Base> parse_spanned_thing(RawReader& input, std::shared_ptr<const SpannedValue>& span) {
+    SpannedProvisioner provisioner;
+    auto output = parse_thing(input, provisioner, 0);
+    span = std::move(provisioner.last);
+    return output;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Parse a JSON string and retain the byte spans of all arrays and objects, for use in `reparse()`.
+ *
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @return The parsed document.
+ */
+inline SpannedDocument parse_spanned(const char* ptr, size_t len) {
+    RawReader input(ptr, len);
+    chomp(input);
+
+    SpannedDocument output;
+    output.offset = input.position();
+    if (!input.valid()) {
+        throw std::runtime_error("no JSON value found at position " + std::to_string(output.offset + 1));
+    }
+
+    std::shared_ptr<const SpannedValue> span;
+    auto value = parse_spanned_thing(input, span);
+    if (!span) {
+        auto scalar = std::make_shared<SpannedValue>();
+        scalar->value = std::move(value);
+        scalar->length = input.position() - output.offset;
+        span = std::move(scalar);
+    }
+    output.root = std::move(span);
+
+    chomp(input);
+    if (input.valid()) {
+        throw std::runtime_error("invalid json with trailing non-space characters at position " + std::to_string(input.position() + 1));
+    }
+    return output;
+}
+
+/**
+ * Reparse a JSON string after it has been modified by one or more edits.
+ * Only the smallest array or object that encloses all edits is reparsed, while all other subtrees are shared with `previous`.
+ * If this container cannot be parsed in isolation (e.g., because an edit modified the nesting structure), its parent is tried instead, and so on.
+ * If no container encloses all edits, the entire string is parsed from scratch.
+ *
+ * Each enclosing container on the path from the root is shallow-copied to produce the new document, including its child pointers, offsets and keys.
+ * The cost of an edit is therefore proportional to the total width of these containers in addition to the size of the reparsed container,
+ * e.g., an edit to one element of a top-level array of length `n` is still O(n), albeit with a small constant as no values are parsed or copied.
+ *
+ * @param previous Document returned by `parse_spanned()` or `reparse()` on the old string.
+ * @param[in] ptr Pointer to an array containing the new JSON string.
+ * @param len Length of the array.
+ * @param edits Edits that convert the old string into the new string.
+ * Each edit should be specified in terms of positions on the old string, and edits should not overlap.
+ *
+ * @return The parsed document for the new string.
+ * The parsed values are identical to those from `parse_spanned()` on the new string, and any parsing errors are also the same.
+ */
+inline SpannedDocument reparse(const SpannedDocument& previous, const char* ptr, size_t len, const std::vector<Edit>& edits) {
+    if (edits.empty()) {
+        return previous;
+    }
+
+    size_t lo = edits.front().start, hi = lo, added = 0, removed = 0;
+    for (const auto& e : edits) {
+        lo = std::min(lo, e.start);
+        hi = std::max(hi, e.start + e.old_length);
+        added += e.new_length;
+        removed += e.old_length;
+    }
+
+    // Identifying the smallest container that strictly encloses the edits, i.e., without touching its brackets.
+    std::vector<const SpannedValue*> path;
+    std::vector<size_t> starts, indices;
+    {
+        const SpannedValue* current = previous.root.get();
+        size_t cstart = previous.offset;
+        auto type = current->value->type();
+        if ((type != ARRAY && type != OBJECT) || !(cstart < lo && hi < cstart + current->length)) {
+            return parse_spanned(ptr, len);
+        }
+
+        while (1) {
+            path.push_back(current);
+            starts.push_back(cstart);
+
+            const auto& offsets = current->offsets;
+            size_t idx = std::lower_bound(offsets.begin(), offsets.end(), lo - cstart) - offsets.begin();
+            if (idx == 0) {
+                break;
+            }
+            --idx;
+
+            const auto& child = current->children[idx];
+            if (!child) {
+                break;
+            }
+            size_t child_start = cstart + offsets[idx];
+            if (!(hi < child_start + child->length)) {
+                break;
+            }
+
+            indices.push_back(idx);
+            current = child.get();
+            cstart = child_start;
+        }
+    }
+
+    for (size_t level = path.size(); level > 0; --level) {
+        size_t start = starts[level - 1];
+        size_t newlen = path[level - 1]->length + added - removed;
+        if (start + newlen > len) {
+            break;
+        }
+
+        std::shared_ptr<const SpannedValue> replacement;
+        try {
+            RawReader input(ptr + start, newlen);
+            parse_spanned_thing(input, replacement);
+            if (input.valid()) {
+                continue;
+            }
+        } catch (std::exception&) {
+            continue;
+        }
+
+        // Copying the spine back to the root, sharing all untouched siblings.
+        for (size_t l = level - 1; l > 0; --l) {
+            const auto& parent = *(path[l - 1]);
+            size_t idx = indices[l - 1];
+
+            auto copy = std::make_shared<SpannedValue>(parent);
+            copy->length += added;
+            copy->length -= removed;
+            for (size_t j = idx + 1, end = copy->offsets.size(); j < end; ++j) {
+                copy->offsets[j] += added;
+                copy->offsets[j] -= removed;
+            }
+
+            if (parent.value->type() == ARRAY) {
+                auto array = std::make_shared<Array>(static_cast<const Array&>(*(parent.value)));
+                array->values[idx] = replacement->value;
+                copy->value = std::move(array);
+            } else {
+                auto object = std::make_shared<Object>(static_cast<const Object&>(*(parent.value)));
+                object->values[copy->keys[idx]] = replacement->value;
+                copy->value = std::move(object);
+            }
+
+            copy->children[idx] = std::move(replacement);
+            replacement = std::move(copy);
+        }
+
+        SpannedDocument output;
+        output.root = std::move(replacement);
+        output.offset = previous.offset;
+        return output;
+    }
+
+    return parse_spanned(ptr, len);
+}
+
+}
+
+#endif
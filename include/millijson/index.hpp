@@ -0,0 +1,342 @@
+#ifndef MILLIJSON_INDEX_HPP
+#define MILLIJSON_INDEX_HPP
+
+#include "millijson.hpp"
+#include "patch.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @file index.hpp
+ * @brief Hash indices over arrays of objects.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Key for lookups in an `ArrayIndex`.
+ *
+ * Each component of a composite key is added in the same order as the key paths of the index.
+ * Components are encoded with their type, so the string `"1"` does not match the number 1.
+ */
+class IndexKey {
+public:
+    /**
+     * @param value String to add as the next component of the key.
+     * @return Reference to this object.
+     */
+    IndexKey& add_string(const std::string& value) {
+        my_encoded += 's';
+        size_t len = value.size();
+        my_encoded.append(reinterpret_cast<const char*>(&len), sizeof(len)); // length prefix, so that the concatenation of components is unambiguous.
+        my_encoded += value;
+        return *this;
+    }
+
+    /**
+     * @param value Number to add as the next component of the key.
+     * @return Reference to this object.
+     */
+    IndexKey& add_number(double value) {
+        if (value == 0) {
+            value = 0; // treating -0 and 0 as the same key.
+        }
+        my_encoded += 'n';
+        my_encoded.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        return *this;
+    }
+
+    /**
+     * @param value Boolean to add as the next component of the key.
+     * @return Reference to this object.
+     */
+    IndexKey& add_boolean(bool value) {
+        my_encoded += (value ? 't' : 'f');
+        return *this;
+    }
+
+    /**
+     * Add a null as the next component of the key.
+     * @return Reference to this object.
+     */
+    IndexKey& add_null() {
+        my_encoded += 'z';
+        return *this;
+    }
+
+    /**
+     * @param value Scalar JSON value to add as the next component of the key.
+     * An error is raised if this is an array or object.
+     * @return Reference to this object.
+     */
+    IndexKey& add(const Base& value) {
+        switch (value.type()) {
+            case STRING:
+                return add_string(value.get_string());
+            case NUMBER:
+                return add_number(value.get_number());
+            case BOOLEAN:
+                return add_boolean(value.get_boolean());
+            case NOTHING:
+                return add_null();
+            default:
+                throw std::runtime_error("index keys should only contain scalar values");
+        }
+    }
+
+    /**
+     * @return Encoded key.
+     */
+    const std::string& encoded() const {
+        return my_encoded;
+    }
+
+    /**
+     * Remove all components from the key, e.g., for re-use across lookups.
+     */
+    void clear() {
+        my_encoded.clear();
+    }
+
+private:
+    std::string my_encoded;
+};
+
+/**
+ * @brief Hash index over an array of objects.
+ *
+ * This maps the values at one or more key paths in each element of an array to the positions of those elements.
+ * Lookups by key then take constant time, instead of a linear scan over the array with a per-element `find()`.
+ * Multiple elements can share the same key, in which case all of their positions are reported by `find_all()`.
+ *
+ * Elements are not indexed if they are missing any of the key paths, or if the value at any key path is an array or object.
+ * The index refers to the array by reference, so the array should not be modified or destroyed while the index is in use.
+ * If the array is modified, a new index should be constructed.
+ */
+class ArrayIndex {
+public:
+    /**
+     * Position reported when no element matches the requested key.
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * @param array JSON array to be indexed.
+     * An error is raised if this is not an array.
+     * @param key_paths JSON pointers to the key values, relative to each element, e.g., `"/id"` or `"/meta/id"`.
+     * Multiple key paths define a composite key.
+     * Only object keys are traversed by the pointers.
+     */
+    ArrayIndex(const Base& array, const std::vector<std::string>& key_paths) {
+        if (array.type() != ARRAY) {
+            throw std::runtime_error("an index can only be constructed for an array");
+        }
+        if (key_paths.empty()) {
+            throw std::runtime_error("an index should have at least one key path");
+        }
+        my_elements = &(array.get_array());
+
+        std::vector<std::vector<std::string> > tokens;
+        tokens.reserve(key_paths.size());
+        for (const auto& path : key_paths) {
+            tokens.push_back(split_pointer(path));
+        }
+
+        // Iterating backwards so that the first element with each key ends up at the head of its chain.
+        size_t n = my_elements->size();
+        my_next.resize(n, npos);
+        my_map.reserve(n);
+        IndexKey key;
+        for (size_t i = n; i > 0; --i) {
+            size_t pos = i - 1;
+            key.clear();
+            if (!build_key((*my_elements)[pos].get(), tokens, key)) {
+                continue;
+            }
+
+            auto res = my_map.try_emplace(key.encoded(), pos);
+            if (!res.second) {
+                my_next[pos] = res.first->second;
+                res.first->second = pos;
+            }
+            ++my_indexed;
+        }
+    }
+
+    /**
+     * @param array JSON array to be indexed.
+     * @param key_path JSON pointer to the key value, relative to each element.
+     */
+    ArrayIndex(const Base& array, const std::string& key_path) : ArrayIndex(array, std::vector<std::string>{ key_path }) {}
+
+public:
+    /**
+     * @param key Key to look up, with one component for each key path.
+     * @return Position of the first element with this key, or `npos` if no element has this key.
+     */
+    size_t find(const IndexKey& key) const {
+        auto it = my_map.find(key.encoded());
+        if (it == my_map.end()) {
+            return npos;
+        }
+        return it->second;
+    }
+
+    /**
+     * @param key String key to look up, for indices with a single key path.
+     * @return Position of the first element with this key, or `npos` if no element has this key.
+     */
+    size_t find(const std::string& key) const {
+        IndexKey tmp;
+        tmp.add_string(key);
+        return find(tmp);
+    }
+
+    /**
+     * @param key Numeric key to look up, for indices with a single key path.
+     * @return Position of the first element with this key, or `npos` if no element has this key.
+     */
+    size_t find(double key) const {
+        IndexKey tmp;
+        tmp.add_number(key);
+        return find(tmp);
+    }
+
+    /**
+     * @param key Key to look up, with one component for each key path.
+     * @return Positions of all elements with this key, in increasing order.
+     */
+    std::vector<size_t> find_all(const IndexKey& key) const {
+        std::vector<size_t> output;
+        for (size_t pos = find(key); pos != npos; pos = my_next[pos]) {
+            output.push_back(pos);
+        }
+        return output;
+    }
+
+    /**
+     * @param key Key to look up, with one component for each key path.
+     * @return Pointer to the first element with this key, or NULL if no element has this key.
+     */
+    std::shared_ptr<Base> get(const IndexKey& key) const {
+        size_t pos = find(key);
+        if (pos == npos) {
+            return std::shared_ptr<Base>();
+        }
+        return (*my_elements)[pos];
+    }
+
+public:
+    /**
+     * @return Number of elements in the index.
+     * This may be less than the length of the array if some elements are missing the key paths.
+     */
+    size_t size() const {
+        return my_indexed;
+    }
+
+    /**
+     * @return Number of unique keys in the index.
+     */
+    size_t unique() const {
+        return my_map.size();
+    }
+
+private:
+    const std::vector<std::shared_ptr<Base> >* my_elements;
+    std::unordered_map<std::string, size_t, KeyHash> my_map;
+    std::vector<size_t> my_next; // position of the next element with the same key.
+    size_t my_indexed = 0;
+
+    static bool build_key(const Base* element, const std::vector<std::vector<std::string> >& tokens, IndexKey& key) {
+        for (const auto& path : tokens) {
+            const Base* current = element;
+            for (const auto& t : path) {
+                if (current->type() != OBJECT) {
+                    return false;
+                }
+                const auto& object = current->get_object();
+                auto it = object.find(t);
+                if (it == object.end()) {
+                    return false;
+                }
+                current = it->second.get();
+            }
+
+            auto type = current->type();
+            if (type == ARRAY || type == OBJECT) {
+                return false;
+            }
+            key.add(*current);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief A JSON document with an index over one of its arrays.
+ */
+struct IndexedDocument {
+    /**
+     * Root of the document.
+     */
+    std::shared_ptr<Base> root;
+
+    /**
+     * Index over the array in `root`.
+     */
+    ArrayIndex index;
+};
+
+/**
+ * Parse a JSON document and index one of its arrays, typically a catalog of records.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ *
+ * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+ * @param array_path JSON pointer to the array to be indexed.
+ * An empty string refers to the root.
+ * @param key_paths JSON pointers to the key values, relative to each element, see `ArrayIndex` for details.
+ *
+ * @return The parsed document and its index.
+ */
+template<class Input>
+IndexedDocument parse_indexed(Input& input, const std::string& array_path, const std::vector<std::string>& key_paths) {
+    auto root = parse(input);
+    auto array = patch_get(root, split_pointer(array_path));
+    ArrayIndex index(*array, key_paths);
+    return IndexedDocument{ std::move(root), std::move(index) };
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param array_path JSON pointer to the array to be indexed.
+ * @param key_paths JSON pointers to the key values, relative to each element.
+ * @return The parsed document and its index, see `parse_indexed()` for details.
+ */
+inline IndexedDocument parse_string_indexed(const char* ptr, size_t len, const std::string& array_path, const std::vector<std::string>& key_paths) {
+    RawReader input(ptr, len);
+    return parse_indexed(input, array_path, key_paths);
+}
+
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param array_path JSON pointer to the array to be indexed.
+ * @param key_paths JSON pointers to the key values, relative to each element.
+ * @param buffer_size Size of the buffer to use for reading the file.
+ * @return The parsed document and its index, see `parse_indexed()` for details.
+ */
+inline IndexedDocument parse_file_indexed(const char* path, const std::string& array_path, const std::vector<std::string>& key_paths, size_t buffer_size = 65536) {
+    FileReader input(path, buffer_size);
+    return parse_indexed(input, array_path, key_paths);
+}
+
+}
+
+#endif
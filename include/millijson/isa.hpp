@@ -0,0 +1,269 @@
+#ifndef MILLIJSON_ISA_HPP
+#define MILLIJSON_ISA_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#if !defined(MILLIJSON_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MILLIJSON_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/**
+ * @file isa.hpp
+ * @brief Runtime selection of the instruction set for scanning kernels.
+ *
+ * By default, the parser in millijson.hpp uses portable scalar loops to skip whitespace and scan strings, and does not include this header.
+ * To use the SIMD kernels instead, define the `MILLIJSON_USE_ISA` macro before including millijson.hpp.
+ * This should be done consistently in all translation units of a program, e.g., via the compiler flags.
+ */
+
+namespace millijson {
+
+/**
+ * Instruction sets for the scanning kernels.
+ * Each instruction set is a superset of the preceding ones.
+ */
+enum class Isa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @cond
+ */
+/*
+ * Each kernel returns the index of the first byte in [ptr, ptr + len) that satisfies some condition, or len if no such byte exists.
+ * - find_special() looks for bytes that end a run of plain string characters, i.e., quotes, backslashes and control characters.
+ * - skip_whitespace() looks for bytes that are not JSON whitespace.
+ */
+struct ScanKernels {
+    size_t (*find_special)(const char*, size_t);
+    size_t (*skip_whitespace)(const char*, size_t);
+};
+
+inline size_t find_special_scalar(const char* ptr, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char x = ptr[i];
+        if (x < 0x20 || x == '"' || x == '\\') {
+            return i;
+        }
+    }
+    return len;
+}
+
+inline size_t skip_whitespace_scalar(const char* ptr, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        char x = ptr[i];
+        if (x != ' ' && x != '\n' && x != '\r' && x != '\t') {
+            return i;
+        }
+    }
+    return len;
+}
+
+#ifdef MILLIJSON_X86_DISPATCH
+inline size_t find_special_sse2(const char* ptr, size_t len) {
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), control = _mm_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)), _mm_cmpeq_epi8(_mm_max_epu8(x, control), control));
+        unsigned mask = _mm_movemask_epi8(hit);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + find_special_scalar(ptr + i, len - i);
+}
+
+inline size_t skip_whitespace_sse2(const char* ptr, size_t len) {
+    const __m128i space = _mm_set1_epi8(' '), newline = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r'), tab = _mm_set1_epi8('\t');
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, newline)), _mm_or_si128(_mm_cmpeq_epi8(x, cr), _mm_cmpeq_epi8(x, tab)));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xffffu;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + skip_whitespace_scalar(ptr + i, len - i);
+}
+
+__attribute__((target("avx2")))
+inline size_t find_special_avx2(const char* ptr, size_t len) {
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'), control = _mm256_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, backslash)), _mm256_cmpeq_epi8(_mm256_max_epu8(x, control), control));
+        unsigned mask = _mm256_movemask_epi8(hit);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + find_special_sse2(ptr + i, len - i);
+}
+
+__attribute__((target("avx2")))
+inline size_t skip_whitespace_avx2(const char* ptr, size_t len) {
+    const __m256i space = _mm256_set1_epi8(' '), newline = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r'), tab = _mm256_set1_epi8('\t');
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(x, newline)), _mm256_or_si256(_mm256_cmpeq_epi8(x, cr), _mm256_cmpeq_epi8(x, tab)));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + skip_whitespace_sse2(ptr + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline size_t find_special_avx512(const char* ptr, size_t len) {
+    const __m512i quote = _mm512_set1_epi8('"'), backslash = _mm512_set1_epi8('\\'), control = _mm512_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i x = _mm512_loadu_si512(reinterpret_cast<const void*>(ptr + i));
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(x, quote) | _mm512_cmpeq_epi8_mask(x, backslash) | _mm512_cmplt_epu8_mask(x, control);
+        if (mask) {
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    return i + find_special_avx2(ptr + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline size_t skip_whitespace_avx512(const char* ptr, size_t len) {
+    const __m512i space = _mm512_set1_epi8(' '), newline = _mm512_set1_epi8('\n'), cr = _mm512_set1_epi8('\r'), tab = _mm512_set1_epi8('\t');
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i x = _mm512_loadu_si512(reinterpret_cast<const void*>(ptr + i));
+        __mmask64 ws = _mm512_cmpeq_epi8_mask(x, space) | _mm512_cmpeq_epi8_mask(x, newline) | _mm512_cmpeq_epi8_mask(x, cr) | _mm512_cmpeq_epi8_mask(x, tab);
+        if (~ws) {
+            return i + __builtin_ctzll(~ws);
+        }
+    }
+    return i + skip_whitespace_avx2(ptr + i, len - i);
+}
+#endif
+
+inline ScanKernels select_kernels(Isa isa) {
+#ifdef MILLIJSON_X86_DISPATCH
+    switch (isa) {
+        case Isa::AVX512:
+            return ScanKernels{ find_special_avx512, skip_whitespace_avx512 };
+        case Isa::AVX2:
+            return ScanKernels{ find_special_avx2, skip_whitespace_avx2 };
+        case Isa::SSE2:
+            return ScanKernels{ find_special_sse2, skip_whitespace_sse2 };
+        default:
+            break;
+    }
+#else
+    (void)isa;
+#endif
+    return ScanKernels{ find_special_scalar, skip_whitespace_scalar };
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @return The most capable instruction set that is supported by both the current CPU and the build.
+ * This is always `Isa::SCALAR` on non-x86-64 platforms, on compilers other than GCC or Clang, or if the `MILLIJSON_NO_SIMD` macro is defined.
+ */
+inline Isa supported_isa() {
+#ifdef MILLIJSON_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    return Isa::SSE2; // baseline for x86-64.
+#else
+    return Isa::SCALAR;
+#endif
+}
+
+/**
+ * @cond
+ */
+struct IsaState {
+    IsaState() {
+        active = supported_isa();
+
+        // Allowing an override from the environment, e.g., to run the test suite with each variant.
+        const char* env = std::getenv("MILLIJSON_ISA");
+        if (env) {
+            std::string requested(env);
+            Isa choice = active;
+            if (requested == "scalar") {
+                choice = Isa::SCALAR;
+            } else if (requested == "sse2") {
+                choice = Isa::SSE2;
+            } else if (requested == "avx2") {
+                choice = Isa::AVX2;
+            } else if (requested == "avx512") {
+                choice = Isa::AVX512;
+            }
+            if (choice < active) {
+                active = choice;
+            }
+        }
+
+        kernels = select_kernels(active);
+    }
+
+    Isa active;
+    ScanKernels kernels;
+};
+
+inline IsaState& isa_state() {
+    static IsaState state;
+    return state;
+}
+
+inline const ScanKernels& scan_kernels() {
+    return isa_state().kernels;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @return The instruction set that is currently used by the scanning kernels.
+ * By default, this is the same as `supported_isa()`.
+ * It can be lowered by setting the `MILLIJSON_ISA` environment variable to one of `scalar`, `sse2`, `avx2` or `avx512` before the first parse, or by calling `set_isa()`.
+ */
+inline Isa active_isa() {
+    return isa_state().active;
+}
+
+/**
+ * Override the instruction set for the scanning kernels, typically for testing each variant.
+ * This should not be called while other threads are parsing.
+ *
+ * @param isa Instruction set to use.
+ * An error is raised if this is not supported, see `supported_isa()`.
+ */
+inline void set_isa(Isa isa) {
+    if (isa > supported_isa()) {
+        throw std::runtime_error("requested instruction set is not supported on this machine");
+    }
+    auto& state = isa_state();
+    state.active = isa;
+    state.kernels = select_kernels(isa);
+}
+
+}
+
+#endif
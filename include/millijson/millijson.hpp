@@ -11,6 +11,23 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <array>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+// Runtime dispatch to SIMD scanning kernels is opt-in, see isa.hpp.
+// If used, this macro should be defined consistently in all translation units of a program.
+#ifdef MILLIJSON_USE_ISA
+#include "isa.hpp"
+#endif
 
 /**
  * @file millijson.hpp
@@ -36,6 +53,119 @@ enum Type {
     OBJECT
 };
 
+/**
+ * @cond
+ */
+inline const std::array<uint64_t, 2>& default_hash_seed() {
+    static const std::array<uint64_t, 2> seed = []() -> std::array<uint64_t, 2> {
+        std::random_device rd;
+        std::array<uint64_t, 2> output;
+        for (auto& x : output) {
+            x = (static_cast<uint64_t>(rd()) << 32) ^ static_cast<uint64_t>(rd());
+        }
+        return output;
+    }();
+    return seed;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Keyed hash for object keys.
+ *
+ * This uses SipHash-1-3 with a seed that is randomly chosen once per process.
+ * As the hash values cannot be predicted without the seed, it is not possible to craft object keys that collide in the hash table, 
+ * e.g., to degrade parsing of untrusted input to quadratic time.
+ */
+struct KeyHash {
+    /**
+     * Hash with the default seed for this process.
+     */
+    KeyHash() : KeyHash(default_hash_seed()[0], default_hash_seed()[1]) {}
+
+    /**
+     * @param k0 First half of the seed.
+     * @param k1 Second half of the seed.
+     */
+    KeyHash(uint64_t k0, uint64_t k1) : k0(k0), k1(k1) {}
+
+    /**
+     * First half of the seed.
+     */
+    uint64_t k0;
+
+    /**
+     * Second half of the seed.
+     */
+    uint64_t k1;
+
+    /**
+     * @param key String to be hashed.
+     * @return Hash of the string.
+     */
+    size_t operator()(const std::string& key) const {
+        uint64_t v0 = k0 ^ 0x736f6d6570736575ull;
+        uint64_t v1 = k1 ^ 0x646f72616e646f6dull;
+        uint64_t v2 = k0 ^ 0x6c7967656e657261ull;
+        uint64_t v3 = k1 ^ 0x7465646279746573ull;
+
+        auto rotl = [](uint64_t x, int b) -> uint64_t { return (x << b) | (x >> (64 - b)); };
+        auto round = [&]() -> void {
+            v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+            v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+            v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+            v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+        };
+
+        // Assembling each word byte-by-byte to be independent of the platform's endianness.
+        const unsigned char* ptr = reinterpret_cast<const unsigned char*>(key.data());
+        size_t len = key.size();
+        size_t full = len / 8 * 8;
+        for (size_t i = 0; i < full; i += 8) {
+            uint64_t m = 0;
+            for (size_t j = 8; j > 0; --j) {
+                m = (m << 8) | ptr[i + j - 1];
+            }
+            v3 ^= m;
+            round();
+            v0 ^= m;
+        }
+
+        uint64_t last = static_cast<uint64_t>(len) << 56;
+        for (size_t j = len; j > full; --j) {
+            last |= static_cast<uint64_t>(ptr[j - 1]) << (8 * (j - 1 - full));
+        }
+        v3 ^= last;
+        round();
+        v0 ^= last;
+
+        v2 ^= 0xff;
+        round();
+        round();
+        round();
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+};
+
+/**
+ * @cond
+ */
+struct Base;
+/**
+ * @endcond
+ */
+
+/**
+ * Map of key-value pairs used to store the contents of a JSON object.
+ * Keys are hashed with a randomly seeded `KeyHash`, so the iteration order is unspecified and may differ between runs of the same program.
+ * Code that needs a deterministic order should sort the keys.
+ *
+ * Prior to version 2.0.0, this was a `std::unordered_map` with the default `std::hash`.
+ * Downstream code should refer to this alias rather than spelling out the map type.
+ */
+typedef std::unordered_map<std::string, std::shared_ptr<Base>, KeyHash> ObjectMap;
+
 /**
  * @brief Virtual base class for all JSON types.
  */
@@ -71,12 +201,51 @@ struct Base {
     /**
      * @return An unordered map of key-value pairs, if `this` points to an `Object` class.
      */ 
-    const std::unordered_map<std::string, std::shared_ptr<Base> >& get_object() const;
+    const ObjectMap& get_object() const;
 
     /**
      * @return A vector of `Base` objects, if `this` points to an `Array` class.
      */ 
     const std::vector<std::shared_ptr<Base> >& get_array() const;
+
+    /**
+     * @return The string, if `this` points to a `String` class.
+     * This can be modified in place.
+     */ 
+    std::string& get_string();
+
+    /**
+     * @return An unordered map of key-value pairs, if `this` points to an `Object` class.
+     * This can be modified in place.
+     */ 
+    ObjectMap& get_object();
+
+    /**
+     * @return A vector of `Base` objects, if `this` points to an `Array` class.
+     * This can be modified in place.
+     */ 
+    std::vector<std::shared_ptr<Base> >& get_array();
+
+    /**
+     * @return The string, if `this` points to a `String` class.
+     * This is moved out of `this`, leaving an empty string behind.
+     * Callers should ensure that no one else holds a reference to `this`, e.g., via a `std::shared_ptr` with a `use_count()` of 1.
+     */ 
+    std::string take_string();
+
+    /**
+     * @return An unordered map of key-value pairs, if `this` points to an `Object` class.
+     * This is moved out of `this`, leaving an empty map behind.
+     * Callers should ensure that no one else holds a reference to `this`.
+     */ 
+    ObjectMap take_object();
+
+    /**
+     * @return A vector of `Base` objects, if `this` points to an `Array` class.
+     * This is moved out of `this`, leaving an empty vector behind.
+     * Callers should ensure that no one else holds a reference to `this`.
+     */ 
+    std::vector<std::shared_ptr<Base> > take_array();
 };
 
 /**
@@ -175,7 +344,7 @@ struct Object : public Base {
     /**
      * Key-value pairs of the object.
      */
-    std::unordered_map<std::string, std::shared_ptr<Base> > values;
+    ObjectMap values;
 
     /**
      * @param key String containing the key.
@@ -210,7 +379,7 @@ inline bool Base::get_boolean() const {
     return static_cast<const Boolean*>(this)->value;
 }
 
-inline const std::unordered_map<std::string, std::shared_ptr<Base> >& Base::get_object() const {
+inline const ObjectMap& Base::get_object() const {
     return static_cast<const Object*>(this)->values;
 }
 
@@ -218,16 +387,93 @@ inline const std::vector<std::shared_ptr<Base> >& Base::get_array() const {
     return static_cast<const Array*>(this)->values;
 }
 
+inline std::string& Base::get_string() {
+    return static_cast<String*>(this)->value;
+}
+
+inline ObjectMap& Base::get_object() {
+    return static_cast<Object*>(this)->values;
+}
+
+inline std::vector<std::shared_ptr<Base> >& Base::get_array() {
+    return static_cast<Array*>(this)->values;
+}
+
+inline std::string Base::take_string() {
+    std::string output;
+    output.swap(get_string());
+    return output;
+}
+
+inline ObjectMap Base::take_object() {
+    ObjectMap output;
+    output.swap(get_object());
+    return output;
+}
+
+inline std::vector<std::shared_ptr<Base> > Base::take_array() {
+    std::vector<std::shared_ptr<Base> > output;
+    output.swap(get_array());
+    return output;
+}
+
 inline bool isspace(char x) {
     // Allowable whitespaces as of https://www.rfc-editor.org/rfc/rfc7159#section-2.
     return x == ' ' || x == '\n' || x == '\r' || x == '\t';
 }
 
+template<class Input, class = void>
+struct has_bulk_access : std::false_type {};
+
+template<class Input>
+struct has_bulk_access<Input, std::void_t<
+    decltype(std::declval<const Input&>().current()),
+    decltype(std::declval<const Input&>().remaining()),
+    decltype(std::declval<Input&>().skip(static_cast<size_t>(0)))
+> > : std::true_type {};
+
+// Index of the first byte in [ptr, ptr + len) that is not JSON whitespace, or len if there is no such byte.
+inline size_t skip_whitespace(const char* ptr, size_t len) {
+#ifdef MILLIJSON_USE_ISA
+    return scan_kernels().skip_whitespace(ptr, len);
+#else
+    for (size_t i = 0; i < len; ++i) {
+        char x = ptr[i];
+        if (x != ' ' && x != '\n' && x != '\r' && x != '\t') {
+            return i;
+        }
+    }
+    return len;
+#endif
+}
+
+// Index of the first byte in [ptr, ptr + len) that ends a run of plain string characters, i.e., a quote, backslash or control character.
+inline size_t find_special(const char* ptr, size_t len) {
+#ifdef MILLIJSON_USE_ISA
+    return scan_kernels().find_special(ptr, len);
+#else
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char x = ptr[i];
+        if (x < 0x20 || x == '"' || x == '\\') {
+            return i;
+        }
+    }
+    return len;
+#endif
+}
+
 template<class Input>
 void chomp(Input& input) {
     bool ok = input.valid();
-    while (ok && isspace(input.get())) {
-        ok = input.advance();
+    if constexpr(has_bulk_access<Input>::value) {
+        // Checking the first byte before scanning, as tokens are usually separated by at most one space.
+        while (ok && isspace(input.get())) {
+            ok = input.skip(skip_whitespace(input.current(), input.remaining()));
+        }
+    } else {
+        while (ok && isspace(input.get())) {
+            ok = input.advance();
+        }
     }
     return;
 }
@@ -246,6 +492,143 @@ bool is_expected_string(Input& input, const std::string& expected) {
     return true;
 }
 
+struct StringTables {
+    // Decoded character for each simple escape, or zero if the escape is not simple.
+    char escapes[256];
+
+    // Value of each hexadecimal digit, or -1 if the character is not a hexadecimal digit.
+    signed char hex[256];
+
+    // Whether each character can be copied as-is, i.e., it is not a quote, backslash or control character.
+    bool plain[256];
+
+    constexpr StringTables() : escapes(), hex(), plain() {
+        for (int i = 0; i < 256; ++i) {
+            hex[i] = -1;
+            plain[i] = (i >= 0x20 && i != '"' && i != '\\');
+        }
+        for (int i = 0; i < 10; ++i) {
+            hex['0' + i] = i;
+        }
+        for (int i = 0; i < 6; ++i) {
+            hex['a' + i] = 10 + i;
+            hex['A' + i] = 10 + i;
+        }
+
+        escapes[static_cast<unsigned char>('"')] = '"';
+        escapes[static_cast<unsigned char>('\\')] = '\\';
+        escapes[static_cast<unsigned char>('/')] = '/';
+        escapes[static_cast<unsigned char>('b')] = '\b';
+        escapes[static_cast<unsigned char>('f')] = '\f';
+        escapes[static_cast<unsigned char>('n')] = '\n';
+        escapes[static_cast<unsigned char>('r')] = '\r';
+        escapes[static_cast<unsigned char>('t')] = '\t';
+    }
+};
+
+inline constexpr StringTables string_tables{};
+
+inline char* write_utf8(char* output, unsigned short mb) {
+    if (mb <= 127) {
+        *(output++) = static_cast<char>(mb);
+    } else if (mb <= 2047) {
+        *(output++) = static_cast<char>((mb >> 6) | 0b11000000);
+        *(output++) = static_cast<char>((mb & 0b00111111) | 0b10000000);
+    } else {
+        *(output++) = static_cast<char>((mb >> 12) | 0b11100000);
+        *(output++) = static_cast<char>(((mb >> 6) & 0b00111111) | 0b10000000);
+        *(output++) = static_cast<char>((mb & 0b00111111) | 0b10000000);
+    }
+    return output;
+}
+
+inline void append_utf8(std::string& output, unsigned short mb) {
+    // Manually convert Unicode code points to UTF-8. We only allow
+    // 3 bytes at most because there's only 4 hex digits in JSON. 
+    char buffer[3];
+    output.append(buffer, write_utf8(buffer, mb));
+}
+
+template<class Input>
+void extract_unicode_escape(Input& input, std::string& output, size_t start) {
+    // Collecting all four digits before a single validity check, to avoid branching on each digit.
+    int digits[4];
+    for (size_t i = 0; i < 4; ++i) {
+        if (!input.advance()){
+            throw std::runtime_error("unterminated string at position " + std::to_string(start));
+        }
+        digits[i] = string_tables.hex[static_cast<unsigned char>(input.get())];
+    }
+    if ((digits[0] | digits[1] | digits[2] | digits[3]) < 0) {
+        size_t bad = 0;
+        while (digits[bad] >= 0) {
+            ++bad;
+        }
+        throw std::runtime_error("invalid unicode escape detected at position " + std::to_string(input.position() + 1 - (3 - bad)));
+    }
+    append_utf8(output, (digits[0] << 12) | (digits[1] << 8) | (digits[2] << 4) | digits[3]);
+}
+
+inline size_t decode_string_window(const char* ptr, size_t len, std::string& output) {
+    // Decoding directly from the input buffer, without a get()/advance() per byte.
+    // This stops at the closing quote or at anything that needs the careful handling in extract_string(),
+    // e.g., errors or escapes that are split across buffer refills.
+    const char* p = ptr;
+    const char* end = ptr + len;
+
+    // Restricting ourselves to the closing quote (if it's in the window) so that we can pre-allocate the output;
+    // the decoded string can't be longer than its escaped form. If the quote isn't in the window, we don't pre-allocate,
+    // as the window might be the entire remainder of a large input; the output just grows with the decoded bytes instead.
+    const char* quote = p;
+    while (1) {
+        quote = static_cast<const char*>(std::memchr(quote, '"', end - quote));
+        if (!quote) {
+            break;
+        }
+        const char* back = quote;
+        while (back > p && back[-1] == '\\') {
+            --back;
+        }
+        if ((quote - back) % 2 == 0) {
+            end = quote;
+            output.reserve(output.size() + (end - p));
+            break;
+        }
+        ++quote;
+    }
+
+    while (p < end) {
+        size_t run = find_special(p, end - p);
+        output.append(p, run);
+        p += run;
+        if (p == end || *p != '\\' || p + 1 == end) {
+            break;
+        }
+
+        char decoded = string_tables.escapes[static_cast<unsigned char>(p[1])];
+        if (decoded) {
+            output += decoded;
+            p += 2;
+            continue;
+        }
+
+        if (p[1] != 'u' || end - p < 6) {
+            break;
+        }
+        int digits[4];
+        for (size_t i = 0; i < 4; ++i) {
+            digits[i] = string_tables.hex[static_cast<unsigned char>(p[2 + i])];
+        }
+        if ((digits[0] | digits[1] | digits[2] | digits[3]) < 0) {
+            break;
+        }
+        append_utf8(output, (digits[0] << 12) | (digits[1] << 8) | (digits[2] << 4) | digits[3]);
+        p += 6;
+    }
+
+    return p - ptr;
+}
+
 template<class Input>
 std::string extract_string(Input& input) {
     size_t start = input.position() + 1;
@@ -253,97 +636,39 @@ std::string extract_string(Input& input) {
     std::string output;
 
     while (1) {
+        if constexpr(has_bulk_access<Input>::value) {
+            size_t consumed = decode_string_window(input.current(), input.remaining(), output);
+            if (consumed && !input.skip(consumed)) {
+                throw std::runtime_error("unterminated string at position " + std::to_string(start));
+            }
+        }
+
         char next = input.get();
-        switch (next) {
-            case '"':
-                input.advance(); // get past the closing quote.
-                return output;
-            case '\\':
-                if (!input.advance()) {
-                    throw std::runtime_error("unterminated string at position " + std::to_string(start));
-                } else {
-                    char next2 = input.get();
-                    switch (next2) {
-                        case '"':
-                            output += '"';          
-                            break;
-                        case 'n':
-                            output += '\n';
-                            break;
-                        case 'r':
-                            output += '\r';
-                            break;
-                        case '\\':
-                            output += '\\';
-                            break;
-                        case '/':
-                            output += '/';
-                            break;
-                        case 'b':
-                            output += '\b';
-                            break;
-                        case 'f':
-                            output += '\f';
-                            break;
-                        case 't':
-                            output += '\t';
-                            break;
-                        case 'u':
-                            {
-                                unsigned short mb = 0;
-                                for (size_t i = 0; i < 4; ++i) {
-                                    if (!input.advance()){
-                                        throw std::runtime_error("unterminated string at position " + std::to_string(start));
-                                    }
-                                    mb *= 16;
-                                    char val = input.get();
-                                    switch (val) {
-                                        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
-                                            mb += val - '0';
-                                            break;
-                                        case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': 
-                                            mb += (val - 'a') + 10;
-                                            break;
-                                        case 'A': case 'B': case 'C': case 'D': case 'E': case 'F': 
-                                            mb += (val - 'A') + 10;
-                                            break;
-                                        default:
-                                            throw std::runtime_error("invalid unicode escape detected at position " + std::to_string(input.position() + 1));
-                                    }
-                                }
-
-                                // Manually convert Unicode code points to UTF-8. We only allow
-                                // 3 bytes at most because there's only 4 hex digits in JSON. 
-                                if (mb <= 127) {
-                                    output += static_cast<char>(mb);
-                                } else if (mb <= 2047) {
-                                    unsigned char left = (mb >> 6) | 0b11000000;
-                                    output += *(reinterpret_cast<char*>(&left));
-                                    unsigned char right = (mb & 0b00111111) | 0b10000000;
-                                    output += *(reinterpret_cast<char*>(&right));
-                                } else {
-                                    unsigned char left = (mb >> 12) | 0b11100000;
-                                    output += *(reinterpret_cast<char*>(&left));
-                                    unsigned char middle = ((mb >> 6) & 0b00111111) | 0b10000000;
-                                    output += *(reinterpret_cast<char*>(&middle));
-                                    unsigned char right = (mb & 0b00111111) | 0b10000000;
-                                    output += *(reinterpret_cast<char*>(&right));
-                                }
-                            }
-                            break;
-                        default:
-                            throw std::runtime_error("unrecognized escape '\\" + std::string(1, next2) + "'");
-                    }
-                }
-                break;
-            case (char) 0: case (char) 1: case (char) 2: case (char) 3: case (char) 4: case (char) 5: case (char) 6: case (char) 7: case (char) 8: case (char) 9:
-            case (char)10: case (char)11: case (char)12: case (char)13: case (char)14: case (char)15: case (char)16: case (char)17: case (char)18: case (char)19:
-            case (char)20: case (char)21: case (char)22: case (char)23: case (char)24: case (char)25: case (char)26: case (char)27: case (char)28: case (char)29:
-            case (char)30: case (char)31:
-                throw std::runtime_error("string contains ASCII control character at position " + std::to_string(input.position() + 1));
-            default:
-                output += next;
-                break;
+        if (string_tables.plain[static_cast<unsigned char>(next)]) {
+            output += next;
+
+        } else if (next == '"') {
+            input.advance(); // get past the closing quote.
+            return output;
+
+        } else if (next == '\\') {
+            if (!input.advance()) {
+                throw std::runtime_error("unterminated string at position " + std::to_string(start));
+            }
+
+            // Table lookups for the simple escapes, which dominate escape-dense strings like embedded JSON or Windows paths.
+            char next2 = input.get();
+            char decoded = string_tables.escapes[static_cast<unsigned char>(next2)];
+            if (decoded) {
+                output += decoded;
+            } else if (next2 == 'u') {
+                extract_unicode_escape(input, output, start);
+            } else {
+                throw std::runtime_error("unrecognized escape '\\" + std::string(1, next2) + "'");
+            }
+
+        } else {
+            throw std::runtime_error("string contains ASCII control character at position " + std::to_string(input.position() + 1));
         }
 
         if (!input.advance()) {
@@ -502,13 +827,31 @@ struct DefaultProvisioner {
         return new Nothing;
     }
 
-    static Array* new_array() {
+    static Array* new_array(size_t) {
         return new Array;
     }
 
-    static Object* new_object() {
+    static Object* new_object(size_t) {
         return new Object;
     }
+
+    // Hooks for provisioners that need to track the position of each value, e.g., to record spans.
+    // These are no-ops by default and should be optimized away.
+    template<class Input_>
+    static void enter(const Input_&) {}
+
+    static void key(const std::string&) {}
+
+    template<class Input_, class Value_>
+    static void leave(const Input_&, const Value_&) {}
+
+    // Hook for provisioners that parse some arrays by themselves, e.g., to avoid creating a node for each element.
+    // This is called at the opening bracket of each array after enter(), and should either return NULL without consuming any input,
+    // or consume the entire array (including the closing bracket) and return the value to use in its place.
+    template<class Input_>
+    static std::shared_ptr<base> intercept_array(Input_&, size_t) {
+        return std::shared_ptr<base>();
+    }
 };
 
 struct FakeProvisioner {
@@ -550,13 +893,13 @@ struct FakeProvisioner {
         Type type() const { return ARRAY; }
         void add(std::shared_ptr<FakeBase>) {}
     };
-    static FakeArray* new_array() {
+    static FakeArray* new_array(size_t) {
         return new FakeArray;
     }
 
     struct FakeObject : public FakeBase {
         Type type() const { return OBJECT; }
-        std::unordered_set<std::string> keys;
+        std::unordered_set<std::string, KeyHash> keys;
         bool has(const std::string& key) const {
             return keys.find(key) != keys.end();
         }
@@ -564,41 +907,63 @@ struct FakeProvisioner {
             keys.insert(std::move(key));
         }
     };
-    static FakeObject* new_object() {
+    static FakeObject* new_object(size_t) {
         return new FakeObject;
     }
+
+    template<class Input_>
+    static void enter(const Input_&) {}
+
+    static void key(const std::string&) {}
+
+    template<class Input_, class Value_>
+    static void leave(const Input_&, const Value_&) {}
+
+    template<class Input_>
+    static std::shared_ptr<base> intercept_array(Input_&, size_t) {
+        return std::shared_ptr<base>();
+    }
 };
 
 template<class Provisioner, class Input>
-std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
+std::shared_ptr<typename Provisioner::base> parse_thing(Input& input, Provisioner& provisioner, size_t depth) {
     std::shared_ptr<typename Provisioner::base> output;
+    provisioner.enter(input);
 
     size_t start = input.position() + 1;
     const char current = input.get();
 
+    if (current == '[') {
+        output = provisioner.intercept_array(input, depth);
+        if (output) {
+            provisioner.leave(input, output);
+            return output;
+        }
+    }
+
     if (current == 't') {
         if (!is_expected_string(input, "true")) {
             throw std::runtime_error("expected a 'true' string at position " + std::to_string(start));
         }
-        output.reset(Provisioner::new_boolean(true));
+        output.reset(provisioner.new_boolean(true));
 
     } else if (current == 'f') {
         if (!is_expected_string(input, "false")) {
             throw std::runtime_error("expected a 'false' string at position " + std::to_string(start));
         }
-        output.reset(Provisioner::new_boolean(false));
+        output.reset(provisioner.new_boolean(false));
 
     } else if (current == 'n') {
         if (!is_expected_string(input, "null")) {
             throw std::runtime_error("expected a 'null' string at position " + std::to_string(start));
         }
-        output.reset(Provisioner::new_nothing());
+        output.reset(provisioner.new_nothing());
 
     } else if (current == '"') {
-        output.reset(Provisioner::new_string(extract_string(input)));
+        output.reset(provisioner.new_string(extract_string(input)));
 
     } else if (current == '[') {
-        auto ptr = Provisioner::new_array();
+        auto ptr = provisioner.new_array(depth);
         output.reset(ptr);
 
         input.advance();
@@ -609,7 +974,7 @@ std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
 
         if (input.get() != ']') {
             while (1) {
-                ptr->add(parse_thing<Provisioner>(input));
+                ptr->add(parse_thing(input, provisioner, depth + 1));
 
                 chomp(input);
                 if (!input.valid()) {
@@ -634,7 +999,7 @@ std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
         input.advance(); // skip the closing bracket.
 
     } else if (current == '{') {
-        auto ptr = Provisioner::new_object();
+        auto ptr = provisioner.new_object(depth);
         output.reset(ptr);
 
         input.advance();
@@ -667,7 +1032,8 @@ std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
                 if (!input.valid()) {
                     throw std::runtime_error("unterminated object starting at position " + std::to_string(start));
                 }
-                ptr->add(std::move(key), parse_thing<Provisioner>(input)); // consuming the key here.
+                provisioner.key(key);
+                ptr->add(std::move(key), parse_thing(input, provisioner, depth + 1)); // consuming the key here.
 
                 chomp(input);
                 if (!input.valid()) {
@@ -678,7 +1044,7 @@ std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
                 if (next == '}') {
                     break;
                 } else if (next != ',') {
-                    throw std::runtime_error("unknown character '" + std::string(1, next) + "' in array at position " + std::to_string(input.position() + 1));
+                    throw std::runtime_error("unknown character '" + std::string(1, next) + "' in object at position " + std::to_string(input.position() + 1));
                 }
 
                 input.advance(); 
@@ -695,22 +1061,23 @@ std::shared_ptr<typename Provisioner::base> parse_thing(Input& input) {
         if (!input.advance()) {
             throw std::runtime_error("incomplete number starting at position " + std::to_string(start));
         }
-        output.reset(Provisioner::new_number(-extract_number(input)));
+        output.reset(provisioner.new_number(-extract_number(input)));
 
     } else if (std::isdigit(current)) {
-        output.reset(Provisioner::new_number(extract_number(input)));
+        output.reset(provisioner.new_number(extract_number(input)));
 
     } else {
         throw std::runtime_error(std::string("unknown type starting with '") + std::string(1, current) + "' at position " + std::to_string(start));
     }
 
+    provisioner.leave(input, output);
     return output;
 }
 
 template<class Provisioner, class Input>
-std::shared_ptr<typename Provisioner::base> parse_thing_with_chomp(Input& input) {
+std::shared_ptr<typename Provisioner::base> parse_thing_with_chomp(Input& input, Provisioner& provisioner) {
     chomp(input);
-    auto output = parse_thing<Provisioner>(input);
+    auto output = parse_thing(input, provisioner, 0);
     chomp(input);
     if (input.valid()) {
         throw std::runtime_error("invalid json with trailing non-space characters at position " + std::to_string(input.position() + 1));
@@ -729,12 +1096,19 @@ std::shared_ptr<typename Provisioner::base> parse_thing_with_chomp(Input& input)
  * - `bool advance()`, to advance the input stream and return `valid()` at the new position.
  * - `size_t position() const`, for the current position relative to the start of the byte stream.
  *
+ * Optionally, the class may also provide bulk access to its buffered bytes, which is used to speed up the decoding of strings:
+ *
+ * - `const char* current() const`, a pointer to the byte at the current position.
+ * - `size_t remaining() const`, the number of contiguous bytes available from `current()`.
+ * - `bool skip(size_t n)`, to advance the input stream by `n` bytes (no greater than `remaining()`) and return `valid()` at the new position.
+ *
  * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
  * @return A pointer to a JSON value.
  */
 template<class Input>
 std::shared_ptr<Base> parse(Input& input) {
-    return parse_thing_with_chomp<DefaultProvisioner>(input);
+    DefaultProvisioner provisioner;
+    return parse_thing_with_chomp(input, provisioner);
 }
 
 /**
@@ -747,7 +1121,8 @@ std::shared_ptr<Base> parse(Input& input) {
  */
 template<class Input>
 Type validate(Input& input) {
-    auto ptr = parse_thing_with_chomp<FakeProvisioner>(input);
+    FakeProvisioner provisioner;
+    auto ptr = parse_thing_with_chomp(input, provisioner);
     return ptr->type();
 }
 
@@ -776,6 +1151,19 @@ struct RawReader {
     size_t position() const {
         return pos_;
     }
+
+    const char* current() const {
+        return ptr_ + pos_;
+    }
+
+    size_t remaining() const {
+        return len_ - pos_;
+    }
+
+    bool skip(size_t n) {
+        pos_ += n;
+        return valid();
+    }
 };
 /**
  * @endcond
@@ -803,22 +1191,194 @@ inline Type validate_string(const char* ptr, size_t len) {
     return validate(input);
 }
 
+/**
+ * @brief Thread-safe pool of reusable buffers for reading files.
+ *
+ * Each file reader borrows a buffer from the pool and returns it on destruction, avoiding a fresh allocation for every file.
+ * This is most useful when parsing many small files.
+ * Pooling is opt-in via `FileReadOptions::pool`, as the idle buffers are retained until the pool is cleared or destroyed.
+ */
+class BufferPool {
+public:
+    /**
+     * @param max_buffers Maximum number of idle buffers to retain.
+     * @param max_buffer_size Maximum size of a buffer to retain, in bytes.
+     * Larger buffers are freed when they are returned to the pool.
+     * @param max_retained_bytes Maximum total size of all idle buffers, in bytes.
+     * Buffers that would cause this limit to be exceeded are freed when they are returned to the pool.
+     */
+    BufferPool(size_t max_buffers = 16, size_t max_buffer_size = 1048576, size_t max_retained_bytes = 16777216) :
+        my_max_buffers(max_buffers), my_max_buffer_size(max_buffer_size), my_max_retained_bytes(max_retained_bytes) {}
+
+    /**
+     * @cond
+     */
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param size Required size of the buffer.
+     * @return A buffer of the specified size, reusing an idle buffer with sufficient capacity if possible.
+     * Its contents are unspecified.
+     */
+    std::vector<char> acquire(size_t size) {
+        std::vector<char> output;
+        {
+            std::lock_guard<std::mutex> lck(my_mutex);
+            // Best fit, so that small requests don't take the large buffers.
+            size_t chosen = my_buffers.size();
+            for (size_t i = 0, end = my_buffers.size(); i < end; ++i) {
+                size_t cap = my_buffers[i].capacity();
+                if (cap >= size && (chosen == end || cap < my_buffers[chosen].capacity())) {
+                    chosen = i;
+                }
+            }
+            if (chosen != my_buffers.size()) {
+                my_retained_bytes -= my_buffers[chosen].capacity();
+                output.swap(my_buffers[chosen]);
+                my_buffers[chosen].swap(my_buffers.back());
+                my_buffers.pop_back();
+            }
+        }
+        output.resize(size);
+        return output;
+    }
+
+    /**
+     * @param buffer Buffer to return to the pool.
+     * This is freed if the pool is full or if the buffer is too large.
+     */
+    void release(std::vector<char> buffer) {
+        size_t cap = buffer.capacity();
+        if (cap == 0 || cap > my_max_buffer_size) {
+            return;
+        }
+        std::lock_guard<std::mutex> lck(my_mutex);
+        if (my_buffers.size() < my_max_buffers && cap <= my_max_retained_bytes - my_retained_bytes) {
+            my_buffers.push_back(std::move(buffer));
+            my_retained_bytes += cap;
+        }
+    }
+
+    /**
+     * @return Number of idle buffers in the pool.
+     */
+    size_t idle() const {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        return my_buffers.size();
+    }
+
+    /**
+     * @return Total capacity of the idle buffers in the pool, in bytes.
+     */
+    size_t retained_bytes() const {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        return my_retained_bytes;
+    }
+
+    /**
+     * Free all idle buffers.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        my_buffers.clear();
+        my_retained_bytes = 0;
+    }
+
+    /**
+     * @return A process-wide pool, e.g., for use in `FileReadOptions::pool`.
+     */
+    static BufferPool& global() {
+        static BufferPool pool;
+        return pool;
+    }
+
+private:
+    size_t my_max_buffers;
+    size_t my_max_buffer_size;
+    size_t my_max_retained_bytes;
+    size_t my_retained_bytes = 0;
+    mutable std::mutex my_mutex;
+    std::vector<std::vector<char> > my_buffers;
+};
+
+/**
+ * @brief Options for reading JSON files.
+ */
+struct FileReadOptions {
+    /**
+     * Size of the buffer to use for reading the file in chunks.
+     */
+    size_t buffer_size = 65536;
+
+    /**
+     * Whether to read the entire file with a single call into an exactly-sized buffer, if its size is no greater than `single_read_limit`.
+     * The file size is obtained with `fstat()`, so this is only used on POSIX systems and for regular files;
+     * otherwise, the file is read in chunks of `buffer_size`.
+     * Any data appended to the file after its size is obtained will be ignored.
+     */
+    bool single_read = false;
+
+    /**
+     * Maximum file size for `single_read`, in bytes.
+     */
+    size_t single_read_limit = 16777216;
+
+    /**
+     * Pool to borrow buffers from, e.g., `&BufferPool::global()`.
+     * If NULL, a new buffer is allocated for each file.
+     */
+    BufferPool* pool = nullptr;
+};
+
 /**
  * @cond
  */
 struct FileReader{
-    FileReader(const char* p, size_t b) : handle(std::fopen(p, "rb")), buffer(b) {
+    FileReader(const char* p, size_t b) : FileReader(p, [&]() -> FileReadOptions {
+        FileReadOptions options;
+        options.buffer_size = b;
+        return options;
+    }()) {}
+
+    FileReader(const char* p, const FileReadOptions& options) : handle(std::fopen(p, "rb")), pool(options.pool) {
         if (!handle) {
             throw std::runtime_error("failed to open file at '" + std::string(p) + "'");
         }
+
+#if defined(__unix__) || defined(__APPLE__)
+        if (options.single_read) {
+            struct stat info;
+            if (::fstat(::fileno(handle), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && static_cast<size_t>(info.st_size) <= options.single_read_limit) {
+                std::setvbuf(handle, nullptr, _IONBF, 0); // no need for an intermediate buffer when reading in one go.
+                buffer = borrow(info.st_size);
+                fill();
+                finished = true; // ignoring anything appended after fstat(), which saves a read() to confirm the end of the file.
+                return;
+            }
+        }
+#endif
+
+        if (options.buffer_size >= BUFSIZ) {
+            std::setvbuf(handle, nullptr, _IONBF, 0); // large reads bypass the stdio buffer anyway, so we might as well not allocate it.
+        }
+        buffer = borrow(options.buffer_size);
         fill();
     }
 
     ~FileReader() {
         std::fclose(handle);
+        if (pool) {
+            pool->release(std::move(buffer));
+        }
     }
 
     FILE* handle;
+    BufferPool* pool;
     std::vector<char> buffer;
     size_t available = 0;
     size_t index = 0;
@@ -866,6 +1426,27 @@ struct FileReader{
     size_t position() const {
         return overall + index;
     }
+
+    const char* current() const {
+        return buffer.data() + index;
+    }
+
+    size_t remaining() const {
+        return available - index;
+    }
+
+    bool skip(size_t n) {
+        index += n - 1;
+        return advance();
+    }
+
+    std::vector<char> borrow(size_t size) const {
+        if (pool) {
+            return pool->acquire(size);
+        } else {
+            return std::vector<char>(size);
+        }
+    }
 };
 /**
  * @endcond
@@ -881,6 +1462,16 @@ inline std::shared_ptr<Base> parse_file(const char* path, size_t buffer_size = 6
     return parse(input);
 }
 
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param options Options for reading the file.
+ * @return A pointer to a JSON value.
+ */
+inline std::shared_ptr<Base> parse_file(const char* path, const FileReadOptions& options) {
+    FileReader input(path, options);
+    return parse(input);
+}
+
 /**
  * @param[in] path Pointer to an array containing a path to a JSON file.
  * @param buffer_size Size of the buffer to use for reading the file.
@@ -893,6 +1484,18 @@ inline Type validate_file(const char* path, size_t buffer_size = 65536) {
     return validate(input);
 }
 
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param options Options for reading the file.
+ *
+ * @return The type of the JSON variable stored in the file.
+ * If the JSON file is invalid, an error is raised.
+ */
+inline Type validate_file(const char* path, const FileReadOptions& options) {
+    FileReader input(path, options);
+    return validate(input);
+}
+
 }
 
 #endif
@@ -0,0 +1,373 @@
+#ifndef MILLIJSON_NDARRAY_HPP
+#define MILLIJSON_NDARRAY_HPP
+
+#include "millijson.hpp"
+#include "patch.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * @file ndarray.hpp
+ * @brief Extract N-dimensional numeric arrays into contiguous buffers.
+ */
+
+namespace millijson {
+
+/**
+ * @brief N-dimensional numeric array.
+ *
+ * Values are stored contiguously in row-major order, i.e., the last dimension is the fastest-changing.
+ * Exactly one of `doubles` or `integers` is filled, depending on `integer`.
+ */
+struct NdArray {
+    /**
+     * Extent of each dimension, starting from the outermost array.
+     */
+    std::vector<size_t> shape;
+
+    /**
+     * Whether all values are integers, in which case they are stored in `integers`.
+     */
+    bool integer = false;
+
+    /**
+     * Values in row-major order, if `integer = false`.
+     */
+    std::vector<double> doubles;
+
+    /**
+     * Values in row-major order, if `integer = true`.
+     */
+    std::vector<int64_t> integers;
+
+    /**
+     * @return Total number of values.
+     */
+    size_t size() const {
+        return (integer ? integers.size() : doubles.size());
+    }
+
+    /**
+     * @param i Index of the value in row-major order.
+     * @return The value as a double.
+     */
+    double get(size_t i) const {
+        return (integer ? static_cast<double>(integers[i]) : doubles[i]);
+    }
+};
+
+/**
+ * @brief Options for `parse_ndarrays()`.
+ */
+struct NdArrayOptions {
+    /**
+     * JSON pointers to the arrays to be extracted.
+     */
+    std::vector<std::string> paths;
+
+    /**
+     * Whether to extract every rectangular numeric array, regardless of `paths`.
+     * In this mode, only the outermost array of each nest is extracted, and arrays without any numbers are left in the document.
+     */
+    bool automatic = false;
+
+    /**
+     * Whether to store arrays as 64-bit integers if all of their values are integers within range.
+     */
+    bool integers = true;
+};
+
+/**
+ * @brief A JSON document with its numeric arrays extracted into contiguous buffers.
+ */
+struct NdArrayDocument {
+    /**
+     * Root of the document.
+     * Each extracted array is replaced by a null value.
+     */
+    std::shared_ptr<Base> root;
+
+    /**
+     * Extracted arrays, keyed by their JSON pointers in the document.
+     */
+    std::map<std::string, NdArray> arrays;
+};
+
+/**
+ * @cond
+ */
+// Values outside of the extracted arrays are parsed by parse_thing() as usual, with their pointers tracked by the base class.
+// Candidate arrays are intercepted at their opening bracket and collected directly from the input.
+class NdArrayProvisioner : public TrackingProvisioner<true> {
+public:
+    NdArrayProvisioner(const NdArrayOptions& options, NdArrayDocument& output) :
+        my_options(options), my_targets(options.paths.begin(), options.paths.end()), my_output(output) {}
+
+    template<class Input_>
+    std::shared_ptr<Base> intercept_array(Input_& input, size_t depth) {
+        if (!my_options.automatic && my_targets.find(path) == my_targets.end()) {
+            return std::shared_ptr<Base>();
+        }
+
+        std::vector<double> buffer;
+        std::vector<size_t> shape;
+        auto fallback = collect(input, buffer, shape, depth);
+        if (fallback) {
+            return fallback;
+        }
+        return materialize(buffer, 0, shape, 0, true);
+    }
+
+private:
+    const NdArrayOptions& my_options;
+    std::unordered_set<std::string> my_targets;
+    NdArrayDocument& my_output;
+
+    static void append_index(std::string& path, size_t i) {
+        path += '/';
+        path += std::to_string(i);
+    }
+
+    // Moves past the separator after an element, returning false if the end of the array was reached instead.
+    template<class Input_>
+    static bool next_element(Input_& input, size_t start) {
+        chomp(input);
+        if (!input.valid()) {
+            throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+        }
+
+        char next = input.get();
+        if (next == ']') {
+            return false;
+        } else if (next != ',') {
+            throw std::runtime_error("unknown character '" + std::string(1, next) + "' in array at position " + std::to_string(input.position() + 1));
+        }
+
+        input.advance();
+        chomp(input);
+        if (!input.valid()) {
+            throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+        }
+        return true;
+    }
+
+    // Parses the remaining elements of an array after a fallback, including the closing bracket.
+    template<class Input_>
+    void parse_remaining(Input_& input, Array& array, size_t start, size_t depth) {
+        while (next_element(input, start)) {
+            array.add(parse_thing(input, *this, depth + 1));
+        }
+        input.advance(); // skip the closing bracket.
+    }
+
+    // Returns NULL if the array (starting at the current position of 'input') is rectangular and numeric, with its values appended to 'buffer' and its extents to 'shape'.
+    // Otherwise, the rest of the array is parsed and a fallback node is returned.
+    //
+    // Each array is checked against its own contents, so that a child that disagrees with its siblings (in type, depth or extents)
+    // is still extracted by itself in automatic mode, exactly as if it were the start of a new nest.
+    template<class Input_>
+    std::shared_ptr<Base> collect(Input_& input, std::vector<double>& buffer, std::vector<size_t>& shape, size_t depth) {
+        size_t start = input.position() + 1;
+        size_t begin = buffer.size();
+        size_t n = 0;
+        bool numbers = false, arrays = false;
+        std::vector<size_t> child_shape, current; // 'child_shape' is shared by all children if 'arrays = true'.
+
+        input.advance();
+        chomp(input);
+        if (!input.valid()) {
+            throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+        }
+
+        if (input.get() != ']') {
+            do {
+                char next = input.get();
+                if (!arrays && (next == '-' || (next >= '0' && next <= '9'))) {
+                    numbers = true;
+                    if (next == '-') {
+                        size_t nstart = input.position() + 1;
+                        if (!input.advance()) {
+                            throw std::runtime_error("incomplete number starting at position " + std::to_string(nstart));
+                        }
+                        buffer.push_back(-extract_number(input));
+                    } else {
+                        buffer.push_back(extract_number(input));
+                    }
+                    ++(stack.back().count); // no need for enter()/leave() as numbers don't need their own pointers.
+                    ++n;
+                    continue;
+                }
+
+                if (next == '[' && !numbers) {
+                    size_t child_begin = buffer.size();
+                    current.clear();
+                    TrackingProvisioner<true>::enter(input);
+                    auto child = collect(input, buffer, current, depth + 1);
+
+                    if (!child) {
+                        if (!arrays) {
+                            arrays = true;
+                            child_shape.swap(current);
+                            TrackingProvisioner<true>::leave(input, child);
+                            ++n;
+                            continue;
+                        }
+                        if (current == child_shape) {
+                            TrackingProvisioner<true>::leave(input, child);
+                            ++n;
+                            continue;
+                        }
+                        // Inconsistent with its siblings, but this array is still rectangular by itself.
+                        child = materialize(buffer, child_begin, current, 0, my_options.automatic);
+                    }
+                    TrackingProvisioner<true>::leave(input, child);
+
+                    auto output = fallback(buffer, begin, n, child_shape, 0);
+                    auto& array = static_cast<Array&>(*output);
+                    array.add(std::move(child));
+                    parse_remaining(input, array, start, depth);
+                    return output;
+                }
+
+                // Mixed types or inconsistent depths.
+                auto output = fallback(buffer, begin, n, child_shape, 0);
+                auto& array = static_cast<Array&>(*output);
+                array.add(parse_thing(input, *this, depth + 1));
+                parse_remaining(input, array, start, depth);
+                return output;
+
+            } while (next_element(input, start));
+        }
+
+        input.advance(); // skip the closing bracket.
+        shape.push_back(n);
+        shape.insert(shape.end(), child_shape.begin(), child_shape.end());
+        return std::shared_ptr<Base>();
+    }
+
+    static size_t block_size(const std::vector<size_t>& shape, size_t d) {
+        size_t block = 1;
+        for (size_t i = d, end = shape.size(); i < end; ++i) {
+            block *= shape[i];
+        }
+        return block;
+    }
+
+    // Create an array node from 'n' children starting at 'begin' in the buffer.
+    // Each child is a number if 'd' is equal to the length of 'shape', otherwise it is an array with extents 'shape[d:]'.
+    std::shared_ptr<Base> fallback(const std::vector<double>& buffer, size_t begin, size_t n, const std::vector<size_t>& shape, size_t d) {
+        auto ptr = new Array;
+        std::shared_ptr<Base> output(ptr);
+        if (d == shape.size()) {
+            for (size_t i = 0; i < n; ++i) {
+                ptr->add(std::shared_ptr<Base>(new Number(buffer[begin + i])));
+            }
+        } else {
+            size_t block = block_size(shape, d);
+            size_t original = path.size();
+            for (size_t i = 0; i < n; ++i) {
+                append_index(path, i);
+                ptr->add(materialize(buffer, begin + i * block, shape, d, my_options.automatic));
+                path.resize(original);
+            }
+        }
+        return output;
+    }
+
+    // Create a node for a complete rectangular array at the current path, with extents 'shape[d:]' and values starting at 'begin' in the buffer.
+    std::shared_ptr<Base> materialize(const std::vector<double>& buffer, size_t begin, const std::vector<size_t>& shape, size_t d, bool extract) {
+        size_t total = block_size(shape, d);
+        if (!extract || (my_options.automatic && total == 0)) {
+            return fallback(buffer, begin, shape[d], shape, d + 1);
+        }
+
+        NdArray output;
+        output.shape.insert(output.shape.end(), shape.begin() + d, shape.end());
+        auto start = buffer.begin() + begin;
+        output.doubles.insert(output.doubles.end(), start, start + total);
+
+        if (my_options.integers) {
+            bool all_integer = true;
+            for (auto x : output.doubles) {
+                if (!(std::floor(x) == x && x >= -9223372036854775808.0 && x < 9223372036854775808.0)) {
+                    all_integer = false;
+                    break;
+                }
+            }
+            if (all_integer) {
+                output.integer = true;
+                output.integers.reserve(total);
+                for (auto x : output.doubles) {
+                    output.integers.push_back(static_cast<int64_t>(x));
+                }
+                std::vector<double>().swap(output.doubles);
+            }
+        }
+
+        my_output.arrays[path] = std::move(output);
+        return std::shared_ptr<Base>(new Nothing);
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Parse a JSON document, extracting rectangular nested arrays of numbers into contiguous buffers.
+ * This avoids allocating a separate `Number` for each value of a matrix or tensor.
+ *
+ * Arrays are extracted during parsing, without first constructing their DOM representation.
+ * If a candidate array turns out to be ragged (e.g., `[[1,2],[3]]`) or mixed (e.g., `[1,"a"]`), it is stored in the document as usual.
+ * In automatic mode, any rectangular numeric sub-arrays of such an array are still extracted.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ *
+ * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+ * @param options Further options.
+ *
+ * @return The parsed document and its extracted arrays.
+ */
+template<class Input>
+NdArrayDocument parse_ndarrays(Input& input, const NdArrayOptions& options) {
+    NdArrayDocument output;
+    chomp(input);
+    if (!input.valid()) {
+        throw std::runtime_error("no JSON value found at position " + std::to_string(input.position() + 1));
+    }
+    NdArrayProvisioner provisioner(options, output);
+    output.root = parse_thing_with_chomp(input, provisioner);
+    return output;
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param options Further options.
+ * @return The parsed document and its extracted arrays, see `parse_ndarrays()` for details.
+ */
+inline NdArrayDocument parse_string_ndarrays(const char* ptr, size_t len, const NdArrayOptions& options) {
+    RawReader input(ptr, len);
+    return parse_ndarrays(input, options);
+}
+
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param options Further options.
+ * @param buffer_size Size of the buffer to use for reading the file.
+ * @return The parsed document and its extracted arrays, see `parse_ndarrays()` for details.
+ */
+inline NdArrayDocument parse_file_ndarrays(const char* path, const NdArrayOptions& options, size_t buffer_size = 65536) {
+    FileReader input(path, buffer_size);
+    return parse_ndarrays(input, options);
+}
+
+}
+
+#endif
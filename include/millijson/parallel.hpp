@@ -0,0 +1,333 @@
+#ifndef MILLIJSON_PARALLEL_HPP
+#define MILLIJSON_PARALLEL_HPP
+
+#include "millijson.hpp"
+#include "serialize.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+/**
+ * @file parallel.hpp
+ * @brief Serialize large JSON values with multiple threads.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Options for `serialize_parallel()`.
+ */
+struct ParallelSerializeOptions {
+    /**
+     * Number of worker threads.
+     */
+    size_t num_threads = 4;
+
+    /**
+     * Number of children of an array or object to format in each task.
+     * Containers with at least this many children are split into tasks.
+     */
+    size_t chunk_size = 10000;
+
+    /**
+     * Number of levels of smaller containers to search for large containers to split.
+     * Smaller containers below this depth are formatted as a single task.
+     */
+    size_t plan_depth = 2;
+
+    /**
+     * Maximum number of formatted tasks that can be held in memory while waiting to be written.
+     * If zero, this defaults to 4 times the number of threads.
+     */
+    size_t window = 0;
+
+    /**
+     * Size of the buffer to use for accumulating small fragments of output before calling the writer.
+     */
+    size_t buffer_size = 65536;
+};
+
+/**
+ * @cond
+ */
+typedef std::pair<const std::string, std::shared_ptr<Base> > SerializeEntry;
+
+struct SerializePiece {
+    std::string text; // literal text, or the output of the task.
+    bool task = false;
+
+    // For tasks; either the whole value, or a range of its children if 'range = true'.
+    const Base* value = nullptr;
+    const std::vector<const SerializeEntry*>* entries = nullptr; // sorted entries, for ranges of objects.
+    bool range = false;
+    size_t begin = 0, end = 0;
+
+    bool done = false;
+    std::exception_ptr error;
+};
+
+class SerializePlanner {
+public:
+    SerializePlanner(const ParallelSerializeOptions& options) : my_options(options) {}
+
+    std::vector<SerializePiece> pieces;
+    std::vector<std::unique_ptr<std::vector<const SerializeEntry*> > > sorted;
+
+    void plan(const Base& value, size_t level) {
+        auto type = value.type();
+        if (type != ARRAY && type != OBJECT) {
+            append_scalar(literal(), value);
+            return;
+        }
+
+        size_t n = (type == ARRAY ? value.get_array().size() : value.get_object().size());
+        bool split = n >= my_options.chunk_size;
+        if (!split && level >= my_options.plan_depth) {
+            add_task(value);
+            return;
+        }
+
+        const std::vector<const SerializeEntry*>* entries = nullptr;
+        if (type == OBJECT) {
+            // Sorting in the same manner as serialize().
+            sorted.emplace_back(new std::vector<const SerializeEntry*>);
+            auto& current = *(sorted.back());
+            current.reserve(n);
+            for (const auto& x : value.get_object()) {
+                current.push_back(&x);
+            }
+            std::sort(current.begin(), current.end(), [](const SerializeEntry* left, const SerializeEntry* right) -> bool { return left->first < right->first; });
+            entries = &current;
+        }
+
+        literal() += (type == ARRAY ? '[' : '{');
+        if (split) {
+            for (size_t begin = 0; begin < n; begin += my_options.chunk_size) {
+                pieces.emplace_back();
+                auto& piece = pieces.back();
+                piece.task = true;
+                piece.value = &value;
+                piece.entries = entries;
+                piece.range = true;
+                piece.begin = begin;
+                piece.end = std::min(n, begin + my_options.chunk_size);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                auto& lit = literal(); // not used after plan(), which may invalidate it.
+                if (i) {
+                    lit += ',';
+                }
+                if (type == ARRAY) {
+                    plan(*(value.get_array()[i]), level + 1);
+                } else {
+                    append_string_literal(lit, (*entries)[i]->first);
+                    lit += ':';
+                    plan(*((*entries)[i]->second), level + 1);
+                }
+            }
+        }
+        literal() += (type == ARRAY ? ']' : '}');
+    }
+
+private:
+    const ParallelSerializeOptions& my_options;
+
+    std::string& literal() {
+        if (pieces.empty() || pieces.back().task) {
+            pieces.emplace_back();
+        }
+        return pieces.back().text;
+    }
+
+    void add_task(const Base& value) {
+        pieces.emplace_back();
+        auto& piece = pieces.back();
+        piece.task = true;
+        piece.value = &value;
+    }
+};
+
+inline void run_serialize_task(SerializePiece& piece) {
+    auto appender = [&](const char* ptr, size_t len) -> void { piece.text.append(ptr, len); };
+    BufferedWriter<decltype(appender)> writer(appender, 65536);
+
+    if (!piece.range) {
+        serialize_value(*(piece.value), writer);
+    } else if (piece.value->type() == ARRAY) {
+        const auto& array = piece.value->get_array();
+        for (size_t i = piece.begin; i < piece.end; ++i) {
+            if (i) {
+                writer.buffer += ',';
+            }
+            serialize_value(*(array[i]), writer);
+        }
+    } else {
+        const auto& entries = *(piece.entries);
+        for (size_t i = piece.begin; i < piece.end; ++i) {
+            if (i) {
+                writer.buffer += ',';
+            }
+            append_string_literal(writer.buffer, entries[i]->first);
+            writer.buffer += ':';
+            serialize_value(*(entries[i]->second), writer);
+        }
+    }
+
+    writer.flush();
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Serialize a JSON value with multiple threads, streaming the output to a writer.
+ * Large arrays and objects are split into chunks of children that are formatted concurrently into per-task buffers.
+ * These buffers are then passed to the writer in order, so the output is identical to that of `serialize()`.
+ *
+ * @tparam Writer_ Any callable that accepts a `const char*` and a `size_t`, specifying a pointer to a chunk of bytes and its length, respectively.
+ * This is only called from the calling thread.
+ *
+ * @param value A JSON value.
+ * This should not be modified during serialization.
+ * @param writer Instance of a `Writer_`.
+ * @param options Further options.
+ * @return Number of bytes that were written.
+ *
+ * An error is raised if `value` contains non-finite numbers.
+ */
+template<class Writer_>
+size_t serialize_parallel(const Base& value, Writer_ writer, const ParallelSerializeOptions& options = ParallelSerializeOptions()) {
+    ParallelSerializeOptions opt = options;
+    if (opt.num_threads == 0) {
+        opt.num_threads = 1;
+    }
+    if (opt.chunk_size == 0) {
+        opt.chunk_size = 1;
+    }
+    size_t window = (opt.window ? opt.window : 4 * opt.num_threads);
+
+    SerializePlanner planner(opt);
+    planner.plan(value, 0);
+    auto& pieces = planner.pieces;
+
+    std::vector<size_t> tasks;
+    for (size_t p = 0, end = pieces.size(); p < end; ++p) {
+        if (pieces[p].task) {
+            tasks.push_back(p);
+        }
+    }
+
+    // Workers claim tasks in order, staying within a window of the last written task.
+    std::mutex lock;
+    std::condition_variable cv;
+    size_t next = 0, written = 0;
+    bool failed = false;
+
+    auto work = [&]() -> void {
+        while (1) {
+            size_t t;
+            {
+                std::unique_lock<std::mutex> lk(lock);
+                cv.wait(lk, [&]() -> bool { return failed || next >= tasks.size() || next < written + window; });
+                if (failed || next >= tasks.size()) {
+                    return;
+                }
+                t = next;
+                ++next;
+            }
+
+            auto& piece = pieces[tasks[t]];
+            try {
+                run_serialize_task(piece);
+            } catch (...) {
+                piece.error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(lock);
+                piece.done = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t nworkers = std::min(opt.num_threads, tasks.size());
+    workers.reserve(nworkers);
+    for (size_t w = 0; w < nworkers; ++w) {
+        workers.emplace_back(work);
+    }
+
+    size_t total = 0;
+    std::exception_ptr error;
+    try {
+        BufferedWriter<Writer_> output(writer, opt.buffer_size);
+        size_t t = 0;
+        for (auto& piece : pieces) {
+            if (!piece.task) {
+                output.buffer += piece.text;
+                output.check();
+                continue;
+            }
+
+            {
+                std::unique_lock<std::mutex> lk(lock);
+                cv.wait(lk, [&]() -> bool { return piece.done; });
+            }
+            if (piece.error) {
+                std::rethrow_exception(piece.error);
+            }
+
+            output.flush();
+            writer(piece.text.data(), piece.text.size());
+            total += piece.text.size();
+            std::string().swap(piece.text);
+
+            ++t;
+            {
+                std::lock_guard<std::mutex> lk(lock);
+                written = t;
+            }
+            cv.notify_all();
+        }
+        output.flush();
+        total += output.written();
+    } catch (...) {
+        error = std::current_exception();
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            failed = true;
+        }
+        cv.notify_all();
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return total;
+}
+
+/**
+ * @param value A JSON value.
+ * @param options Further options.
+ * @return String containing the serialized value, see `serialize_parallel()` for details.
+ */
+inline std::string serialize_parallel_string(const Base& value, const ParallelSerializeOptions& options = ParallelSerializeOptions()) {
+    std::string output;
+    serialize_parallel(value, [&](const char* ptr, size_t len) -> void { output.append(ptr, len); }, options);
+    return output;
+}
+
+}
+
+#endif
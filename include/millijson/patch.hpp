@@ -0,0 +1,420 @@
+#ifndef MILLIJSON_PATCH_HPP
+#define MILLIJSON_PATCH_HPP
+
+#include "millijson.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ * @file patch.hpp
+ * @brief Copy-on-write patching of JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * @param left A JSON value.
+ * @param right Another JSON value.
+ * @return Whether `left` and `right` are equal, i.e., have the same type and contents.
+ */
+inline bool equal(const Base& left, const Base& right) {
+    if (&left == &right) {
+        return true;
+    }
+
+    auto type = left.type();
+    if (type != right.type()) {
+        return false;
+    }
+
+    switch (type) {
+        case NUMBER:
+            return left.get_number() == right.get_number();
+        case STRING:
+            return left.get_string() == right.get_string();
+        case BOOLEAN:
+            return left.get_boolean() == right.get_boolean();
+        case NOTHING:
+            return true;
+        case ARRAY:
+            {
+                const auto& larray = left.get_array();
+                const auto& rarray = right.get_array();
+                if (larray.size() != rarray.size()) {
+                    return false;
+                }
+                for (size_t i = 0, end = larray.size(); i < end; ++i) {
+                    if (!equal(*(larray[i]), *(rarray[i]))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        case OBJECT:
+            {
+                const auto& lobject = left.get_object();
+                const auto& robject = right.get_object();
+                if (lobject.size() != robject.size()) {
+                    return false;
+                }
+                for (const auto& x : lobject) {
+                    auto it = robject.find(x.first);
+                    if (it == robject.end() || !equal(*(x.second), *(it->second))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+    }
+
+    return false; // Technically unreachable, but whatever.
+}
+
+/**
+ * @cond
+ */
+inline std::vector<std::string> split_pointer(const std::string& pointer) {
+    std::vector<std::string> output;
+    if (pointer.empty()) {
+        return output;
+    }
+    if (pointer[0] != '/') {
+        throw std::runtime_error("JSON pointer '" + pointer + "' should start with '/'");
+    }
+
+    output.emplace_back();
+    for (size_t i = 1, end = pointer.size(); i < end; ++i) {
+        char x = pointer[i];
+        if (x == '/') {
+            output.emplace_back();
+        } else if (x == '~') {
+            ++i;
+            if (i < end && pointer[i] == '0') {
+                output.back() += '~';
+            } else if (i < end && pointer[i] == '1') {
+                output.back() += '/';
+            } else {
+                throw std::runtime_error("invalid '~' escape in JSON pointer '" + pointer + "'");
+            }
+        } else {
+            output.back() += x;
+        }
+    }
+
+    return output;
+}
+
+inline void append_pointer(std::string& path, const std::string& token) {
+    path += '/';
+    for (auto x : token) {
+        if (x == '~') {
+            path += "~0";
+        } else if (x == '/') {
+            path += "~1";
+        } else {
+            path += x;
+        }
+    }
+}
+
+inline size_t pointer_index(const std::string& token, size_t limit) {
+    if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+        throw std::runtime_error("invalid array index '" + token + "' in JSON pointer");
+    }
+    size_t index = 0;
+    for (auto x : token) {
+        if (x < '0' || x > '9') {
+            throw std::runtime_error("invalid array index '" + token + "' in JSON pointer");
+        }
+        index *= 10;
+        index += x - '0';
+        if (index > limit) {
+            throw std::runtime_error("out-of-range array index '" + token + "' in JSON pointer");
+        }
+    }
+    return index;
+}
+
+inline const std::shared_ptr<Base>& pointer_child(const std::shared_ptr<Base>& node, const std::string& token) {
+    auto type = node->type();
+    if (type == OBJECT) {
+        const auto& object = node->get_object();
+        auto it = object.find(token);
+        if (it == object.end()) {
+            throw std::runtime_error("missing key '" + token + "' in JSON pointer");
+        }
+        return it->second;
+    } else if (type == ARRAY) {
+        const auto& array = node->get_array();
+        if (array.empty()) {
+            throw std::runtime_error("out-of-range array index '" + token + "' in JSON pointer");
+        }
+        return array[pointer_index(token, array.size() - 1)];
+    } else {
+        throw std::runtime_error("JSON pointer refers to a child of a non-container value");
+    }
+}
+
+// Provisioner for parse_thing() that tracks the start position of each value that is being parsed, its enclosing containers and (optionally) its JSON pointer.
+// Derived provisioners can inspect 'stack.back()' and 'path' for the current value in their own enter()/leave() hooks, after/before calling the base versions, respectively.
+template<bool track_path_>
+struct TrackingProvisioner : public DefaultProvisioner {
+    struct Frame {
+        size_t start; // position of the first character of the value.
+        bool object;
+        size_t count; // number of children that have been entered, for arrays and objects.
+        size_t length; // length of 'path' for this value.
+    };
+    std::vector<Frame> stack;
+    std::string path;
+    std::string pending_key;
+
+    template<class Input_>
+    void enter(const Input_& input) {
+        if (!stack.empty()) {
+            auto& parent = stack.back();
+            if constexpr(track_path_) {
+                path.resize(parent.length);
+                if (parent.object) {
+                    append_pointer(path, pending_key);
+                } else {
+                    path += '/';
+                    path += std::to_string(parent.count);
+                }
+            }
+            ++parent.count;
+        }
+        stack.push_back(Frame{ input.position(), input.get() == '{', 0, path.size() });
+    }
+
+    void key(const std::string& k) {
+        pending_key = k;
+    }
+
+    template<class Input_, class Value_>
+    void leave(const Input_&, const Value_&) {
+        stack.pop_back();
+        if constexpr(track_path_) {
+            if (!stack.empty()) {
+                path.resize(stack.back().length); // restoring the parent's pointer.
+            }
+        }
+    }
+};
+
+inline std::shared_ptr<Base> shallow_copy(const std::shared_ptr<Base>& node) {
+    if (node->type() == ARRAY) {
+        return std::make_shared<Array>(static_cast<const Array&>(*node));
+    } else {
+        return std::make_shared<Object>(static_cast<const Object&>(*node));
+    }
+}
+
+// Copies the containers along the path to the target, and calls 'modify' on the copied parent of the target.
+template<class Function_>
+std::shared_ptr<Base> copy_spine(const std::shared_ptr<Base>& node, const std::vector<std::string>& tokens, size_t i, Function_& modify) {
+    auto type = node->type();
+    if (type != ARRAY && type != OBJECT) {
+        throw std::runtime_error("JSON pointer refers to a child of a non-container value");
+    }
+
+    const auto& token = tokens[i];
+    if (i + 1 == tokens.size()) {
+        auto copy = shallow_copy(node);
+        modify(*copy, token);
+        return copy;
+    }
+
+    auto replacement = copy_spine(pointer_child(node, token), tokens, i + 1, modify);
+    auto copy = shallow_copy(node);
+    if (type == ARRAY) {
+        auto& array = copy->get_array();
+        array[pointer_index(token, array.size() - 1)] = std::move(replacement);
+    } else {
+        copy->get_object()[token] = std::move(replacement);
+    }
+    return copy;
+}
+
+inline std::shared_ptr<Base> patch_add(const std::shared_ptr<Base>& document, const std::vector<std::string>& tokens, std::shared_ptr<Base> value) {
+    if (tokens.empty()) {
+        return value;
+    }
+    auto modify = [&](Base& parent, const std::string& token) -> void {
+        if (parent.type() == OBJECT) {
+            parent.get_object()[token] = std::move(value);
+        } else {
+            auto& array = parent.get_array();
+            if (token == "-") {
+                array.push_back(std::move(value));
+            } else {
+                auto index = pointer_index(token, array.size());
+                array.insert(array.begin() + index, std::move(value));
+            }
+        }
+    };
+    return copy_spine(document, tokens, 0, modify);
+}
+
+inline std::shared_ptr<Base> patch_remove(const std::shared_ptr<Base>& document, const std::vector<std::string>& tokens) {
+    if (tokens.empty()) {
+        throw std::runtime_error("cannot remove the root of the document");
+    }
+    auto modify = [&](Base& parent, const std::string& token) -> void {
+        if (parent.type() == OBJECT) {
+            if (parent.get_object().erase(token) == 0) {
+                throw std::runtime_error("missing key '" + token + "' in JSON pointer");
+            }
+        } else {
+            auto& array = parent.get_array();
+            if (array.empty()) {
+                throw std::runtime_error("out-of-range array index '" + token + "' in JSON pointer");
+            }
+            array.erase(array.begin() + pointer_index(token, array.size() - 1));
+        }
+    };
+    return copy_spine(document, tokens, 0, modify);
+}
+
+inline std::shared_ptr<Base> patch_get(const std::shared_ptr<Base>& document, const std::vector<std::string>& tokens) {
+    const std::shared_ptr<Base>* current = &document;
+    for (const auto& t : tokens) {
+        current = &pointer_child(*current, t);
+    }
+    return *current;
+}
+
+inline const std::shared_ptr<Base>& patch_field(const Base& operation, const char* field) {
+    const auto& object = operation.get_object();
+    auto it = object.find(field);
+    if (it == object.end()) {
+        throw std::runtime_error("JSON patch operation should have a '" + std::string(field) + "' property");
+    }
+    return it->second;
+}
+
+inline const std::string& patch_string_field(const Base& operation, const char* field) {
+    const auto& value = patch_field(operation, field);
+    if (value->type() != STRING) {
+        throw std::runtime_error("'" + std::string(field) + "' property of a JSON patch operation should be a string");
+    }
+    return value->get_string();
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Apply a JSON merge patch, as described in RFC 7386.
+ * Only the containers along the modified paths are copied, while all unmodified subtrees are shared with `document`.
+ * Similarly, values in the result may be shared with `patch`.
+ * Callers should avoid modifying any shared values in-place, e.g., with the non-`const` `Base::get_object()`.
+ *
+ * @param document The original JSON document.
+ * @param patch The merge patch.
+ * @return The patched document.
+ */
+inline std::shared_ptr<Base> merge_patch(const std::shared_ptr<Base>& document, const std::shared_ptr<Base>& patch) {
+    if (patch->type() != OBJECT) {
+        return patch;
+    }
+
+    std::shared_ptr<Base> output;
+    if (document && document->type() == OBJECT) {
+        output = shallow_copy(document);
+    } else {
+        output.reset(new Object);
+    }
+
+    auto& values = output->get_object();
+    for (const auto& x : patch->get_object()) {
+        if (x.second->type() == NOTHING) {
+            values.erase(x.first);
+            continue;
+        }
+
+        auto it = values.find(x.first);
+        if (it == values.end()) {
+            values[x.first] = merge_patch(nullptr, x.second);
+        } else {
+            it->second = merge_patch(it->second, x.second);
+        }
+    }
+
+    return output;
+}
+
+/**
+ * Apply a JSON patch, as described in RFC 6902.
+ * Only the containers along the modified paths are copied, while all unmodified subtrees are shared with `document`.
+ * Values added by the patch, as well as copied or moved values, are also shared rather than deep-copied.
+ * Callers should avoid modifying any shared values in-place, e.g., with the non-`const` `Base::get_object()`.
+ *
+ * @param document The original JSON document.
+ * @param patch Array of patch operations.
+ * @return The patched document.
+ * An error is raised if any operation fails, in which case `document` is left unchanged.
+ */
+inline std::shared_ptr<Base> apply_patch(const std::shared_ptr<Base>& document, const Base& patch) {
+    if (patch.type() != ARRAY) {
+        throw std::runtime_error("JSON patch should be an array of operations");
+    }
+
+    auto current = document;
+    for (const auto& operation : patch.get_array()) {
+        if (operation->type() != OBJECT) {
+            throw std::runtime_error("JSON patch operation should be an object");
+        }
+
+        const auto& op = patch_string_field(*operation, "op");
+        auto path = split_pointer(patch_string_field(*operation, "path"));
+
+        if (op == "add") {
+            current = patch_add(current, path, patch_field(*operation, "value"));
+
+        } else if (op == "remove") {
+            current = patch_remove(current, path);
+
+        } else if (op == "replace") {
+            patch_get(current, path); // check that it exists.
+            if (path.empty()) {
+                current = patch_field(*operation, "value");
+            } else {
+                current = patch_add(patch_remove(current, path), path, patch_field(*operation, "value"));
+            }
+
+        } else if (op == "move") {
+            const auto& from_string = patch_string_field(*operation, "from");
+            auto from = split_pointer(from_string);
+            if (from.size() < path.size() && std::equal(from.begin(), from.end(), path.begin())) {
+                throw std::runtime_error("cannot move '" + from_string + "' into one of its children");
+            }
+            auto value = patch_get(current, from);
+            if (from != path) {
+                current = patch_add(patch_remove(current, from), path, std::move(value));
+            }
+
+        } else if (op == "copy") {
+            auto value = patch_get(current, split_pointer(patch_string_field(*operation, "from")));
+            current = patch_add(current, path, std::move(value));
+
+        } else if (op == "test") {
+            if (!equal(*patch_get(current, path), *patch_field(*operation, "value"))) {
+                throw std::runtime_error("JSON patch test failed for '" + patch_string_field(*operation, "path") + "'");
+            }
+
+        } else {
+            throw std::runtime_error("unknown JSON patch operation '" + op + "'");
+        }
+    }
+
+    return current;
+}
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef MILLIJSON_PROFILE_HPP
+#define MILLIJSON_PROFILE_HPP
+
+#include "millijson.hpp"
+
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * @file profile.hpp
+ * @brief Profile the contents of a JSON document.
+ */
+
+namespace millijson {
+
+/**
+ * @cond
+ */
+inline size_t string_footprint(const std::string& x) {
+    // Short strings are stored inline without a separate heap allocation.
+    const char* start = reinterpret_cast<const char*>(&x);
+    if (x.data() >= start && x.data() < start + sizeof(std::string)) {
+        return 0;
+    }
+    return x.capacity() + 1;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Estimate the memory used by a parsed JSON value and all of its children.
+ * This includes the nodes themselves, the control blocks of their `std::shared_ptr`s, and the heap storage of strings, vectors and hash tables.
+ * The estimate is necessarily approximate as it depends on the standard library implementation and the allocator.
+ *
+ * @param value A JSON value.
+ * @return Approximate number of bytes used by `value`.
+ */
+inline size_t memory_footprint(const Base& value) {
+    constexpr size_t control_block = 3 * sizeof(void*);
+
+    switch (value.type()) {
+        case NUMBER:
+            return sizeof(Number) + control_block;
+        case BOOLEAN:
+            return sizeof(Boolean) + control_block;
+        case NOTHING:
+            return sizeof(Nothing) + control_block;
+        case STRING:
+            return sizeof(String) + control_block + string_footprint(value.get_string());
+        case ARRAY:
+            {
+                const auto& array = value.get_array();
+                size_t output = sizeof(Array) + control_block + array.capacity() * sizeof(std::shared_ptr<Base>);
+                for (const auto& x : array) {
+                    output += memory_footprint(*x);
+                }
+                return output;
+            }
+        case OBJECT:
+            {
+                const auto& object = value.get_object();
+                typedef typename std::remove_reference<decltype(object)>::type::value_type Entry;
+                size_t output = sizeof(Object) + control_block + object.bucket_count() * sizeof(void*);
+                for (const auto& x : object) {
+                    // Each entry is stored in a node with a 'next' pointer and a cached hash.
+                    output += sizeof(Entry) + sizeof(void*) + sizeof(size_t) + string_footprint(x.first);
+                    output += memory_footprint(*(x.second));
+                }
+                return output;
+            }
+    }
+
+    return 0; // Technically unreachable, but whatever.
+}
+
+/**
+ * @brief Summary statistics for a JSON document.
+ */
+struct Profile {
+    /**
+     * Total size of the document in bytes.
+     */
+    size_t bytes = 0;
+
+    /**
+     * Number of numbers.
+     */
+    size_t numbers = 0;
+
+    /**
+     * Number of strings, not including object keys.
+     */
+    size_t strings = 0;
+
+    /**
+     * Number of booleans.
+     */
+    size_t booleans = 0;
+
+    /**
+     * Number of nulls.
+     */
+    size_t nothings = 0;
+
+    /**
+     * Number of arrays.
+     */
+    size_t arrays = 0;
+
+    /**
+     * Number of objects.
+     */
+    size_t objects = 0;
+
+    /**
+     * Number of object keys.
+     */
+    size_t keys = 0;
+
+    /**
+     * Maximum nesting depth of arrays and objects.
+     * This is zero if the document only contains a scalar.
+     */
+    size_t max_depth = 0;
+
+    /**
+     * Number of bytes in strings and object keys, including the quotes.
+     */
+    size_t string_bytes = 0;
+
+    /**
+     * Number of bytes in numbers.
+     */
+    size_t number_bytes = 0;
+
+    /**
+     * Number of whitespace bytes outside of strings.
+     */
+    size_t whitespace_bytes = 0;
+
+    /**
+     * Number of escape sequences in strings and object keys.
+     */
+    size_t escapes = 0;
+
+    /**
+     * Approximate memory used by the parsed document, see `memory_footprint()`.
+     */
+    size_t dom_bytes = 0;
+};
+
+/**
+ * @cond
+ */
+inline void profile_value(const Base& value, size_t depth, Profile& output) {
+    switch (value.type()) {
+        case NUMBER:
+            ++output.numbers;
+            break;
+        case STRING:
+            ++output.strings;
+            break;
+        case BOOLEAN:
+            ++output.booleans;
+            break;
+        case NOTHING:
+            ++output.nothings;
+            break;
+        case ARRAY:
+            ++output.arrays;
+            output.max_depth = std::max(output.max_depth, depth + 1);
+            for (const auto& x : value.get_array()) {
+                profile_value(*x, depth + 1, output);
+            }
+            break;
+        case OBJECT:
+            ++output.objects;
+            output.max_depth = std::max(output.max_depth, depth + 1);
+            output.keys += value.get_object().size();
+            for (const auto& x : value.get_object()) {
+                profile_value(*(x.second), depth + 1, output);
+            }
+            break;
+    }
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @return Summary statistics for the JSON document.
+ * An error is raised if the JSON string is invalid.
+ */
+inline Profile profile_string(const char* ptr, size_t len) {
+    Profile output;
+    output.bytes = len;
+
+    auto parsed = parse_string(ptr, len);
+    profile_value(*parsed, 0, output);
+    output.dom_bytes = memory_footprint(*parsed);
+
+    // Lexical scan, which is simple as we already know that the document is valid.
+    bool in_string = false, in_number = false;
+    for (size_t i = 0; i < len; ++i) {
+        char x = ptr[i];
+        if (in_string) {
+            ++output.string_bytes;
+            if (x == '\\') {
+                ++output.escapes;
+                ++output.string_bytes;
+                ++i;
+            } else if (x == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+
+        if (in_number) {
+            if ((x >= '0' && x <= '9') || x == '.' || x == 'e' || x == 'E' || x == '+' || x == '-') {
+                ++output.number_bytes;
+                continue;
+            }
+            in_number = false;
+        }
+
+        if (x == '"') {
+            in_string = true;
+            ++output.string_bytes;
+        } else if ((x >= '0' && x <= '9') || x == '-') {
+            in_number = true;
+            ++output.number_bytes;
+        } else if (isspace(x)) {
+            ++output.whitespace_bytes;
+        }
+    }
+
+    return output;
+}
+
+}
+
+#endif
@@ -0,0 +1,598 @@
+#ifndef MILLIJSON_REWRITE_HPP
+#define MILLIJSON_REWRITE_HPP
+
+#include "millijson.hpp"
+#include "patch.hpp"
+#include "serialize.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @file rewrite.hpp
+ * @brief Streaming edits of JSON documents at specific paths.
+ */
+
+namespace millijson {
+
+/**
+ * Type of edit in a `Rewrite`.
+ */
+enum class RewriteType {
+    REPLACE,
+    REMOVE,
+    INSERT
+};
+
+/**
+ * @brief Edit at a specific path of a JSON document.
+ */
+struct Rewrite {
+    /**
+     * Type of the edit.
+     */
+    RewriteType type;
+
+    /**
+     * JSON pointer to the target location.
+     * For `RewriteType::REPLACE` and `RewriteType::REMOVE`, this should refer to an existing value.
+     * For `RewriteType::INSERT`, the parent should be an existing array or object:
+     *
+     * - For arrays, the last token should be an index at which to insert the new value, or `-` to append it to the end of the array.
+     *   Indices refer to the original array, i.e., before any other edits.
+     * - For objects, the last token should be a key that does not already exist in the object.
+     *   The new entry is appended to the end of the object.
+     */
+    std::string path;
+
+    /**
+     * JSON string containing the new value for `RewriteType::REPLACE` and `RewriteType::INSERT`.
+     * Ignored for `RewriteType::REMOVE`.
+     */
+    std::string value;
+};
+
+/**
+ * @cond
+ */
+struct RewriteNode {
+    const Rewrite* operation = nullptr; // replacement or removal of this node.
+    bool applied = false;
+    std::map<std::string, RewriteNode> children;
+    std::map<std::string, std::vector<const Rewrite*> > inserts; // keyed by the last token of the path.
+    bool inserted = false;
+};
+
+inline RewriteNode build_rewrite_tree(const std::vector<Rewrite>& operations) {
+    RewriteNode root;
+    for (const auto& op : operations) {
+        if (op.type != RewriteType::REMOVE) {
+            validate_string(op.value.c_str(), op.value.size()); // just to check that it's valid before we start writing.
+        }
+
+        auto tokens = split_pointer(op.path);
+        size_t ndescend = tokens.size();
+        if (op.type == RewriteType::INSERT) {
+            if (tokens.empty()) {
+                throw std::runtime_error("cannot insert at the root of the document");
+            }
+            --ndescend;
+        } else if (op.type == RewriteType::REMOVE && tokens.empty()) {
+            throw std::runtime_error("cannot remove the root of the document");
+        }
+
+        RewriteNode* current = &root;
+        for (size_t i = 0; i < ndescend; ++i) {
+            if (current->operation) {
+                throw std::runtime_error("conflicting edits for '" + op.path + "' and '" + current->operation->path + "'");
+            }
+            current = &(current->children[tokens[i]]);
+        }
+
+        if (op.type == RewriteType::INSERT) {
+            if (current->operation) {
+                throw std::runtime_error("conflicting edits for '" + op.path + "' and '" + current->operation->path + "'");
+            }
+            current->inserts[tokens.back()].push_back(&op);
+        } else {
+            if (current->operation || !current->children.empty() || !current->inserts.empty()) {
+                throw std::runtime_error("conflicting edits for '" + op.path + "' and other edits at or below the same path");
+            }
+            current->operation = &op;
+        }
+    }
+    return root;
+}
+
+template<class Input, class Writer_>
+class Rewriter {
+public:
+    Rewriter(Input& input, Writer_& writer, size_t buffer_size) : my_input(input), my_writer(writer), my_buffer_size(buffer_size) {
+        my_buffer.reserve(buffer_size);
+    }
+
+    void run(RewriteNode& root) {
+        copy_whitespace();
+        if (!my_input.valid()) {
+            throw std::runtime_error("no JSON value found at position 1");
+        }
+        value(root);
+        copy_whitespace();
+        if (my_input.valid()) {
+            throw std::runtime_error("invalid json with trailing non-space characters at position " + std::to_string(my_input.position() + 1));
+        }
+        flush();
+        check_applied(root);
+    }
+
+private:
+    Input& my_input;
+    Writer_& my_writer;
+    size_t my_buffer_size;
+
+    std::string my_buffer;
+    bool my_copy = true; // whether consumed bytes are copied into the buffer.
+    bool my_hold = false; // whether the buffer must not be flushed, as we might still modify it.
+
+    // Input adaptor so that bytes consumed by extract_string() are also copied.
+    struct Tee {
+        Rewriter& parent;
+        char get() const { return parent.my_input.get(); }
+        bool valid() const { return parent.my_input.valid(); }
+        bool advance() { return parent.advance(); }
+        size_t position() const { return parent.my_input.position(); }
+    };
+
+    void flush() {
+        if (!my_buffer.empty()) {
+            my_writer(my_buffer.data(), my_buffer.size());
+            my_buffer.clear();
+        }
+    }
+
+    bool advance() {
+        if (my_copy) {
+            my_buffer += my_input.get();
+            if (!my_hold && my_buffer.size() >= my_buffer_size) {
+                flush();
+            }
+        }
+        return my_input.advance();
+    }
+
+    // Same as advance(), but for a block of 'n' bytes from current(), where 0 < n <= remaining().
+    bool advance_block(size_t n) {
+        if (my_copy) {
+            my_buffer.append(my_input.current(), n);
+            if (!my_hold && my_buffer.size() >= my_buffer_size) {
+                flush();
+            }
+        }
+        return my_input.skip(n);
+    }
+
+    void copy_whitespace() {
+        bool ok = my_input.valid();
+        if constexpr(has_bulk_access<Input>::value) {
+            while (ok && isspace(my_input.get())) {
+                ok = advance_block(skip_whitespace(my_input.current(), my_input.remaining()));
+            }
+        } else {
+            while (ok && isspace(my_input.get())) {
+                ok = advance();
+            }
+        }
+    }
+
+    static bool is_structural(char x) {
+        return x == '"' || x == '[' || x == ']' || x == '{' || x == '}';
+    }
+
+    void check_unterminated(char open, size_t start) const {
+        if (!my_input.valid()) {
+            throw std::runtime_error(std::string("unterminated ") + (open == '[' ? "array" : "object") + " starting at position " + std::to_string(start));
+        }
+    }
+
+    /*
+     * For untargeted values, we only check that brackets and quotes are balanced,
+     * without any of the other validation or allocations of the full parser.
+     */
+    void skim_string() {
+        size_t start = my_input.position() + 1;
+        advance(); // get past the opening quote.
+        while (my_input.valid()) {
+            if constexpr(has_bulk_access<Input>::value) {
+                size_t run = find_special(my_input.current(), my_input.remaining());
+                if (run) {
+                    advance_block(run);
+                    continue;
+                }
+            }
+
+            char next = my_input.get();
+            if (next == '"') {
+                advance();
+                return;
+            }
+            if (next == '\\' && !advance()) {
+                break;
+            }
+            advance();
+        }
+        throw std::runtime_error("unterminated string at position " + std::to_string(start));
+    }
+
+    void skim() {
+        char current = my_input.get();
+        if (current == '"') {
+            skim_string();
+            return;
+        }
+
+        if (current != '[' && current != '{') {
+            size_t start = my_input.position() + 1;
+            bool ok = true;
+            while (ok) {
+                char next = my_input.get();
+                if (next == ',' || next == ']' || next == '}' || isspace(next)) {
+                    break;
+                }
+                ok = advance();
+            }
+            if (my_input.position() + 1 == start && ok) {
+                throw std::runtime_error(std::string("unknown type starting with '") + std::string(1, current) + "' at position " + std::to_string(start));
+            }
+            return;
+        }
+
+        std::vector<char> stack;
+        std::vector<size_t> starts;
+        while (1) {
+            if constexpr(has_bulk_access<Input>::value) {
+                // Copying runs of non-structural bytes in blocks, once we're inside the array/object.
+                if (!stack.empty()) {
+                    const char* ptr = my_input.current();
+                    size_t len = my_input.remaining(), run = 0;
+                    while (run < len && !is_structural(ptr[run])) {
+                        ++run;
+                    }
+                    if (run) {
+                        advance_block(run);
+                        check_unterminated(stack.back(), starts.back());
+                        continue;
+                    }
+                }
+            }
+
+            char next = my_input.get();
+            if (next == '"') {
+                skim_string();
+            } else {
+                if (next == '[' || next == '{') {
+                    stack.push_back(next);
+                    starts.push_back(my_input.position() + 1);
+                } else if (next == ']' || next == '}') {
+                    if (stack.back() != (next == ']' ? '[' : '{')) {
+                        throw std::runtime_error("mismatched '" + std::string(1, next) + "' at position " + std::to_string(my_input.position() + 1));
+                    }
+                    stack.pop_back();
+                    starts.pop_back();
+                    if (stack.empty()) {
+                        advance();
+                        return;
+                    }
+                }
+                advance();
+            }
+            check_unterminated(stack.back(), starts.back());
+        }
+    }
+
+    void drop() {
+        my_copy = false;
+        skim();
+        my_copy = true;
+    }
+
+    void value(RewriteNode& node) {
+        if (node.operation) {
+            drop();
+            my_buffer += node.operation->value;
+            node.applied = true;
+            return;
+        }
+
+        if (node.children.empty() && node.inserts.empty()) {
+            skim();
+            return;
+        }
+
+        char current = my_input.get();
+        if (current == '[') {
+            array(node);
+        } else if (current == '{') {
+            object(node);
+        } else {
+            skim(); // targets don't exist, which will be reported by check_applied().
+        }
+    }
+
+    /*
+     * Each entry is preceded by a segment of whitespace, a comma and possibly a key.
+     * Segments are held in the buffer until we know whether the entry is retained;
+     * commas are not copied from the input but are added back for retained entries, to simplify removals.
+     */
+    struct Segment {
+        size_t mark;
+        size_t retained = 0;
+        bool first = true;
+        std::string indent, first_indent;
+    };
+
+    bool start_segment(Segment& seg, char open, size_t start, bool first) {
+        seg.mark = my_buffer.size();
+        my_hold = true;
+        copy_whitespace();
+        check_unterminated(open, start);
+
+        char next = my_input.get();
+        if (next == (open == '[' ? ']' : '}')) {
+            return false;
+        }
+
+        if (!first) {
+            if (next != ',') {
+                throw std::runtime_error("unknown character '" + std::string(1, next) + "' in " + (open == '[' ? "array" : "object") + " at position " + std::to_string(my_input.position() + 1));
+            }
+            my_copy = false;
+            my_input.advance();
+            my_copy = true;
+            copy_whitespace();
+            check_unterminated(open, start);
+        }
+
+        seg.indent = my_buffer.substr(seg.mark);
+        seg.first = first;
+        if (first) {
+            seg.first_indent = seg.indent;
+        }
+        return true;
+    }
+
+    void insert_all(Segment& seg, const std::vector<const Rewrite*>& values, const std::string* key) {
+        std::string text;
+        for (auto v : values) {
+            if (seg.retained) {
+                text += ',';
+            }
+            text += seg.indent;
+            if (key) {
+                append_string_literal(text, *key);
+                text += ':';
+            }
+            text += v->value;
+            ++seg.retained;
+        }
+        my_buffer.insert(seg.mark, text);
+        seg.mark += text.size();
+    }
+
+    void retain(Segment& seg) {
+        if (seg.retained) {
+            my_buffer.insert(seg.mark, 1, ',');
+        } else if (!seg.first) {
+            // Preceding entries were all removed, so this entry takes the whitespace of the original first entry.
+            my_buffer.replace(seg.mark, seg.indent.size(), seg.first_indent);
+        }
+        ++seg.retained;
+        my_hold = false;
+    }
+
+    void remove(Segment& seg) {
+        my_buffer.resize(seg.mark);
+        my_hold = false;
+    }
+
+    void finish(RewriteNode& node) {
+        advance(); // get past the closing bracket.
+        my_hold = false;
+        node.inserted = true;
+    }
+
+    void array(RewriteNode& node) {
+        size_t start = my_input.position() + 1;
+        advance();
+
+        // Tokens in 'inserts' are either indices or '-'; we need to process them in numeric order.
+        std::map<size_t, std::vector<const Rewrite*>*> positional;
+        std::vector<const Rewrite*>* append = nullptr;
+        for (auto& x : node.inserts) {
+            if (x.first == "-") {
+                append = &(x.second);
+            } else {
+                positional[pointer_index(x.first, static_cast<size_t>(-1))] = &(x.second);
+            }
+        }
+        auto pIt = positional.begin();
+
+        Segment seg;
+        size_t index = 0;
+        while (start_segment(seg, '[', start, index == 0)) {
+            if (pIt != positional.end() && pIt->first == index) {
+                insert_all(seg, *(pIt->second), nullptr);
+                ++pIt;
+            }
+
+            auto cIt = node.children.find(std::to_string(index));
+            if (cIt == node.children.end()) {
+                retain(seg);
+                skim();
+            } else if (cIt->second.operation && cIt->second.operation->type == RewriteType::REMOVE) {
+                remove(seg);
+                drop();
+                cIt->second.applied = true;
+            } else {
+                retain(seg);
+                value(cIt->second);
+            }
+            ++index;
+        }
+
+        // Only an insertion at the original length is allowed after the last element.
+        while (pIt != positional.end()) {
+            if (pIt->first != index) {
+                throw std::runtime_error("cannot insert at index " + std::to_string(pIt->first) + " of an array of length " + std::to_string(index));
+            }
+            insert_all(seg, *(pIt->second), nullptr);
+            ++pIt;
+        }
+        if (append) {
+            insert_all(seg, *append, nullptr);
+        }
+        finish(node);
+    }
+
+    void object(RewriteNode& node) {
+        size_t start = my_input.position() + 1;
+        advance();
+
+        Segment seg;
+        bool first = true;
+        while (start_segment(seg, '{', start, first)) {
+            first = false;
+            if (my_input.get() != '"') {
+                throw std::runtime_error("expected a string as the object key at position " + std::to_string(my_input.position() + 1));
+            }
+
+            Tee tee{ *this };
+            auto key = extract_string(tee);
+
+            if (node.inserts.find(key) != node.inserts.end()) {
+                throw std::runtime_error("cannot insert '" + key + "' as it already exists in the object starting at position " + std::to_string(start));
+            }
+
+            copy_whitespace();
+            check_unterminated('{', start);
+            if (my_input.get() != ':') {
+                throw std::runtime_error("expected ':' to separate keys and values at position " + std::to_string(my_input.position() + 1));
+            }
+            advance();
+            copy_whitespace();
+            check_unterminated('{', start);
+
+            auto cIt = node.children.find(key);
+            if (cIt == node.children.end()) {
+                retain(seg);
+                skim();
+            } else if (cIt->second.operation && cIt->second.operation->type == RewriteType::REMOVE) {
+                remove(seg);
+                drop();
+                cIt->second.applied = true;
+            } else {
+                retain(seg);
+                value(cIt->second);
+            }
+        }
+
+        for (const auto& x : node.inserts) {
+            if (x.second.size() > 1) {
+                throw std::runtime_error("multiple insertions of '" + x.first + "' into the object starting at position " + std::to_string(start));
+            }
+            insert_all(seg, x.second, &(x.first));
+        }
+        finish(node);
+    }
+
+    static void check_applied(const RewriteNode& node) {
+        if (node.operation && !node.applied) {
+            throw std::runtime_error("failed to find '" + node.operation->path + "' in the document");
+        }
+        if (!node.inserts.empty() && !node.inserted) {
+            throw std::runtime_error("failed to find an array or object for '" + node.inserts.begin()->second.front()->path + "' in the document");
+        }
+        for (const auto& child : node.children) {
+            check_applied(child.second);
+        }
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Apply edits at specific paths of a JSON document, streaming the result to a writer.
+ * All bytes outside of the targeted values are copied verbatim from the input to the output, preserving formatting.
+ * Only the arrays and objects on the paths to the targets are parsed;
+ * all other values are scanned for balanced brackets and quotes without being materialized, so edits can be applied to very large documents at close to copy speed.
+ * Note that this means that some invalid JSON outside of the targeted paths may not be detected.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ * @tparam Writer_ Any callable that accepts a `const char*` and a `size_t`, specifying a pointer to a chunk of bytes and its length, respectively.
+ *
+ * @param input Instance of an `Input` class, referring to the bytes of the original document.
+ * @param operations Edits to apply.
+ * Each path may be targeted by at most one replacement or removal, and no edit may target a path inside a replaced or removed value.
+ * @param writer Instance of a `Writer_`.
+ * @param buffer_size Size of the buffer to use for accumulating output before calling `writer`.
+ *
+ * An error is raised if the document is invalid or if any of the targeted paths cannot be found.
+ * In such cases, the writer may have already received some of the output.
+ */
+template<class Input, class Writer_>
+void rewrite(Input& input, const std::vector<Rewrite>& operations, Writer_ writer, size_t buffer_size = 65536) {
+    auto root = build_rewrite_tree(operations);
+    Rewriter<Input, Writer_> rewriter(input, writer, buffer_size);
+    rewriter.run(root);
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param operations Edits to apply, see `rewrite()` for details.
+ * @return String containing the edited JSON document.
+ */
+inline std::string rewrite_string(const char* ptr, size_t len, const std::vector<Rewrite>& operations) {
+    RawReader input(ptr, len);
+    std::string output;
+    rewrite(input, operations, [&](const char* p, size_t n) -> void { output.append(p, n); });
+    return output;
+}
+
+/**
+ * @param[in] input_path Path to the input JSON file.
+ * @param[in] output_path Path to the output file.
+ * This should be different from `input_path`.
+ * @param operations Edits to apply, see `rewrite()` for details.
+ * @param buffer_size Size of the buffers to use for reading and writing.
+ */
+inline void rewrite_file(const char* input_path, const char* output_path, const std::vector<Rewrite>& operations, size_t buffer_size = 65536) {
+    FileReader input(input_path, buffer_size);
+    FILE* handle = std::fopen(output_path, "wb");
+    if (!handle) {
+        throw std::runtime_error("failed to open file at '" + std::string(output_path) + "'");
+    }
+
+    try {
+        rewrite(input, operations, [&](const char* ptr, size_t len) -> void {
+            if (std::fwrite(ptr, sizeof(char), len, handle) != len) {
+                throw std::runtime_error("failed to write to file at '" + std::string(output_path) + "'");
+            }
+        }, buffer_size);
+    } catch (...) {
+        std::fclose(handle);
+        throw;
+    }
+
+    if (std::fclose(handle)) {
+        throw std::runtime_error("failed to close file at '" + std::string(output_path) + "'");
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef MILLIJSON_SCHEMA_HPP
+#define MILLIJSON_SCHEMA_HPP
+
+#include "millijson.hpp"
+#include "events.hpp"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file schema.hpp
+ * @brief Infer the schema of JSON documents.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Summary of the values observed at a single path across documents.
+ *
+ * All elements of an array are summarized by a single `items` node,
+ * while each object key has its own node in `properties`.
+ */
+struct SchemaNode {
+    /**
+     * @cond
+     */
+    SchemaNode() = default;
+    SchemaNode(SchemaNode&&) = default;
+    SchemaNode& operator=(SchemaNode&&) = default;
+    /**
+     * @endcond
+     */
+
+    /**
+     * Total number of values observed at this path.
+     * For a child of an object, this is the number of times that the key was present.
+     */
+    size_t count = 0;
+
+    /**
+     * Number of numbers.
+     */
+    size_t numbers = 0;
+
+    /**
+     * Number of numbers with integer values.
+     */
+    size_t integers = 0;
+
+    /**
+     * Number of strings.
+     */
+    size_t strings = 0;
+
+    /**
+     * Number of booleans.
+     */
+    size_t booleans = 0;
+
+    /**
+     * Number of nulls.
+     */
+    size_t nulls = 0;
+
+    /**
+     * Number of arrays.
+     */
+    size_t arrays = 0;
+
+    /**
+     * Number of objects.
+     */
+    size_t objects = 0;
+
+    /**
+     * Smallest number, or positive infinity if `numbers = 0`.
+     */
+    double min_number = std::numeric_limits<double>::infinity();
+
+    /**
+     * Largest number, or negative infinity if `numbers = 0`.
+     */
+    double max_number = -std::numeric_limits<double>::infinity();
+
+    /**
+     * Smallest string length in bytes, or the maximum `size_t` if `strings = 0`.
+     */
+    size_t min_length = static_cast<size_t>(-1);
+
+    /**
+     * Largest string length in bytes.
+     */
+    size_t max_length = 0;
+
+    /**
+     * Total length of all strings in bytes.
+     */
+    size_t total_length = 0;
+
+    /**
+     * Distribution of string lengths.
+     * The first bucket counts empty strings, and each subsequent bucket `i` counts strings with lengths in \f$[2^{i-1}, 2^i)\f$.
+     */
+    std::array<size_t, 8 * sizeof(size_t) + 1> length_buckets{};
+
+    /**
+     * Smallest number of elements in an array, or the maximum `size_t` if `arrays = 0`.
+     */
+    size_t min_items = static_cast<size_t>(-1);
+
+    /**
+     * Largest number of elements in an array.
+     */
+    size_t max_items = 0;
+
+    /**
+     * Summary of all array elements, or NULL if no elements were observed.
+     */
+    std::unique_ptr<SchemaNode> items;
+
+    /**
+     * Summary of the values for each object key.
+     * The frequency of each key is given by the `count` of its child node, relative to `objects`.
+     */
+    std::map<std::string, std::unique_ptr<SchemaNode> > properties;
+
+    /**
+     * Add the statistics from another node into this node.
+     * @param other Node to be merged.
+     */
+    void merge(const SchemaNode& other) {
+        count += other.count;
+        numbers += other.numbers;
+        integers += other.integers;
+        strings += other.strings;
+        booleans += other.booleans;
+        nulls += other.nulls;
+        arrays += other.arrays;
+        objects += other.objects;
+
+        min_number = std::min(min_number, other.min_number);
+        max_number = std::max(max_number, other.max_number);
+        min_length = std::min(min_length, other.min_length);
+        max_length = std::max(max_length, other.max_length);
+        total_length += other.total_length;
+        for (size_t b = 0; b < length_buckets.size(); ++b) {
+            length_buckets[b] += other.length_buckets[b];
+        }
+        min_items = std::min(min_items, other.min_items);
+        max_items = std::max(max_items, other.max_items);
+
+        if (other.items) {
+            if (!items) {
+                items.reset(new SchemaNode);
+            }
+            items->merge(*(other.items));
+        }
+        for (const auto& x : other.properties) {
+            auto& current = properties[x.first];
+            if (!current) {
+                current.reset(new SchemaNode);
+            }
+            current->merge(*(x.second));
+        }
+    }
+};
+
+/**
+ * @cond
+ */
+inline size_t length_bucket(size_t len) {
+    size_t b = 0;
+    while (len) {
+        ++b;
+        len >>= 1;
+    }
+    return b;
+}
+
+template<class Reader>
+void infer_value(Reader& reader, Event current, SchemaNode& node) {
+    ++node.count;
+    switch (current) {
+        case Event::NUMBER:
+            {
+                ++node.numbers;
+                double x = reader.get_number();
+                if (std::floor(x) == x) {
+                    ++node.integers;
+                }
+                node.min_number = std::min(node.min_number, x);
+                node.max_number = std::max(node.max_number, x);
+            }
+            break;
+        case Event::STRING:
+            {
+                ++node.strings;
+                size_t len = reader.get_string().size();
+                node.min_length = std::min(node.min_length, len);
+                node.max_length = std::max(node.max_length, len);
+                node.total_length += len;
+                ++node.length_buckets[length_bucket(len)];
+            }
+            break;
+        case Event::BOOLEAN:
+            ++node.booleans;
+            break;
+        case Event::NOTHING:
+            ++node.nulls;
+            break;
+        case Event::START_ARRAY:
+            {
+                ++node.arrays;
+                size_t n = 0;
+                while (1) {
+                    auto next = reader.next();
+                    if (next == Event::END_ARRAY) {
+                        break;
+                    }
+                    if (!node.items) {
+                        node.items.reset(new SchemaNode);
+                    }
+                    infer_value(reader, next, *(node.items));
+                    ++n;
+                }
+                node.min_items = std::min(node.min_items, n);
+                node.max_items = std::max(node.max_items, n);
+            }
+            break;
+        case Event::START_OBJECT:
+            ++node.objects;
+            while (reader.next() == Event::KEY) {
+                auto& child = node.properties[reader.get_string()];
+                if (!child) {
+                    child.reset(new SchemaNode);
+                }
+                infer_value(reader, reader.next(), *child);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+inline void add_schema_type(Array& types, const char* name) {
+    types.add(std::shared_ptr<Base>(new String(name)));
+}
+
+inline std::shared_ptr<Base> to_json_schema(const SchemaNode& node) {
+    auto output = new Object;
+    std::shared_ptr<Base> ptr(output);
+
+    auto types = new Array;
+    std::shared_ptr<Base> tptr(types);
+    if (node.nulls) {
+        add_schema_type(*types, "null");
+    }
+    if (node.booleans) {
+        add_schema_type(*types, "boolean");
+    }
+    if (node.numbers) {
+        add_schema_type(*types, node.integers == node.numbers ? "integer" : "number");
+    }
+    if (node.strings) {
+        add_schema_type(*types, "string");
+    }
+    if (node.arrays) {
+        add_schema_type(*types, "array");
+    }
+    if (node.objects) {
+        add_schema_type(*types, "object");
+    }
+    if (types->values.size() == 1) {
+        output->add("type", types->values.front());
+    } else if (types->values.size() > 1) {
+        output->add("type", std::move(tptr));
+    }
+
+    auto add_number = [&](const char* name, double value) -> void {
+        output->add(name, std::shared_ptr<Base>(new Number(value)));
+    };
+
+    if (node.numbers) {
+        add_number("minimum", node.min_number);
+        add_number("maximum", node.max_number);
+    }
+    if (node.strings) {
+        add_number("minLength", node.min_length);
+        add_number("maxLength", node.max_length);
+    }
+    if (node.arrays) {
+        if (node.items) {
+            output->add("items", to_json_schema(*(node.items)));
+        }
+        add_number("minItems", node.min_items);
+        add_number("maxItems", node.max_items);
+    }
+
+    if (node.objects) {
+        auto properties = new Object;
+        output->add("properties", std::shared_ptr<Base>(properties));
+        auto required = new Array;
+        std::shared_ptr<Base> rptr(required);
+        for (const auto& x : node.properties) {
+            properties->add(x.first, to_json_schema(*(x.second)));
+            if (x.second->count == node.objects) {
+                required->add(std::shared_ptr<Base>(new String(x.first)));
+            }
+        }
+        if (!required->values.empty()) {
+            output->add("required", std::move(rptr));
+        }
+    }
+
+    return ptr;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Infer the schema of JSON documents.
+ *
+ * Documents are streamed through an `EventReader` without constructing a DOM, and their values are summarized for each path in a `SchemaNode` tree.
+ * Separate instances can be used for different chunks of records in parallel, and then combined with `merge()`.
+ */
+class SchemaInferrer {
+public:
+    /**
+     * Add a document to the summary.
+     * An error is raised if the document is invalid, in which case the summary may contain a partial contribution from that document.
+     *
+     * @tparam Input Any class that supplies input characters, see `parse()` for details.
+     * @param input Instance of an `Input` class, referring to the bytes of a JSON document.
+     */
+    template<class Input>
+    void add(Input& input) {
+        EventReader<Input> reader(input);
+        infer_value(reader, reader.next(), my_root);
+        reader.next(); // checking for trailing characters.
+        ++my_documents;
+    }
+
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * @param len Length of the array.
+     */
+    void add_string(const char* ptr, size_t len) {
+        RawReader input(ptr, len);
+        add(input);
+    }
+
+    /**
+     * Add each record of a newline-delimited JSON string to the summary.
+     * Empty lines are ignored.
+     *
+     * @param[in] ptr Pointer to an array containing a NDJSON string.
+     * @param len Length of the array.
+     * @return Number of records that were added.
+     */
+    size_t add_ndjson(const char* ptr, size_t len) {
+        size_t start = 0, nrecords = 0;
+        for (size_t i = 0; i <= len; ++i) {
+            if (i < len && ptr[i] != '\n') {
+                continue;
+            }
+            const char* record = ptr + start;
+            size_t rlen = i - start;
+            start = i + 1;
+            if (std::all_of(record, record + rlen, [](char x) -> bool { return isspace(x); })) {
+                continue;
+            }
+            add_string(record, rlen);
+            ++nrecords;
+        }
+        return nrecords;
+    }
+
+    /**
+     * Combine the summary from another instance into this one.
+     * @param other Another instance, typically used for a different chunk of records.
+     */
+    void merge(const SchemaInferrer& other) {
+        my_root.merge(other.my_root);
+        my_documents += other.my_documents;
+    }
+
+public:
+    /**
+     * @return Summary of the root values of all documents.
+     */
+    const SchemaNode& root() const {
+        return my_root;
+    }
+
+    /**
+     * @return Number of documents that were added.
+     */
+    size_t documents() const {
+        return my_documents;
+    }
+
+    /**
+     * Export the summary as a JSON Schema (draft 2020-12).
+     * This reports the observed types, numeric ranges, string lengths and array lengths for each path.
+     * Object keys that were present in every observed object are listed as required.
+     *
+     * @return JSON object containing the schema.
+     */
+    std::shared_ptr<Base> json_schema() const {
+        auto output = to_json_schema(my_root);
+        static_cast<Object&>(*output).add("$schema", std::shared_ptr<Base>(new String("https://json-schema.org/draft/2020-12/schema")));
+        return output;
+    }
+
+private:
+    SchemaNode my_root;
+    size_t my_documents = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef MILLIJSON_SEGMENTED_HPP
+#define MILLIJSON_SEGMENTED_HPP
+
+#include "millijson.hpp"
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @file segmented.hpp
+ * @brief Segmented storage for very large arrays.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Sequence container with segmented storage.
+ *
+ * Elements are stored in a series of fixed-size blocks, accessed via a small index of blocks.
+ * The first block grows like a `std::vector` until it reaches the block size, so small sequences have no extra overhead;
+ * beyond that, each new block is allocated once at its full size and existing elements are never moved.
+ * This avoids the transient doubling of memory and the large contiguous allocations of a `std::vector` with tens of millions of elements.
+ *
+ * @tparam Type_ Type of the elements.
+ */
+template<typename Type_>
+class SegmentedVector {
+public:
+    /**
+     * @param block_size Number of elements in each block.
+     * This should be positive.
+     */
+    SegmentedVector(size_t block_size = 65536) : my_block_size(block_size) {
+        if (my_block_size == 0) {
+            throw std::runtime_error("block size should be positive");
+        }
+    }
+
+public:
+    /**
+     * @param value Value to append to the sequence.
+     */
+    void push_back(Type_ value) {
+        if (my_blocks.empty() || my_blocks.back().size() == my_block_size) {
+            my_blocks.emplace_back();
+            if (my_blocks.size() > 1) {
+                my_blocks.back().reserve(my_block_size);
+            }
+        }
+        my_blocks.back().push_back(std::move(value));
+        ++my_size;
+    }
+
+    /**
+     * @param i Index of the element, less than `size()`.
+     * @return Reference to the element.
+     */
+    Type_& operator[](size_t i) {
+        return my_blocks[i / my_block_size][i % my_block_size];
+    }
+
+    /**
+     * @param i Index of the element, less than `size()`.
+     * @return Const reference to the element.
+     */
+    const Type_& operator[](size_t i) const {
+        return my_blocks[i / my_block_size][i % my_block_size];
+    }
+
+    /**
+     * @return Reference to the last element.
+     * This should only be called if `size()` is positive.
+     */
+    Type_& back() {
+        return my_blocks.back().back();
+    }
+
+    /**
+     * @return Number of elements.
+     */
+    size_t size() const {
+        return my_size;
+    }
+
+    /**
+     * @return Whether there are no elements.
+     */
+    bool empty() const {
+        return my_size == 0;
+    }
+
+    /**
+     * Remove all elements and release the storage.
+     */
+    void clear() {
+        my_blocks.clear();
+        my_size = 0;
+    }
+
+public:
+    /**
+     * @return Number of elements in each block.
+     */
+    size_t block_size() const {
+        return my_block_size;
+    }
+
+    /**
+     * @return Number of blocks that are currently allocated.
+     */
+    size_t num_blocks() const {
+        return my_blocks.size();
+    }
+
+    /**
+     * @param b Index of the block, less than `num_blocks()`.
+     * @return Elements in the block.
+     * Iterating over blocks is faster than iterating over individual elements.
+     */
+    const std::vector<Type_>& block(size_t b) const {
+        return my_blocks[b];
+    }
+
+    /**
+     * Move all elements into a single contiguous vector, releasing each block as soon as its elements are moved.
+     * This object is empty on return.
+     *
+     * @return Vector of elements, allocated once at its exact size.
+     */
+    std::vector<Type_> release() {
+        std::vector<Type_> output;
+        output.reserve(my_size);
+        for (auto& b : my_blocks) {
+            for (auto& x : b) {
+                output.push_back(std::move(x));
+            }
+            std::vector<Type_>().swap(b);
+        }
+        clear();
+        return output;
+    }
+
+public:
+    /**
+     * @brief Iterator over the elements of a `SegmentedVector`.
+     * @tparam Const_ Whether to provide read-only access.
+     */
+    template<bool Const_>
+    class Iterator {
+    public:
+        /**
+         * @cond
+         */
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Type_ value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const_, const Type_*, Type_*>::type pointer;
+        typedef typename std::conditional<Const_, const Type_&, Type_&>::type reference;
+        typedef typename std::conditional<Const_, const SegmentedVector*, SegmentedVector*>::type parent_pointer;
+
+        Iterator(parent_pointer parent, size_t block, size_t offset) : my_parent(parent), my_block(block), my_offset(offset) {}
+
+        reference operator*() const {
+            return my_parent->my_blocks[my_block][my_offset];
+        }
+
+        pointer operator->() const {
+            return &(**this);
+        }
+
+        Iterator& operator++() {
+            ++my_offset;
+            if (my_offset == my_parent->my_blocks[my_block].size()) {
+                ++my_block;
+                my_offset = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++(*this);
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return my_block == other.my_block && my_offset == other.my_offset;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+        /**
+         * @endcond
+         */
+
+    private:
+        parent_pointer my_parent;
+        size_t my_block, my_offset;
+    };
+
+    /**
+     * @return Iterator to the first element.
+     */
+    Iterator<false> begin() {
+        return Iterator<false>(this, 0, 0);
+    }
+
+    /**
+     * @return Iterator to one past the last element.
+     */
+    Iterator<false> end() {
+        return Iterator<false>(this, my_blocks.size(), 0);
+    }
+
+    /**
+     * @return Const iterator to the first element.
+     */
+    Iterator<true> begin() const {
+        return Iterator<true>(this, 0, 0);
+    }
+
+    /**
+     * @return Const iterator to one past the last element.
+     */
+    Iterator<true> end() const {
+        return Iterator<true>(this, my_blocks.size(), 0);
+    }
+
+private:
+    size_t my_block_size;
+    size_t my_size = 0;
+    std::vector<std::vector<Type_> > my_blocks;
+};
+
+/**
+ * Parse a JSON document containing a top-level array, storing its elements in a `SegmentedVector`.
+ * This is intended for very large arrays where the usual `Array` would require a single huge allocation.
+ * Each element is parsed into a regular JSON value.
+ *
+ * @tparam Input Any class that supplies input characters, see `parse()` for details.
+ *
+ * @param input An instance of an `Input` class, referring to the bytes from a JSON-formatted file or string.
+ * @param block_size Number of elements in each block of the output, see `SegmentedVector` for details.
+ * Storage only becomes segmented for arrays longer than this.
+ *
+ * @return Elements of the top-level array.
+ * An error is raised if the document is invalid or does not contain an array.
+ */
+template<class Input>
+SegmentedVector<std::shared_ptr<Base> > parse_array_segmented(Input& input, size_t block_size = 65536) {
+    SegmentedVector<std::shared_ptr<Base> > output(block_size);
+    DefaultProvisioner provisioner;
+
+    chomp(input);
+    if (!input.valid() || input.get() != '[') {
+        throw std::runtime_error("expected a top-level array at position " + std::to_string(input.position() + 1));
+    }
+    size_t start = input.position() + 1;
+
+    input.advance();
+    chomp(input);
+    if (!input.valid()) {
+        throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+    }
+
+    if (input.get() != ']') {
+        while (1) {
+            output.push_back(parse_thing(input, provisioner, 1));
+
+            chomp(input);
+            if (!input.valid()) {
+                throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+            }
+
+            char next = input.get();
+            if (next == ']') {
+                break;
+            } else if (next != ',') {
+                throw std::runtime_error("unknown character '" + std::string(1, next) + "' in array at position " + std::to_string(input.position() + 1));
+            }
+
+            input.advance();
+            chomp(input);
+            if (!input.valid()) {
+                throw std::runtime_error("unterminated array starting at position " + std::to_string(start));
+            }
+        }
+    }
+
+    input.advance(); // skip the closing bracket.
+    chomp(input);
+    if (input.valid()) {
+        throw std::runtime_error("invalid json with trailing non-space characters at position " + std::to_string(input.position() + 1));
+    }
+
+    return output;
+}
+
+/**
+ * @param[in] ptr Pointer to an array containing a JSON string.
+ * @param len Length of the array.
+ * @param block_size Number of elements in each block of the output.
+ * @return Elements of the top-level array, see `parse_array_segmented()` for details.
+ */
+inline SegmentedVector<std::shared_ptr<Base> > parse_string_segmented(const char* ptr, size_t len, size_t block_size = 65536) {
+    RawReader input(ptr, len);
+    return parse_array_segmented(input, block_size);
+}
+
+/**
+ * @param[in] path Pointer to an array containing a path to a JSON file.
+ * @param block_size Number of elements in each block of the output.
+ * @param buffer_size Size of the buffer to use for reading the file.
+ * @return Elements of the top-level array, see `parse_array_segmented()` for details.
+ */
+inline SegmentedVector<std::shared_ptr<Base> > parse_file_segmented(const char* path, size_t block_size = 65536, size_t buffer_size = 65536) {
+    FileReader input(path, buffer_size);
+    return parse_array_segmented(input, block_size);
+}
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef MILLIJSON_SERIALIZE_HPP
+#define MILLIJSON_SERIALIZE_HPP
+
+#include "millijson.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * @file serialize.hpp
+ * @brief Serialize JSON values to strings.
+ */
+
+namespace millijson {
+
+/**
+ * @cond
+ */
+inline void append_number(std::string& output, double x) {
+    if (!std::isfinite(x)) {
+        throw std::runtime_error("cannot serialize a non-finite number");
+    }
+
+    // Using the shortest representation that round-trips.
+    // This is independent of the current locale, unlike printf(), which would use a comma as the decimal separator in some locales.
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), x);
+    output.append(buf, res.ptr);
+}
+
+inline void append_string_literal(std::string& output, const std::string& x) {
+    output += '"';
+    for (auto c : x) {
+        switch (c) {
+            case '"': output += "\\\""; break;
+            case '\\': output += "\\\\"; break;
+            case '\n': output += "\\n"; break;
+            case '\r': output += "\\r"; break;
+            case '\t': output += "\\t"; break;
+            case '\b': output += "\\b"; break;
+            case '\f': output += "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    output += buf;
+                } else {
+                    output += c;
+                }
+        }
+    }
+    output += '"';
+}
+
+template<class Writer_>
+class BufferedWriter {
+public:
+    BufferedWriter(Writer_& writer, size_t buffer_size) : my_writer(writer), my_buffer_size(buffer_size) {
+        buffer.reserve(buffer_size);
+    }
+
+    std::string buffer;
+
+    void check() {
+        if (buffer.size() >= my_buffer_size) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (!buffer.empty()) {
+            my_writer(buffer.data(), buffer.size());
+            my_written += buffer.size();
+            buffer.clear();
+        }
+    }
+
+    size_t written() const {
+        return my_written;
+    }
+
+private:
+    Writer_& my_writer;
+    size_t my_buffer_size;
+    size_t my_written = 0;
+};
+
+inline void append_scalar(std::string& output, const Base& value) {
+    switch (value.type()) {
+        case NUMBER:
+            append_number(output, value.get_number());
+            break;
+        case STRING:
+            append_string_literal(output, value.get_string());
+            break;
+        case BOOLEAN:
+            output += (value.get_boolean() ? "true" : "false");
+            break;
+        case NOTHING:
+            output += "null";
+            break;
+        default:
+            break;
+    }
+}
+
+template<class Writer_>
+void serialize_scalar(const Base& value, BufferedWriter<Writer_>& writer) {
+    append_scalar(writer.buffer, value);
+    writer.check();
+}
+
+template<class Writer_>
+void serialize_value(const Base& value, BufferedWriter<Writer_>& writer) {
+    auto type = value.type();
+    if (type == ARRAY) {
+        writer.buffer += '[';
+        bool first = true;
+        for (const auto& x : value.get_array()) {
+            if (!first) {
+                writer.buffer += ',';
+            }
+            first = false;
+            serialize_value(*x, writer);
+        }
+        writer.buffer += ']';
+        writer.check();
+
+    } else if (type == OBJECT) {
+        // Sorting keys for deterministic output, as the iteration order depends on the (random) hash seed.
+        const auto& object = value.get_object();
+        std::vector<const std::pair<const std::string, std::shared_ptr<Base> >*> entries;
+        entries.reserve(object.size());
+        for (const auto& x : object) {
+            entries.push_back(&x);
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto* left, const auto* right) -> bool { return left->first < right->first; });
+
+        writer.buffer += '{';
+        bool first = true;
+        for (auto x : entries) {
+            if (!first) {
+                writer.buffer += ',';
+            }
+            first = false;
+            append_string_literal(writer.buffer, x->first);
+            writer.buffer += ':';
+            serialize_value(*(x->second), writer);
+        }
+        writer.buffer += '}';
+        writer.check();
+
+    } else {
+        serialize_scalar(value, writer);
+    }
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Serialize a JSON value into a compact string, streaming it to a writer in chunks.
+ * Object keys are written in sorted order so that the output is deterministic.
+ * Numbers are written with the shortest representation that parses back to the same value.
+ *
+ * @tparam Writer_ Any callable that accepts a `const char*` and a `size_t`, specifying a pointer to a chunk of bytes and its length, respectively.
+ *
+ * @param value A JSON value.
+ * @param writer Instance of a `Writer_`.
+ * @param buffer_size Size of the buffer to use for accumulating output before calling `writer`.
+ * @return Number of bytes that were written.
+ *
+ * An error is raised if `value` contains non-finite numbers.
+ */
+template<class Writer_>
+size_t serialize(const Base& value, Writer_ writer, size_t buffer_size = 65536) {
+    BufferedWriter<Writer_> buffered(writer, buffer_size);
+    serialize_value(value, buffered);
+    buffered.flush();
+    return buffered.written();
+}
+
+/**
+ * @param value A JSON value.
+ * @return String containing the serialized value, see `serialize()` for details.
+ */
+inline std::string serialize_string(const Base& value) {
+    std::string output;
+    serialize(value, [&](const char* ptr, size_t len) -> void { output.append(ptr, len); });
+    return output;
+}
+
+}
+
+#endif
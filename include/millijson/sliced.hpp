@@ -0,0 +1,200 @@
+#ifndef MILLIJSON_SLICED_HPP
+#define MILLIJSON_SLICED_HPP
+
+#include "millijson.hpp"
+#include "events.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+
+/**
+ * @file sliced.hpp
+ * @brief Resumable parsing of JSON documents in time- or byte-limited slices.
+ */
+
+namespace millijson {
+
+/**
+ * @brief Resumable parser for in-memory JSON documents.
+ *
+ * Parsing is performed in slices via `step()` or `step_for()`, each of which returns control to the caller once its budget is exhausted.
+ * The next call resumes from exactly where the previous slice stopped, so that a large document can be parsed in small slices interleaved with other work,
+ * e.g., on a single-threaded event loop with latency requirements.
+ * The final result is the same as that of `parse_string()`, including the same errors for invalid documents.
+ *
+ * Slices always end on token boundaries, so a single token (e.g., a very long string) is never split across slices.
+ * This means that a slice may exceed its budget by up to the cost of one token.
+ */
+class SlicedParser {
+public:
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * This should remain valid until parsing is complete.
+     * @param len Length of the array.
+     */
+    SlicedParser(const char* ptr, size_t len) : my_input(ptr, len), my_reader(my_input), my_length(len) {}
+
+    /**
+     * @cond
+     */
+    // The reader holds a reference to the input.
+    SlicedParser(const SlicedParser&) = delete;
+    SlicedParser& operator=(const SlicedParser&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * Parse the next slice of the document.
+     * An error is raised if the document is invalid, after which this object should not be used further.
+     *
+     * @param max_bytes Number of bytes to consume in this slice.
+     * Parsing stops at the first token boundary at or after this many bytes.
+     * If zero, only a single token is parsed.
+     *
+     * @return Whether parsing is complete.
+     */
+    bool step(size_t max_bytes) {
+        size_t start = my_input.position();
+        while (!my_done) {
+            process(my_reader.next());
+            if (my_input.position() - start >= max_bytes) {
+                break;
+            }
+        }
+        return my_done;
+    }
+
+    /**
+     * Parse the next slice of the document, stopping once a time budget is exhausted.
+     * An error is raised if the document is invalid, after which this object should not be used further.
+     *
+     * @tparam Rep_ Arithmetic type for the duration, see `std::chrono::duration`.
+     * @tparam Period_ Tick period for the duration, see `std::chrono::duration`.
+     *
+     * @param budget Time budget for this slice.
+     * To reduce the overhead of reading the clock, this is only checked after every `check_interval` tokens.
+     * @param check_interval Number of tokens to parse between clock readings.
+     *
+     * @return Whether parsing is complete.
+     */
+    template<typename Rep_, typename Period_>
+    bool step_for(std::chrono::duration<Rep_, Period_> budget, size_t check_interval = 64) {
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        if (check_interval == 0) {
+            check_interval = 1;
+        }
+        while (!my_done) {
+            for (size_t i = 0; i < check_interval && !my_done; ++i) {
+                process(my_reader.next());
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+        return my_done;
+    }
+
+public:
+    /**
+     * @return Whether parsing is complete.
+     */
+    bool done() const {
+        return my_done;
+    }
+
+    /**
+     * @return Number of bytes consumed so far.
+     * This can be compared to `size()` to report progress.
+     */
+    size_t position() const {
+        return my_input.position();
+    }
+
+    /**
+     * @return Length of the document in bytes.
+     */
+    size_t size() const {
+        return my_length;
+    }
+
+    /**
+     * @return The parsed JSON value.
+     * An error is raised if parsing is not yet complete.
+     */
+    const std::shared_ptr<Base>& result() const {
+        if (!my_done) {
+            throw std::runtime_error("parsing is not yet complete");
+        }
+        return my_root;
+    }
+
+private:
+    RawReader my_input;
+    EventReader<RawReader> my_reader;
+    size_t my_length;
+
+    bool my_done = false;
+    std::shared_ptr<Base> my_root;
+    std::vector<Base*> my_stack; // open arrays and objects, owned by their parents or 'my_root'.
+    std::string my_key;
+
+    void attach(std::shared_ptr<Base> value) {
+        if (my_stack.empty()) {
+            my_root = std::move(value);
+        } else if (my_stack.back()->type() == ARRAY) {
+            static_cast<Array*>(my_stack.back())->add(std::move(value));
+        } else {
+            static_cast<Object*>(my_stack.back())->add(std::move(my_key), std::move(value));
+        }
+    }
+
+    void process(Event event) {
+        switch (event) {
+            case Event::START_ARRAY:
+                {
+                    auto ptr = new Array;
+                    attach(std::shared_ptr<Base>(ptr));
+                    my_stack.push_back(ptr);
+                }
+                break;
+            case Event::START_OBJECT:
+                {
+                    auto ptr = new Object;
+                    attach(std::shared_ptr<Base>(ptr));
+                    my_stack.push_back(ptr);
+                }
+                break;
+            case Event::END_ARRAY:
+            case Event::END_OBJECT:
+                my_stack.pop_back();
+                break;
+            case Event::KEY:
+                my_key = my_reader.get_string();
+                break;
+            case Event::NUMBER:
+                attach(std::shared_ptr<Base>(new Number(my_reader.get_number())));
+                break;
+            case Event::STRING:
+                attach(std::shared_ptr<Base>(new String(my_reader.get_string())));
+                break;
+            case Event::BOOLEAN:
+                attach(std::shared_ptr<Base>(new Boolean(my_reader.get_boolean())));
+                break;
+            case Event::NOTHING:
+                attach(std::shared_ptr<Base>(new Nothing));
+                break;
+            case Event::END:
+                my_done = true;
+                break;
+        }
+    }
+};
+
+}
+
+#endif
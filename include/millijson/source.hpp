@@ -0,0 +1,380 @@
+#ifndef MILLIJSON_SOURCE_HPP
+#define MILLIJSON_SOURCE_HPP
+
+#include "millijson.hpp"
+#include "patch.hpp"
+#include "serialize.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file source.hpp
+ * @brief Parse and modify JSON documents while preserving the original bytes.
+ */
+
+namespace millijson {
+
+/**
+ * @brief JSON document that remembers the source bytes of each value.
+ *
+ * Each value in the parsed document is associated with its span in the original string.
+ * When the document is serialized, values that were not modified are copied verbatim from the original string,
+ * so the output is byte-identical to the input except in the modified parts of the document.
+ * This is also faster than formatting every value from scratch.
+ *
+ * Modifications should be performed via `modify()` or `replace()`, which mark all values on the path to the target as dirty.
+ * Dirty arrays and objects that were present in the original document retain their original whitespace, separators and key literals,
+ * with their clean children still copied verbatim; new elements or entries reuse the separators of the original container.
+ * The entries of dirty objects are written in the order of their keys in the original string, followed by any new entries in sorted order.
+ * Arrays and objects that were not present in the original document are formatted compactly.
+ */
+class SourceDocument {
+public:
+    /**
+     * @param source String containing the JSON document.
+     * An error is raised if the document is invalid.
+     */
+    SourceDocument(std::string source) : my_source(std::move(source)) {
+        RawReader input(my_source.data(), my_source.size());
+        chomp(input);
+        if (!input.valid()) {
+            throw std::runtime_error("no JSON value found at position " + std::to_string(input.position() + 1));
+        }
+        SourceProvisioner provisioner(my_source, my_spans);
+        my_root = parse_thing_with_chomp(input, provisioner);
+    }
+
+    /**
+     * @param[in] ptr Pointer to an array containing a JSON string.
+     * @param len Length of the array.
+     */
+    SourceDocument(const char* ptr, size_t len) : SourceDocument(std::string(ptr, ptr + len)) {}
+
+public:
+    /**
+     * @return The root of the document.
+     * This should not be modified directly, use `modify()` or `replace()` instead.
+     */
+    const std::shared_ptr<Base>& root() const {
+        return my_root;
+    }
+
+    /**
+     * @return The original JSON string.
+     */
+    const std::string& source() const {
+        return my_source;
+    }
+
+    /**
+     * Obtain a value for modification, marking it and all of its ancestors as dirty.
+     * The returned value (but not its children) can then be modified in place, e.g., by changing its contents or adding/removing children.
+     * To modify a child of the returned value, call `modify()` again with the path to that child.
+     *
+     * @param pointer JSON pointer to an existing value in the document.
+     * @return Reference to the value at `pointer`.
+     */
+    Base& modify(const std::string& pointer) {
+        auto tokens = split_pointer(pointer);
+        const std::shared_ptr<Base>* current = &my_root;
+        mark_dirty(**current);
+        for (const auto& t : tokens) {
+            current = &pointer_child(*current, t);
+            mark_dirty(**current);
+        }
+        return **current;
+    }
+
+    /**
+     * Replace a value in the document.
+     *
+     * @param pointer JSON pointer to an existing value in the document.
+     * @param value New value to store at `pointer`.
+     */
+    void replace(const std::string& pointer, std::shared_ptr<Base> value) {
+        auto tokens = split_pointer(pointer);
+        if (tokens.empty()) {
+            my_root = std::move(value);
+            return;
+        }
+
+        auto last = std::move(tokens.back());
+        tokens.pop_back();
+        std::string parent;
+        for (const auto& t : tokens) {
+            append_pointer(parent, t);
+        }
+
+        auto& container = modify(parent);
+        if (container.type() == ARRAY) {
+            auto& array = container.get_array();
+            auto index = pointer_index(last, array.size());
+            if (index == array.size()) {
+                throw std::runtime_error("out-of-range array index '" + last + "' in JSON pointer");
+            }
+            array[index] = std::move(value);
+        } else if (container.type() == OBJECT) {
+            auto& object = container.get_object();
+            auto it = object.find(last);
+            if (it == object.end()) {
+                throw std::runtime_error("failed to find key '" + last + "' in JSON pointer");
+            }
+            it->second = std::move(value);
+        } else {
+            throw std::runtime_error("JSON pointer refers to a child of a non-container value");
+        }
+    }
+
+    /**
+     * @param value A value in the document.
+     * @return Whether `value` is dirty.
+     * This is also true for values that were not present in the original document.
+     */
+    bool dirty(const Base& value) const {
+        auto record = find_record(value);
+        return record == nullptr || record->dirty;
+    }
+
+public:
+    /**
+     * Serialize the document, streaming it to a writer in chunks.
+     *
+     * @tparam Writer_ Any callable that accepts a `const char*` and a `size_t`, specifying a pointer to a chunk of bytes and its length, respectively.
+     * @param writer Instance of a `Writer_`.
+     * @param buffer_size Size of the buffer to use for accumulating output before calling `writer`.
+     * @return Number of bytes that were written.
+     */
+    template<class Writer_>
+    size_t serialize(Writer_ writer, size_t buffer_size = 65536) const {
+        BufferedWriter<Writer_> buffered(writer, buffer_size);
+        auto record = find_record(*my_root);
+        if (record && !record->dirty) {
+            // Preserving the surrounding whitespace if nothing has changed.
+            buffered.buffer = my_source;
+        } else if (record) {
+            buffered.buffer.append(my_source, 0, record->start);
+            write(*my_root, buffered);
+            size_t end = record->start + record->length;
+            buffered.buffer.append(my_source, end, my_source.size() - end);
+        } else {
+            write(*my_root, buffered);
+        }
+        buffered.flush();
+        return buffered.written();
+    }
+
+    /**
+     * @return String containing the serialized document, see `serialize()` for details.
+     */
+    std::string serialize_string() const {
+        std::string output;
+        serialize([&](const char* ptr, size_t len) -> void { output.append(ptr, len); });
+        return output;
+    }
+
+private:
+    // Positions of a child of an array or object in the source.
+    // For array elements, 'start' and 'colon' are equal to 'value'.
+    struct Layout {
+        size_t start; // start of the key literal.
+        size_t colon; // immediately after the key literal.
+        size_t value; // start of the value.
+        size_t end; // immediately after the value.
+    };
+
+    struct Record {
+        size_t start = 0;
+        size_t length = 0;
+        bool dirty = false;
+        std::weak_ptr<Base> node; // detecting if the node was destroyed, in which case its address might be reused by a new node.
+        std::vector<Layout> layout; // children in their original order, for arrays and objects.
+        std::vector<std::string> keys; // keys of the children in their original order, for objects.
+    };
+
+    std::string my_source;
+    std::shared_ptr<Base> my_root;
+    std::unordered_map<const Base*, Record> my_spans;
+
+    const Record* find_record(const Base& value) const {
+        auto it = my_spans.find(&value);
+        if (it == my_spans.end() || it->second.node.expired()) {
+            return nullptr;
+        }
+        return &(it->second);
+    }
+
+    void mark_dirty(const Base& value) {
+        auto it = my_spans.find(&value);
+        if (it != my_spans.end() && !it->second.node.expired()) {
+            it->second.dirty = true;
+        }
+    }
+
+    // Records the span of each value via the parse_thing() hooks.
+    struct SourceProvisioner : public TrackingProvisioner<false> {
+        SourceProvisioner(const std::string& source, std::unordered_map<const Base*, Record>& spans) : source(source), spans(spans) {}
+        const std::string& source;
+        std::unordered_map<const Base*, Record>& spans;
+        std::vector<Record> pending; // one for each entry of 'stack'.
+
+        template<class Input_>
+        void enter(const Input_& input) {
+            size_t vstart = input.position();
+            if (!pending.empty()) {
+                auto& parent = pending.back();
+                size_t kstart = vstart, colon = vstart;
+                if (stack.back().object) {
+                    // Only whitespace and a comma can lie between the previous value (or the opening brace) and the key,
+                    // and only whitespace and a colon can lie between the key and this value.
+                    kstart = (parent.layout.empty() ? stack.back().start + 1 : parent.layout.back().end);
+                    while (isspace(source[kstart])) {
+                        ++kstart;
+                    }
+                    if (!parent.layout.empty()) {
+                        ++kstart;
+                        while (isspace(source[kstart])) {
+                            ++kstart;
+                        }
+                    }
+
+                    while (isspace(source[colon - 1])) {
+                        --colon;
+                    }
+                    --colon;
+                    while (isspace(source[colon - 1])) {
+                        --colon;
+                    }
+                    parent.keys.push_back(pending_key);
+                }
+                parent.layout.push_back(Layout{ kstart, colon, vstart, 0 });
+            }
+
+            TrackingProvisioner<false>::enter(input);
+            pending.emplace_back();
+        }
+
+        template<class Input_>
+        void leave(const Input_& input, const std::shared_ptr<Base>& value) {
+            // The input is positioned immediately after the last character of the value.
+            auto record = std::move(pending.back());
+            pending.pop_back();
+            record.start = stack.back().start;
+            record.length = input.position() - record.start;
+            record.node = value;
+            if (!pending.empty()) {
+                pending.back().layout.back().end = input.position();
+            }
+            spans[value.get()] = std::move(record);
+            TrackingProvisioner<false>::leave(input, value);
+        }
+    };
+
+    template<class Writer_>
+    void write(const Base& value, BufferedWriter<Writer_>& writer) const {
+        const Record* record = find_record(value);
+        if (record && !record->dirty) {
+            writer.buffer.append(my_source, record->start, record->length);
+            writer.check();
+            return;
+        }
+
+        auto type = value.type();
+        if (type == ARRAY) {
+            writer.buffer += '[';
+            const auto& array = value.get_array();
+            for (size_t i = 0, end = array.size(); i < end; ++i) {
+                write_separator(record, i, writer.buffer);
+                write(*(array[i]), writer);
+            }
+            write_closing(record, array.size(), writer.buffer);
+            writer.buffer += ']';
+            writer.check();
+
+        } else if (type == OBJECT) {
+            // Original entries are ordered by the position of their keys in the source, and new entries are sorted by key.
+            typedef std::pair<const std::string, std::shared_ptr<Base> > Entry;
+            const auto& object = value.get_object();
+            std::unordered_map<std::string, size_t> original;
+            if (record) {
+                original.reserve(record->keys.size());
+                for (size_t k = 0, end = record->keys.size(); k < end; ++k) {
+                    original[record->keys[k]] = k;
+                }
+            }
+
+            constexpr size_t unknown = static_cast<size_t>(-1);
+            std::vector<std::pair<size_t, const Entry*> > entries;
+            entries.reserve(object.size());
+            for (const auto& x : object) {
+                auto oIt = original.find(x.first);
+                entries.emplace_back(oIt == original.end() ? unknown : oIt->second, &x);
+            }
+            std::sort(entries.begin(), entries.end(), [](const auto& left, const auto& right) -> bool {
+                if (left.first != right.first) {
+                    return left.first < right.first;
+                }
+                return left.second->first < right.second->first;
+            });
+
+            writer.buffer += '{';
+            for (size_t i = 0, end = entries.size(); i < end; ++i) {
+                write_separator(record, i, writer.buffer);
+                const auto& x = entries[i];
+                if (x.first != unknown) {
+                    const auto& current = record->layout[x.first];
+                    writer.buffer.append(my_source, current.start, current.value - current.start);
+                } else {
+                    append_string_literal(writer.buffer, x.second->first);
+                    if (record && !record->layout.empty()) {
+                        const auto& first = record->layout.front();
+                        writer.buffer.append(my_source, first.colon, first.value - first.colon);
+                    } else {
+                        writer.buffer += ':';
+                    }
+                }
+                write(*(x.second->second), writer);
+            }
+            write_closing(record, entries.size(), writer.buffer);
+            writer.buffer += '}';
+            writer.check();
+
+        } else {
+            serialize_scalar(value, writer);
+        }
+    }
+
+    // Copying the source bytes before the 'i'-th child of a dirty container, i.e., the leading whitespace or the separator from the previous child.
+    // Children beyond the original number of children reuse the last separator.
+    void write_separator(const Record* record, size_t i, std::string& buffer) const {
+        size_t n = (record ? record->layout.size() : 0);
+        if (i == 0) {
+            if (n) {
+                size_t open = record->start + 1;
+                buffer.append(my_source, open, record->layout.front().start - open);
+            }
+        } else if (n >= 2) {
+            size_t j = std::min(i, n - 1);
+            size_t from = record->layout[j - 1].end;
+            buffer.append(my_source, from, record->layout[j].start - from);
+        } else {
+            buffer += ',';
+        }
+    }
+
+    // Copying the source bytes between the last child and the closing bracket of a dirty container.
+    void write_closing(const Record* record, size_t count, std::string& buffer) const {
+        if (record && count && !record->layout.empty()) {
+            size_t from = record->layout.back().end, close = record->start + record->length - 1;
+            buffer.append(my_source, from, close - from);
+        }
+    }
+};
+
+}
+
+#endif
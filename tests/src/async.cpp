@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <cstdio>
+#include "millijson/async.hpp"
+
+#if defined(__linux__)
+#include <poll.h>
+#endif
+
+TEST(AsyncParser, Future) {
+    millijson::AsyncParser parser(2);
+
+    std::string foo = "[ 1, 2, \"foo\" ]";
+    auto fut = parser.parse_string_async(foo.c_str(), foo.size());
+
+    {
+        std::ofstream output("TEST-async.json");
+        output << "{ \"a\": null }" << std::endl;
+    }
+    auto fut2 = parser.parse_file_async("TEST-async.json", 5);
+
+    auto res = fut.get();
+    EXPECT_EQ(res->type(), millijson::ARRAY);
+    EXPECT_EQ(res->get_array().size(), 3);
+
+    auto res2 = fut2.get();
+    EXPECT_EQ(res2->type(), millijson::OBJECT);
+    std::remove("TEST-async.json");
+
+    std::string bar = "[ 1, 2";
+    auto fut3 = parser.parse_string_async(bar.c_str(), bar.size());
+    EXPECT_ANY_THROW({
+        try {
+            fut3.get();
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("unterminated array"));
+            throw;
+        }
+    });
+}
+
+TEST(AsyncParser, Callback) {
+    millijson::AsyncParser parser;
+
+    std::string foo = "{ \"foo\": true }";
+    std::promise<bool> done;
+    parser.parse_string_async(foo.c_str(), foo.size(), [&](std::shared_ptr<millijson::Base> res, std::exception_ptr err) -> void {
+        done.set_value(res && !err && res->type() == millijson::OBJECT);
+    });
+    EXPECT_TRUE(done.get_future().get());
+
+    std::promise<bool> failed;
+    parser.parse_file_async("TEST-async-missing.json", [&](std::shared_ptr<millijson::Base> res, std::exception_ptr err) -> void {
+        failed.set_value(!res && err);
+    });
+    EXPECT_TRUE(failed.get_future().get());
+}
+
+TEST(AsyncParser, Queued) {
+    millijson::AsyncParser parser(3);
+
+    std::vector<std::string> docs { "1", "[true]", "{\"x\":\"y\"}", "nul" };
+    std::vector<int> types(docs.size(), -1);
+    for (size_t i = 0; i < docs.size(); ++i) {
+        parser.parse_string_queued(docs[i].c_str(), docs[i].size(), [&types,i](std::shared_ptr<millijson::Base> res, std::exception_ptr) -> void {
+            types[i] = (res ? res->type() : 100);
+        });
+    }
+
+    size_t total = 0;
+    while (total < docs.size()) {
+#if defined(__linux__)
+        pollfd pfd;
+        pfd.fd = parser.event_fd();
+        pfd.events = POLLIN;
+        ASSERT_EQ(::poll(&pfd, 1, 10000), 1);
+#endif
+        total += parser.dispatch();
+    }
+
+    EXPECT_EQ(types[0], millijson::NUMBER);
+    EXPECT_EQ(types[1], millijson::ARRAY);
+    EXPECT_EQ(types[2], millijson::OBJECT);
+    EXPECT_EQ(types[3], 100);
+    EXPECT_EQ(parser.dispatch(), 0);
+}
+
+TEST(AsyncParser, Executor) {
+    std::vector<std::thread> threads;
+    {
+        millijson::AsyncParser parser([&](std::function<void()> task) -> void {
+            threads.emplace_back(std::move(task));
+        });
+
+        std::string foo = "[ 1, 2, 3, 4 ]";
+        auto fut = parser.parse_string_async(foo.c_str(), foo.size());
+        EXPECT_EQ(fut.get()->get_array().size(), 4);
+
+        std::string bar = "\"asdasd\"";
+        parser.parse_string_queued(bar.c_str(), bar.size(), [](std::shared_ptr<millijson::Base>, std::exception_ptr) -> void {});
+    } // destructor waits for all jobs.
+
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+TEST(AsyncParser, ThrowingCallback) {
+    std::string foo = "[ 1, 2 ]";
+    std::atomic<int> calls(0);
+    auto thrower = [&](std::shared_ptr<millijson::Base>, std::exception_ptr) -> void {
+        ++calls;
+        throw std::runtime_error("oops");
+    };
+
+    // The destructor should not hang, and the worker should survive to process later jobs.
+    {
+        millijson::AsyncParser parser(1);
+        parser.parse_string_async(foo.c_str(), foo.size(), thrower);
+        parser.parse_string_async(foo.c_str(), foo.size(), thrower);
+        auto fut = parser.parse_string_async(foo.c_str(), foo.size());
+        EXPECT_EQ(fut.get()->get_array().size(), 2);
+    }
+    EXPECT_EQ(calls.load(), 2);
+
+    std::vector<std::thread> threads;
+    {
+        millijson::AsyncParser parser([&](std::function<void()> task) -> void {
+            threads.emplace_back(std::move(task));
+        });
+        parser.parse_string_async(foo.c_str(), foo.size(), thrower);
+    }
+    EXPECT_EQ(calls.load(), 3);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+TEST(AsyncParser, ThrowingQueuedCallback) {
+    // Running each task immediately, so that all completions are queued before the first dispatch().
+    millijson::AsyncParser parser([](std::function<void()> task) -> void { task(); });
+
+    std::vector<std::string> docs { "1", "2", "3", "4" };
+    std::vector<int> seen(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        parser.parse_string_queued(docs[i].c_str(), docs[i].size(), [&seen,i](std::shared_ptr<millijson::Base>, std::exception_ptr) -> void {
+            seen[i] = 1;
+            if (i % 2 == 0) {
+                throw std::runtime_error("oops" + std::to_string(i));
+            }
+        });
+    }
+
+    // All callbacks are run even if earlier ones throw, and the first exception is propagated.
+    EXPECT_ANY_THROW({
+        try {
+            parser.dispatch();
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("oops0"));
+            throw;
+        }
+    });
+    EXPECT_EQ(seen, std::vector<int>(docs.size(), 1));
+    EXPECT_EQ(parser.dispatch(), 0);
+}
+
+TEST(AsyncParser, ThrowingExecutor) {
+    {
+        millijson::AsyncParser parser([&](std::function<void()>) -> void {
+            throw std::runtime_error("rejected");
+        });
+
+        std::string foo = "[ 1, 2 ]";
+        EXPECT_ANY_THROW(parser.parse_string_async(foo.c_str(), foo.size()));
+        EXPECT_ANY_THROW(parser.parse_string_queued(foo.c_str(), foo.size(), [](std::shared_ptr<millijson::Base>, std::exception_ptr) -> void {}));
+    } // destructor should not hang.
+}
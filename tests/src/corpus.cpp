@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/corpus.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+TEST(BloomFilter, Basic) {
+    millijson::BloomFilter filter(1000, 0.01);
+    EXPECT_GT(filter.num_hashes(), 1);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        filter.insert(millijson::corpus_hash(std::to_string(i)));
+    }
+
+    // No false negatives.
+    for (uint64_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(filter.maybe_contains(millijson::corpus_hash(std::to_string(i))));
+    }
+
+    // False positive rate is around the target.
+    size_t hits = 0;
+    for (uint64_t i = 1000; i < 11000; ++i) {
+        hits += filter.maybe_contains(millijson::corpus_hash(std::to_string(i)));
+    }
+    EXPECT_LT(hits, 300);
+
+    EXPECT_ANY_THROW(millijson::BloomFilter(10, 0));
+    millijson::BloomFilter empty(0, 0.01);
+    EXPECT_FALSE(empty.maybe_contains(12345));
+}
+
+static void check_corpus(const millijson::CorpusIndex& index) {
+    EXPECT_EQ(index.size(), 3);
+    EXPECT_EQ(index.name(0), "first");
+    EXPECT_EQ(index.with_key("/id"), std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(index.with_key("/tags"), std::vector<size_t>({ 0 }));
+    EXPECT_EQ(index.with_key("/tags/*"), std::vector<size_t>({ 0 }));
+    EXPECT_EQ(index.with_key("/nested/*/x~1y"), std::vector<size_t>({ 1 }));
+    EXPECT_EQ(index.with_key("/*"), std::vector<size_t>({ 2 }));
+    EXPECT_TRUE(index.with_key("/missing").empty());
+    EXPECT_TRUE(index.with_key("").empty());
+
+    // No false negatives for values, anywhere or at a path.
+    EXPECT_THAT(index.with_value(millijson::String("red")), ::testing::Contains(0));
+    EXPECT_THAT(index.with_value(millijson::Number(2)), ::testing::IsSupersetOf({ 1, 2 }));
+    EXPECT_THAT(index.with_value(millijson::Number(-0.0)), ::testing::Contains(2));
+    EXPECT_THAT(index.with_value(millijson::Boolean(true)), ::testing::Contains(1));
+    EXPECT_THAT(index.with_value(millijson::Nothing()), ::testing::Contains(0));
+    EXPECT_EQ(index.with_value("/id", millijson::Number(2)), std::vector<size_t>({ 1 }));
+    EXPECT_EQ(index.with_value("/tags/*", millijson::String("blue")), std::vector<size_t>({ 0 }));
+
+    // Values at the wrong path are (almost certainly) excluded.
+    EXPECT_TRUE(index.with_value("/id", millijson::String("red")).empty());
+    EXPECT_TRUE(index.with_value("/missing", millijson::Number(1)).empty());
+
+    EXPECT_ANY_THROW(index.with_value(millijson::Array()));
+}
+
+static const std::vector<std::string> corpus_docs {
+    "{ \"id\": 1, \"tags\": [ \"red\", \"blue\" ], \"note\": null }",
+    "{ \"id\": 2, \"nested\": [ { \"x/y\": true } ] }",
+    "[ 0, 2, 4 ]"
+};
+
+TEST(CorpusIndex, Strings) {
+    millijson::CorpusIndex index;
+    index.add_string("first", corpus_docs[0].c_str(), corpus_docs[0].size());
+    index.add_string("second", corpus_docs[1].c_str(), corpus_docs[1].size());
+    index.add_string("third", corpus_docs[2].c_str(), corpus_docs[2].size());
+    check_corpus(index);
+
+    // Invalid documents are not added.
+    std::string bad = "{\"a\":1,\"a\":2}";
+    EXPECT_ANY_THROW({
+        try {
+            index.add_string("bad", bad.c_str(), bad.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("duplicate keys"));
+            throw;
+        }
+    });
+    EXPECT_EQ(index.size(), 3);
+
+    // Round-tripping through a file.
+    index.save("TEST-corpus.idx");
+    millijson::CorpusIndex loaded;
+    loaded.load("TEST-corpus.idx");
+    check_corpus(loaded);
+
+    {
+        std::ofstream output("TEST-corpus.idx", std::ios::app);
+        output << "x";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            loaded.load("TEST-corpus.idx");
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("trailing bytes"));
+            throw;
+        }
+    });
+    check_corpus(loaded);
+}
+
+TEST(CorpusIndex, InvalidHashes) {
+    auto craft = [](bool values, char nhashes) -> void {
+        std::string contents("MJCI", 4);
+        contents += '\x01'; // version.
+        contents += static_cast<char>(values);
+        contents += '\x01'; // number of files.
+        contents += "\x01" "a";
+        contents += nhashes;
+        contents += '\x01'; // number of words.
+        contents += std::string(8, '\0');
+        contents += '\0'; // number of keys.
+        std::ofstream output("TEST-corpus.idx", std::ios::binary);
+        output << contents;
+    };
+
+    millijson::CorpusIndex loaded;
+    craft(true, 3);
+    loaded.load("TEST-corpus.idx");
+    EXPECT_EQ(loaded.size(), 1);
+
+    for (char nhashes : { 0, 17 }) {
+        craft(true, nhashes);
+        EXPECT_ANY_THROW({
+            try {
+                loaded.load("TEST-corpus.idx");
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("invalid number of hashes"));
+                throw;
+            }
+        });
+    }
+
+    // Zero hashes are fine without values, as the filters are never used.
+    craft(false, 0);
+    loaded.load("TEST-corpus.idx");
+    EXPECT_EQ(loaded.size(), 1);
+    craft(false, 17);
+    EXPECT_ANY_THROW(loaded.load("TEST-corpus.idx"));
+}
+
+TEST(CorpusIndex, KeysOnly) {
+    millijson::CorpusIndexOptions opt;
+    opt.values = false;
+    millijson::CorpusIndex index(opt);
+    index.add_string("first", corpus_docs[0].c_str(), corpus_docs[0].size());
+    EXPECT_EQ(index.with_key("/tags/*"), std::vector<size_t>({ 0 }));
+    EXPECT_ANY_THROW(index.with_value(millijson::String("red")));
+
+    index.save("TEST-corpus.idx");
+    millijson::CorpusIndex loaded;
+    loaded.load("TEST-corpus.idx");
+    EXPECT_ANY_THROW(loaded.with_value(millijson::String("red")));
+}
+
+TEST(CorpusIndex, Directory) {
+    std::string dir = "TEST-corpus";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir + "/sub");
+    std::vector<std::string> paths { "a.json", "sub/b.json", "sub/c.json", "sub/bad.json", "notes.txt" };
+    std::vector<std::string> contents { corpus_docs[0], corpus_docs[1], corpus_docs[2], "[1,", "{}" };
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::ofstream output(dir + "/" + paths[i]);
+        output << contents[i];
+    }
+
+    millijson::CorpusIndexOptions opt;
+    opt.num_threads = 3;
+    millijson::CorpusIndex index(opt);
+    auto failed = index.add_directory(dir);
+    EXPECT_EQ(failed.size(), 1);
+    EXPECT_EQ(failed[0].first, "sub/bad.json");
+    EXPECT_FALSE(failed[0].second.empty());
+
+    EXPECT_EQ(index.size(), 3);
+    EXPECT_EQ(index.name(0), "a.json");
+    EXPECT_EQ(index.name(1), "sub/b.json");
+    EXPECT_EQ(index.name(2), "sub/c.json");
+    EXPECT_EQ(index.with_key("/nested/*/x~1y"), std::vector<size_t>({ 1 }));
+    EXPECT_EQ(index.with_value("/id", millijson::Number(1)), std::vector<size_t>({ 0 }));
+
+    auto id = index.add_file(dir + "/a.json", "again");
+    EXPECT_EQ(index.name(id), "again");
+    EXPECT_EQ(index.with_key("/tags"), std::vector<size_t>({ 0, 3 }));
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include "millijson/diff.hpp"
+#include "millijson/patch.hpp"
+#include "millijson/generate.hpp"
+
+static std::vector<millijson::Change> diff_raw(std::string a, std::string b, millijson::DiffOptions options = millijson::DiffOptions()) {
+    std::vector<millijson::Change> output;
+    millijson::diff_strings(a.c_str(), a.size(), b.c_str(), b.size(), [&](millijson::Change c) -> void { output.push_back(std::move(c)); }, options);
+    return output;
+}
+
+static void check_roundtrip(const std::string& a, const std::string& b) {
+    auto changes = diff_raw(a, b);
+    auto old = millijson::parse_string(a.c_str(), a.size());
+    auto patched = millijson::apply_patch(old, *millijson::to_patch(changes));
+    auto expected = millijson::parse_string(b.c_str(), b.size());
+    EXPECT_TRUE(millijson::equal(*patched, *expected));
+}
+
+TEST(Diff, Identical) {
+    EXPECT_TRUE(diff_raw("{ \"a\": [1, 2, {\"b\": null}] }", "{\"a\":[1,2,{\"b\":null}]}").empty());
+    EXPECT_TRUE(diff_raw("1", "1.0").empty());
+}
+
+TEST(Diff, Scalars) {
+    auto changes = diff_raw("[1, \"a\", true, null]", "[2, \"b\", false, 0]");
+    ASSERT_EQ(changes.size(), 4);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(changes[i].type, millijson::ChangeType::REPLACE);
+        EXPECT_EQ(changes[i].path, "/" + std::to_string(i));
+    }
+    EXPECT_EQ(changes[0].value->get_number(), 2);
+    EXPECT_EQ(changes[3].value->type(), millijson::NUMBER);
+
+    auto root = diff_raw("1", "[1]");
+    ASSERT_EQ(root.size(), 1);
+    EXPECT_EQ(root[0].path, "");
+    EXPECT_EQ(root[0].value->type(), millijson::ARRAY);
+}
+
+TEST(Diff, Arrays) {
+    auto added = diff_raw("[1]", "[1, [2], 3]");
+    ASSERT_EQ(added.size(), 2);
+    EXPECT_EQ(added[0].type, millijson::ChangeType::ADD);
+    EXPECT_EQ(added[0].path, "/1");
+    EXPECT_EQ(added[0].value->type(), millijson::ARRAY);
+    EXPECT_EQ(added[1].path, "/2");
+
+    auto removed = diff_raw("[1, [2], 3]", "[1]");
+    ASSERT_EQ(removed.size(), 2);
+    EXPECT_EQ(removed[0].type, millijson::ChangeType::REMOVE);
+    EXPECT_EQ(removed[0].path, "/1");
+    EXPECT_EQ(removed[1].path, "/1");
+
+    check_roundtrip("[1, [2], 3]", "[1]");
+    check_roundtrip("[]", "[1, {}]");
+}
+
+TEST(Diff, Objects) {
+    auto changes = diff_raw("{ \"a\": 1, \"b/c\": { \"d\": 2 } }", "{ \"a\": 1, \"b/c\": { \"d\": 3, \"e~\": 4 } }");
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].type, millijson::ChangeType::REPLACE);
+    EXPECT_EQ(changes[0].path, "/b~1c/d");
+    EXPECT_EQ(changes[1].type, millijson::ChangeType::ADD);
+    EXPECT_EQ(changes[1].path, "/b~1c/e~0");
+
+    // Different key orders.
+    auto reordered = diff_raw("{ \"a\": 1, \"b\": [1, 2], \"c\": 3 }", "{ \"b\": [1, 5], \"a\": 1, \"d\": 4 }");
+    ASSERT_EQ(reordered.size(), 3);
+    EXPECT_EQ(reordered[0].path, "/b/1");
+    EXPECT_EQ(reordered[1].type, millijson::ChangeType::REMOVE);
+    EXPECT_EQ(reordered[1].path, "/c");
+    EXPECT_EQ(reordered[2].type, millijson::ChangeType::ADD);
+    EXPECT_EQ(reordered[2].path, "/d");
+
+    check_roundtrip("{ \"a\": 1, \"b\": [1, 2], \"c\": 3 }", "{ \"b\": [1, 5], \"a\": 1, \"d\": 4 }");
+    check_roundtrip("{ \"x\": { \"a\": {\"p\": 1, \"q\": 2}, \"b\": 2 } }", "{ \"x\": { \"b\": 2, \"a\": {\"q\": 2, \"p\": 0} } }");
+
+    // Nested objects are compared in sorted key order once buffered, so they don't need to be buffered again.
+    millijson::DiffOptions opt;
+    opt.max_buffered = 4;
+    EXPECT_TRUE(diff_raw("{ \"x\": 1, \"y\": { \"p\": { \"a\": 1, \"b\": 2 }, \"q\": 2 } }", "{ \"y\": { \"q\": 2, \"p\": { \"b\": 2, \"a\": 1 } }, \"x\": 1 }", opt).empty());
+
+    // Respects the buffering limit.
+    opt.max_buffered = 1;
+    EXPECT_ANY_THROW({
+        try {
+            diff_raw("{ \"a\": 1, \"b\": 2 }", "{ \"b\": 2, \"a\": 1 }", opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("maximum number of buffered entries"));
+            throw;
+        }
+    });
+
+    // Respects the byte limit, even if the offending value is a single large entry.
+    opt.max_buffered = 1000000;
+    opt.max_buffered_bytes = 10000;
+    std::string big = "[";
+    for (size_t i = 0; i < 1000; ++i) {
+        big += (i ? ",\"" : "\"") + std::string(100, 'x') + "\"";
+    }
+    big += "]";
+    EXPECT_ANY_THROW({
+        try {
+            diff_raw("{ \"a\": 1, \"b\": " + big + " }", "{ \"b\": 2, \"a\": 1 }", opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("maximum number of buffered bytes"));
+            throw;
+        }
+    });
+
+    opt.max_buffered_bytes = 1000000;
+    auto fine = diff_raw("{ \"a\": 1, \"b\": " + big + " }", "{ \"b\": 2, \"a\": 1 }", opt);
+    ASSERT_EQ(fine.size(), 1);
+    EXPECT_EQ(fine[0].path, "/b");
+}
+
+TEST(Diff, SkipIdentical) {
+    // Byte-identical containers are skipped without parsing, so the invalid number is not detected.
+    std::string a = "[{\"x\": [01, \"]}\\\"\"]}, 1, [2, 3]]";
+    std::string b = "[{\"x\": [01, \"]}\\\"\"]}, 2, [2, 4]]";
+    auto changes = diff_raw(a, b);
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].path, "/1");
+    EXPECT_EQ(changes[1].path, "/2/1");
+
+    millijson::DiffOptions opt;
+    opt.skip_identical = false;
+    EXPECT_ANY_THROW(diff_raw(a, b, opt));
+
+    // Differences in deeply nested containers are still found.
+    auto nested = diff_raw("{ \"a\": [[1, {\"b\": [2]}], [3]], \"c\": [4] }", "{ \"a\": [[1, {\"b\": [5]}], [3]], \"c\": [4] }");
+    ASSERT_EQ(nested.size(), 1);
+    EXPECT_EQ(nested[0].path, "/a/0/1/b/0");
+
+    // Mismatched brackets are still reported by the event parser.
+    EXPECT_ANY_THROW(diff_raw("[[1}, 2]", "[[1}, 3]"));
+    EXPECT_ANY_THROW(diff_raw("[[1, 2]", "[[1, 2]"));
+}
+
+TEST(Diff, Generated) {
+    for (size_t seed = 0; seed < 20; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.depth = 4;
+        auto a = millijson::generate_string(opt);
+        opt.seed = seed + 1000;
+        auto b = millijson::generate_string(opt);
+        check_roundtrip(a, b);
+        check_roundtrip(b, a);
+    }
+}
+
+TEST(Diff, Files) {
+    {
+        std::ofstream output("TEST-diff-a.json");
+        output << "{ \"a\": [1, 2, 3], \"b\": \"foo\" }";
+    }
+    {
+        std::ofstream output("TEST-diff-b.json");
+        output << "{ \"a\": [1, 2], \"b\": \"bar\" }";
+    }
+
+    std::vector<millijson::Change> changes;
+    millijson::diff_files("TEST-diff-a.json", "TEST-diff-b.json", [&](millijson::Change c) -> void { changes.push_back(std::move(c)); }, millijson::DiffOptions(), 5);
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].path, "/a/2");
+    EXPECT_EQ(changes[1].path, "/b");
+
+    // Larger buffers allow identical containers to be skipped.
+    changes.clear();
+    millijson::diff_files("TEST-diff-a.json", "TEST-diff-a.json", [&](millijson::Change c) -> void { changes.push_back(std::move(c)); });
+    EXPECT_TRUE(changes.empty());
+
+    EXPECT_ANY_THROW(diff_raw("[1]", "[1] x"));
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/directory.hpp"
+
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+
+class DirectoryIndexTest : public ::testing::Test {
+protected:
+    void SetUp() {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir + "/sub/deeper");
+        write("a.json", "{\"id\":\"a\",\"n\":1}");
+        write("sub/b.json", "{\"id\":\"b\",\"n\":2}");
+        write("sub/deeper/c.json", "[1,2,3]");
+        write("notes.txt", "not json");
+    }
+
+    void TearDown() {
+        std::filesystem::remove_all(dir);
+    }
+
+    void write(const std::string& relative, const std::string& contents) {
+        std::ofstream output(dir + "/" + relative);
+        output << contents;
+    }
+
+    // Bumping the modification time, as the file system clock may be too coarse to detect rapid changes.
+    void bump(const std::string& relative) {
+        auto path = dir + "/" + relative;
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(10));
+    }
+
+    std::string dir = "TEST-directory";
+};
+
+TEST_F(DirectoryIndexTest, Refresh) {
+    millijson::DirectoryIndex index(dir);
+    auto first = index.refresh();
+    EXPECT_EQ(first.added, 3);
+    EXPECT_EQ(first.modified, 0);
+    EXPECT_EQ(first.unchanged, 0);
+    EXPECT_EQ(first.failed, 0);
+
+    const auto& files = index.files();
+    ASSERT_EQ(files.size(), 3);
+    EXPECT_EQ(files.at("a.json").size, 16);
+    EXPECT_NE(files.at("a.json").hash, 0);
+    EXPECT_EQ(index.get("sub/b.json")->get_object().at("n")->get_number(), 2);
+    EXPECT_EQ(index.get("sub/deeper/c.json")->get_array().size(), 3);
+    EXPECT_FALSE(index.get("notes.txt"));
+
+    // Nothing changed, so nothing is re-parsed.
+    auto original = index.get("a.json");
+    auto second = index.refresh();
+    EXPECT_EQ(second.unchanged, 3);
+    EXPECT_EQ(second.added + second.modified + second.removed, 0);
+    EXPECT_EQ(index.get("a.json").get(), original.get());
+
+    // Touched but same contents.
+    bump("a.json");
+    auto third = index.refresh();
+    EXPECT_EQ(third.unchanged, 3);
+    EXPECT_EQ(index.get("a.json").get(), original.get());
+
+    // Modifications, additions, removals and failures.
+    write("a.json", "{\"id\":\"a\",\"n\":10}");
+    bump("a.json");
+    write("sub/new.json", "{\"id\":\"new\"}");
+    write("sub/broken.json", "{\"id\":");
+    std::filesystem::remove(dir + "/sub/deeper/c.json");
+
+    auto fourth = index.refresh();
+    EXPECT_EQ(fourth.modified, 1);
+    EXPECT_EQ(fourth.added, 2);
+    EXPECT_EQ(fourth.removed, 1);
+    EXPECT_EQ(fourth.unchanged, 1);
+    EXPECT_EQ(fourth.failed, 1);
+
+    EXPECT_EQ(index.get("a.json")->get_object().at("n")->get_number(), 10);
+    EXPECT_EQ(index.get("sub/new.json")->get_object().at("id")->get_string(), "new");
+    EXPECT_FALSE(index.get("sub/deeper/c.json"));
+    EXPECT_FALSE(index.get("sub/broken.json"));
+    EXPECT_THAT(index.files().at("sub/broken.json").error, ::testing::HasSubstr("unterminated"));
+}
+
+TEST_F(DirectoryIndexTest, Options) {
+    millijson::DirectoryIndexOptions opt;
+    opt.extension = "";
+    opt.num_threads = 1;
+    opt.extract = [](const std::string& path, std::shared_ptr<millijson::Base> doc) -> std::shared_ptr<millijson::Base> {
+        if (doc->type() == millijson::OBJECT) {
+            return doc->get_object().at("id");
+        }
+        return std::shared_ptr<millijson::Base>(new millijson::String(path));
+    };
+
+    millijson::DirectoryIndex index(dir, opt);
+    auto summary = index.refresh();
+    EXPECT_EQ(summary.added, 4);
+    EXPECT_EQ(summary.failed, 1); // the text file.
+    EXPECT_EQ(index.get("a.json")->get_string(), "a");
+    EXPECT_EQ(index.get("sub/deeper/c.json")->get_string(), "sub/deeper/c.json");
+    EXPECT_FALSE(index.get("notes.txt"));
+}
+
+TEST_F(DirectoryIndexTest, Cache) {
+    std::string cache = dir + "-cache.json";
+    {
+        millijson::DirectoryIndex index(dir);
+        EXPECT_FALSE(index.load(cache + ".missing"));
+        index.refresh();
+        index.save(cache);
+    }
+
+    write("sub/b.json", "{\"id\":\"b\",\"n\":20}");
+    bump("sub/b.json");
+    write("sub/broken.json", "[");
+
+    millijson::DirectoryIndex index(dir);
+    EXPECT_TRUE(index.load(cache));
+    EXPECT_EQ(index.files().size(), 3);
+    EXPECT_EQ(index.get("sub/b.json")->get_object().at("n")->get_number(), 2);
+
+    auto summary = index.refresh();
+    EXPECT_EQ(summary.unchanged, 2);
+    EXPECT_EQ(summary.modified, 1);
+    EXPECT_EQ(summary.added, 1);
+    EXPECT_EQ(summary.failed, 1);
+    EXPECT_EQ(index.get("sub/b.json")->get_object().at("n")->get_number(), 20);
+    EXPECT_EQ(index.get("sub/deeper/c.json")->get_array()[2]->get_number(), 3);
+
+    // Errors are also cached.
+    index.save(cache);
+    millijson::DirectoryIndex reloaded(dir);
+    EXPECT_TRUE(reloaded.load(cache));
+    EXPECT_FALSE(reloaded.get("sub/broken.json"));
+    EXPECT_FALSE(reloaded.files().at("sub/broken.json").error.empty());
+    EXPECT_EQ(reloaded.files().at("sub/b.json").hash, index.files().at("sub/b.json").hash);
+    EXPECT_EQ(reloaded.files().at("sub/b.json").mtime, index.files().at("sub/b.json").mtime);
+
+    // Caches for other directories are ignored.
+    millijson::DirectoryIndex other(dir + "/sub");
+    EXPECT_FALSE(other.load(cache));
+
+    {
+        std::ofstream output(cache);
+        output << "{\"version\":1,\"directory\":\"" << dir << "\",\"files\":{\"x.json\":{\"size\":\"1\"}}}";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            reloaded.load(cache);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("invalid directory index cache"));
+            throw;
+        }
+    });
+
+    std::filesystem::remove(cache);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/events.hpp"
+#include "millijson/patch.hpp"
+#include "millijson/generate.hpp"
+
+TEST(EventReader, Basic) {
+    std::string foo = " { \"a\": [ 1, \"b\", true, null ], \"c\": {} } ";
+    millijson::RawReader input(foo.c_str(), foo.size());
+    millijson::EventReader<millijson::RawReader> reader(input);
+
+    EXPECT_EQ(reader.next(), millijson::Event::START_OBJECT);
+    EXPECT_EQ(reader.position(), 1);
+    EXPECT_EQ(reader.depth(), 1);
+
+    EXPECT_EQ(reader.next(), millijson::Event::KEY);
+    EXPECT_EQ(reader.get_string(), "a");
+    EXPECT_EQ(reader.next(), millijson::Event::START_ARRAY);
+    EXPECT_EQ(reader.position(), 8);
+    EXPECT_EQ(reader.depth(), 2);
+    EXPECT_EQ(reader.next(), millijson::Event::NUMBER);
+    EXPECT_EQ(reader.get_number(), 1);
+    EXPECT_EQ(reader.next(), millijson::Event::STRING);
+    EXPECT_EQ(reader.get_string(), "b");
+    EXPECT_EQ(reader.next(), millijson::Event::BOOLEAN);
+    EXPECT_TRUE(reader.get_boolean());
+    EXPECT_EQ(reader.next(), millijson::Event::NOTHING);
+    EXPECT_EQ(reader.next(), millijson::Event::END_ARRAY);
+    EXPECT_EQ(reader.depth(), 1);
+
+    EXPECT_EQ(reader.next(), millijson::Event::KEY);
+    EXPECT_EQ(reader.get_string(), "c");
+    EXPECT_EQ(reader.next(), millijson::Event::START_OBJECT);
+    EXPECT_EQ(reader.next(), millijson::Event::END_OBJECT);
+    EXPECT_EQ(reader.next(), millijson::Event::END_OBJECT);
+    EXPECT_EQ(reader.next(), millijson::Event::END);
+    EXPECT_EQ(reader.next(), millijson::Event::END);
+}
+
+TEST(EventReader, Scalar) {
+    std::string foo = "-1.5";
+    millijson::RawReader input(foo.c_str(), foo.size());
+    millijson::EventReader<millijson::RawReader> reader(input);
+    EXPECT_EQ(reader.next(), millijson::Event::NUMBER);
+    EXPECT_EQ(reader.get_number(), -1.5);
+    EXPECT_EQ(reader.next(), millijson::Event::END);
+}
+
+static void consume_all(const std::string& x) {
+    millijson::RawReader input(x.c_str(), x.size());
+    millijson::EventReader<millijson::RawReader> reader(input);
+    while (reader.next() != millijson::Event::END) {}
+}
+
+TEST(EventReader, Errors) {
+    std::vector<std::pair<std::string, std::string> > cases {
+        { "", "no JSON value" },
+        { "[1, 2", "unterminated array starting at position 1" },
+        { "[1, 2,", "unterminated array" },
+        { " {\"a\": 1", "unterminated object starting at position 2" },
+        { "{\"a\" 1}", "expected ':'" },
+        { "{1: 1}", "expected a string as the object key" },
+        { "{\"a\": 1, \"a\": 2}", "duplicate keys" },
+        { "[1 2]", "unknown character '2' in array" },
+        { "{\"a\": 1 \"b\"}", "unknown character '\"' in object" },
+        { "[tru]", "expected a 'true'" },
+        { "[nul]", "expected a 'null'" },
+        { "[fals]", "expected a 'false'" },
+        { "[1.]", "must be followed by at least one digit" },
+        { "-", "incomplete number" },
+        { "[x]", "unknown type starting with 'x'" },
+        { "[1] 2", "trailing non-space" }
+    };
+
+    for (const auto& c : cases) {
+        EXPECT_ANY_THROW({
+            try {
+                consume_all(c.first);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr(c.second));
+                throw;
+            }
+        });
+
+        // Same validity as the DOM parser.
+        EXPECT_ANY_THROW(millijson::parse_string(c.first.c_str(), c.first.size()));
+    }
+}
+
+TEST(EventReader, Collect) {
+    for (size_t seed = 0; seed < 10; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.depth = 4;
+        opt.escape_density = 0.1;
+        auto doc = millijson::generate_string(opt);
+
+        millijson::RawReader input(doc.c_str(), doc.size());
+        millijson::EventReader<millijson::RawReader> reader(input);
+        auto collected = millijson::collect(reader, reader.next());
+        EXPECT_EQ(reader.next(), millijson::Event::END);
+
+        auto ref = millijson::parse_string(doc.c_str(), doc.size());
+        EXPECT_TRUE(millijson::equal(*collected, *ref));
+
+        // Round-tripping through the DOM reader.
+        millijson::DomEventReader dom(*ref);
+        auto recollected = millijson::collect(dom, dom.next());
+        EXPECT_EQ(dom.next(), millijson::Event::END);
+        EXPECT_TRUE(millijson::equal(*recollected, *ref));
+    }
+}
+
+TEST(EventReader, Skip) {
+    std::string foo = "[ [ 1, { \"a\": [] } ], 2 ]";
+    millijson::RawReader input(foo.c_str(), foo.size());
+    millijson::EventReader<millijson::RawReader> reader(input);
+    EXPECT_EQ(reader.next(), millijson::Event::START_ARRAY);
+    millijson::skip(reader, reader.next());
+    EXPECT_EQ(reader.next(), millijson::Event::NUMBER);
+    EXPECT_EQ(reader.get_number(), 2);
+
+    auto ptr = millijson::parse_string(foo.c_str(), foo.size());
+    millijson::DomEventReader dom(*ptr);
+    EXPECT_EQ(dom.next(), millijson::Event::START_ARRAY);
+    millijson::skip(dom, dom.next());
+    EXPECT_EQ(dom.next(), millijson::Event::NUMBER);
+    EXPECT_EQ(dom.get_number(), 2);
+    EXPECT_EQ(dom.next(), millijson::Event::END_ARRAY);
+    EXPECT_EQ(dom.next(), millijson::Event::END);
+}
+
+TEST(EventReader, SkipRaw) {
+    std::string foo = "[ { \"a\": [1] }, 2 ]";
+    millijson::RawReader input(foo.c_str(), foo.size());
+    millijson::EventReader<millijson::RawReader> reader(input);
+    EXPECT_EQ(reader.next(), millijson::Event::START_ARRAY);
+    EXPECT_EQ(reader.next(), millijson::Event::START_OBJECT);
+    EXPECT_EQ(reader.raw_available(), foo.size() - 3);
+    EXPECT_EQ(std::string(reader.raw_pointer(), 11), " \"a\": [1] }");
+    reader.skip_raw(11);
+    EXPECT_EQ(reader.position(), 13);
+    EXPECT_EQ(reader.next(), millijson::Event::NUMBER);
+    EXPECT_EQ(reader.next(), millijson::Event::END_ARRAY);
+    EXPECT_EQ(reader.next(), millijson::Event::END);
+}
+
+TEST(EventReader, DomSorted) {
+    std::string foo = "{ \"c\": 1, \"a\": { \"z\": 2, \"b\": 3 }, \"b\": 4 }";
+    auto ptr = millijson::parse_string(foo.c_str(), foo.size());
+    millijson::DomEventReader dom(*ptr, true);
+
+    std::vector<std::string> keys;
+    while (1) {
+        auto event = dom.next();
+        if (event == millijson::Event::END) {
+            break;
+        } else if (event == millijson::Event::KEY) {
+            keys.push_back(dom.get_string());
+        }
+    }
+    EXPECT_EQ(keys, std::vector<std::string>({ "a", "b", "z", "b", "c" }));
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
 #include "millijson/millijson.hpp"
 #include "byteme/byteme.hpp"
 
@@ -84,6 +87,25 @@ TEST_P(FileParsingTest, BytemeCompatibility) {
     EXPECT_EQ((it->second)->type(), millijson::NOTHING);
 }
 
+TEST_P(FileParsingTest, EscapeDenseStrings) {
+    // Escapes are split across buffer refills for small buffer sizes.
+    std::string foo = "[\"", expected;
+    for (size_t i = 0; i < 20; ++i) {
+        foo += "a\\\\b\\\"\\u00e9\\u2665\\t";
+        expected += "a\\b\"\u00e9\u2665\t";
+    }
+    foo += "\", \"\\\\\"]";
+    {
+        std::ofstream output("TEST.json");
+        output << foo;
+    }
+
+    auto output = millijson::parse_file("TEST.json", GetParam());
+    const auto& array = output->get_array();
+    EXPECT_EQ(array[0]->get_string(), expected);
+    EXPECT_EQ(array[1]->get_string(), "\\");
+}
+
 INSTANTIATE_TEST_SUITE_P(
     FileParsing,
     FileParsingTest,
@@ -100,3 +122,170 @@ TEST(FileParsing, Errors) {
         }
     });
 }
+
+TEST(FileParsing, BufferPool) {
+    millijson::BufferPool pool(2, 100);
+    auto first = pool.acquire(50);
+    EXPECT_EQ(first.size(), 50);
+    auto ptr = first.data();
+    pool.release(std::move(first));
+    EXPECT_EQ(pool.idle(), 1);
+
+    // Reused for smaller requests.
+    auto second = pool.acquire(20);
+    EXPECT_EQ(second.size(), 20);
+    EXPECT_EQ(second.data(), ptr);
+    EXPECT_EQ(pool.idle(), 0);
+
+    // Best fit is chosen.
+    pool.release(std::move(second));
+    pool.release(std::vector<char>(30));
+    auto third = pool.acquire(25);
+    EXPECT_EQ(third.capacity(), 30);
+    auto fourth = pool.acquire(25);
+    EXPECT_EQ(fourth.data(), ptr);
+
+    // Respects the limits.
+    pool.release(std::vector<char>(200));
+    EXPECT_EQ(pool.idle(), 0);
+    pool.release(std::move(third));
+    pool.release(std::move(fourth));
+    pool.release(std::vector<char>(10));
+    EXPECT_EQ(pool.idle(), 2);
+    EXPECT_EQ(pool.retained_bytes(), 80);
+    pool.clear();
+    EXPECT_EQ(pool.idle(), 0);
+    EXPECT_EQ(pool.retained_bytes(), 0);
+
+    // Respects the limit on the total size.
+    millijson::BufferPool capped(10, 100, 150);
+    capped.release(std::vector<char>(100));
+    capped.release(std::vector<char>(60));
+    EXPECT_EQ(capped.idle(), 1);
+    capped.release(std::vector<char>(50));
+    EXPECT_EQ(capped.idle(), 2);
+    EXPECT_EQ(capped.retained_bytes(), 150);
+    auto fifth = capped.acquire(80);
+    EXPECT_EQ(fifth.capacity(), 100);
+    EXPECT_EQ(capped.retained_bytes(), 50);
+    capped.release(std::vector<char>(60));
+    EXPECT_EQ(capped.retained_bytes(), 110);
+}
+
+TEST(FileParsing, PooledReader) {
+    std::string foo = "{\"a\":[1,2,3],\"b\":\"foo\\nbar\"}";
+    {
+        std::ofstream output("TEST.json");
+        output << foo;
+    }
+
+    millijson::FileReadOptions opt;
+    EXPECT_EQ(opt.pool, nullptr); // pooling is opt-in.
+
+    millijson::BufferPool pool;
+    opt.buffer_size = 7;
+    opt.pool = &pool;
+    for (int i = 0; i < 3; ++i) {
+        auto output = millijson::parse_file("TEST.json", opt);
+        EXPECT_EQ(output->get_object().find("b")->second->get_string(), "foo\nbar");
+        EXPECT_EQ(pool.idle(), 1);
+    }
+    EXPECT_EQ(millijson::validate_file("TEST.json", opt), millijson::OBJECT);
+
+    opt.pool = NULL;
+    auto output = millijson::parse_file("TEST.json", opt);
+    EXPECT_EQ(output->get_object().find("a")->second->get_array().size(), 3);
+}
+
+TEST(FileParsing, SingleRead) {
+    std::string foo = "[\"", expected;
+    for (size_t i = 0; i < 200; ++i) {
+        foo += "a\\\\b\\\"\\u00e9\\u2665\\t";
+        expected += "a\\b\"é♥\t";
+    }
+    foo += "\", 1.5e2, { \"x\": [ true, null ] } ] \n";
+    {
+        std::ofstream output("TEST.json");
+        output << foo;
+    }
+
+    millijson::BufferPool pool;
+    millijson::FileReadOptions opt;
+    opt.single_read = true;
+    opt.pool = &pool;
+    {
+        auto output = millijson::parse_file("TEST.json", opt);
+        const auto& array = output->get_array();
+        EXPECT_EQ(array.size(), 3);
+        EXPECT_EQ(array[0]->get_string(), expected);
+        EXPECT_EQ(array[1]->get_number(), 150);
+        EXPECT_EQ(array[2]->get_object().find("x")->second->get_array().size(), 2);
+        EXPECT_EQ(pool.idle(), 1);
+    }
+
+    // Falls back to chunked reading beyond the limit.
+    opt.single_read_limit = 10;
+    opt.buffer_size = 13;
+    auto output = millijson::parse_file("TEST.json", opt);
+    EXPECT_EQ(output->get_array()[0]->get_string(), expected);
+
+    // Same errors as the chunked reader.
+    {
+        std::ofstream output("TEST.json");
+        output << "[1, 2";
+    }
+    opt.single_read_limit = 1000;
+    EXPECT_ANY_THROW({
+        try {
+            millijson::parse_file("TEST.json", opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("unterminated array"));
+            throw;
+        }
+    });
+
+    // Empty files are handled by the chunked reader.
+    {
+        std::ofstream output("TEST.json");
+    }
+    EXPECT_ANY_THROW(millijson::parse_file("TEST.json", opt));
+}
+
+TEST(FileParsing, ConcurrentPooledReaders) {
+    std::vector<std::string> paths;
+    for (int f = 0; f < 4; ++f) {
+        paths.push_back("TEST-pool" + std::to_string(f) + ".json");
+        std::ofstream output(paths.back());
+        output << "[";
+        for (int i = 0; i < 1000; ++i) {
+            output << (i ? "," : "") << "{\"id\":" << f * 1000 + i << "}";
+        }
+        output << "]";
+    }
+
+    millijson::BufferPool pool(2);
+    std::vector<int> ok(8);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&,t]() -> void {
+            millijson::FileReadOptions opt;
+            opt.pool = &pool;
+            opt.single_read = (t % 2 == 0);
+            opt.buffer_size = 100;
+            bool all = true;
+            for (int r = 0; r < 10; ++r) {
+                int f = (t + r) % 4;
+                auto output = millijson::parse_file(paths[f].c_str(), opt);
+                const auto& array = output->get_array();
+                all = all && array.size() == 1000 && array[999]->get_object().find("id")->second->get_number() == f * 1000 + 999;
+            }
+            ok[t] = all;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    EXPECT_EQ(ok, std::vector<int>(8, 1));
+    EXPECT_LE(pool.idle(), 2);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/flat.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+static const std::string flat_example = "{\"a\":{\"b\":{\"c\":{\"d\":1}},\"bc\":true,\"b!\":null},\"list\":[\"x\",{\"y\":[]}],\"k/~\":\"escaped\",\"empty\":{}}";
+
+static std::vector<std::string> collect_prefix(const millijson::PointerIndex& index, const std::string& prefix) {
+    std::vector<std::string> output;
+    index.for_each_prefix(prefix, [&](const std::string& pointer, const std::shared_ptr<millijson::Base>&) -> void { output.push_back(pointer); });
+    return output;
+}
+
+static void check_flat_index(const millijson::PointerIndex& index) {
+    EXPECT_EQ(index.size(), 13);
+    EXPECT_EQ(index.get("/a/b/c/d")->get_number(), 1);
+    EXPECT_TRUE(index.get("/a/bc")->get_boolean());
+    EXPECT_EQ(index.get("/a/b!")->type(), millijson::NOTHING);
+    EXPECT_EQ(index.get("/list/0")->get_string(), "x");
+    EXPECT_EQ(index.get("/list/1/y")->type(), millijson::ARRAY);
+    EXPECT_EQ(index.get("/k~1~0")->get_string(), "escaped");
+    EXPECT_EQ(index.get("")->type(), millijson::OBJECT);
+    EXPECT_EQ(index.get("/a/b")->get_object().size(), 1);
+
+    EXPECT_FALSE(index.get("/a/b/c/e"));
+    EXPECT_FALSE(index.get("/list/2"));
+    EXPECT_FALSE(index.has("/k/~"));
+    EXPECT_TRUE(index.has("/empty"));
+
+    // Prefix matching respects component boundaries.
+    EXPECT_EQ(collect_prefix(index, "/a/b"), std::vector<std::string>({ "/a/b", "/a/b/c", "/a/b/c/d" }));
+    EXPECT_EQ(collect_prefix(index, "/list"), std::vector<std::string>({ "/list", "/list/0", "/list/1", "/list/1/y" }));
+    EXPECT_EQ(collect_prefix(index, "").size(), 13);
+    EXPECT_TRUE(collect_prefix(index, "/missing").empty());
+}
+
+TEST(PointerIndex, FromDocument) {
+    auto doc = millijson::parse_string(flat_example.c_str(), flat_example.size());
+    millijson::PointerIndex index(doc);
+    check_flat_index(index);
+
+    // Values are shared with the document.
+    EXPECT_EQ(index.get("/a/b/c/d").get(), doc->get_object().find("a")->second->get_object().find("b")->second->get_object().find("c")->second->get_object().find("d")->second.get());
+
+    // Copies are independent of the original.
+    millijson::PointerIndex copy;
+    {
+        millijson::PointerIndex tmp(index);
+        copy = tmp;
+    }
+    check_flat_index(copy);
+}
+
+TEST(PointerIndex, LeavesOnly) {
+    auto doc = millijson::parse_string(flat_example.c_str(), flat_example.size());
+    millijson::PointerIndex index(doc, true);
+    EXPECT_EQ(index.size(), 7);
+    EXPECT_TRUE(index.has("/a/b/c/d"));
+    EXPECT_TRUE(index.has("/list/1/y"));
+    EXPECT_TRUE(index.has("/empty"));
+    EXPECT_FALSE(index.has("/a/b"));
+    EXPECT_FALSE(index.has(""));
+    EXPECT_EQ(collect_prefix(index, "/a"), std::vector<std::string>({ "/a/b!", "/a/b/c/d", "/a/bc" }));
+}
+
+TEST(PointerIndex, DuringParsing) {
+    auto flat = millijson::parse_string_flat(flat_example.c_str(), flat_example.size());
+    check_flat_index(flat.index);
+    EXPECT_EQ(flat.index.get("/a/bc").get(), flat.root->get_object().find("a")->second->get_object().find("bc")->second.get());
+
+    auto leaves = millijson::parse_string_flat(flat_example.c_str(), flat_example.size(), true);
+    EXPECT_EQ(leaves.index.size(), 7);
+
+    {
+        std::ofstream output("TEST-flat.json");
+        output << flat_example;
+    }
+    auto from_file = millijson::parse_file_flat("TEST-flat.json", false, 5);
+    check_flat_index(from_file.index);
+
+    // Same errors as the usual parser.
+    std::string bad = "{\"a\":1,\"a\":2}";
+    EXPECT_ANY_THROW({
+        try {
+            millijson::parse_string_flat(bad.c_str(), bad.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("duplicate keys"));
+            throw;
+        }
+    });
+
+    std::string trailing = "[1] 2";
+    EXPECT_ANY_THROW(millijson::parse_string_flat(trailing.c_str(), trailing.size()));
+}
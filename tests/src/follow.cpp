@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include "millijson/follow.hpp"
+
+static void append(const std::string& path, const std::string& contents) {
+    std::ofstream output(path, std::ios::app | std::ios::binary);
+    output << contents;
+}
+
+TEST(NdjsonFollower, Basic) {
+    std::string path = "TEST-follow.ndjson";
+    { std::ofstream output(path, std::ios::trunc); }
+
+    millijson::NdjsonFollower follower(path, 0, 7);
+    std::vector<std::shared_ptr<millijson::Base> > records;
+    std::vector<size_t> offsets;
+    auto collect = [&](std::shared_ptr<millijson::Base> rec, size_t off) -> void {
+        records.push_back(std::move(rec));
+        offsets.push_back(off);
+    };
+
+    EXPECT_EQ(follower.poll(collect), 0);
+
+    append(path, "{\"a\":1}\n[1,2,3]\n\n{\"b\":");
+    EXPECT_EQ(follower.poll(collect), 2);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0]->type(), millijson::OBJECT);
+    EXPECT_EQ(records[1]->get_array().size(), 3);
+    EXPECT_EQ(offsets[0], 0);
+    EXPECT_EQ(offsets[1], 8);
+    EXPECT_EQ(follower.offset(), 17); // partial record is held back.
+
+    EXPECT_EQ(follower.poll(collect), 0);
+    append(path, "\"xyz\"}\n");
+    EXPECT_EQ(follower.poll(collect), 1);
+    EXPECT_EQ(records.back()->get_object().find("b")->second->get_string(), "xyz");
+    EXPECT_EQ(offsets.back(), 17);
+
+    // Resuming from a saved offset.
+    append(path, "true\n");
+    millijson::NdjsonFollower resumed(path, follower.offset());
+    std::vector<millijson::Type> types;
+    EXPECT_EQ(resumed.poll([&](std::shared_ptr<millijson::Base> rec, size_t) -> void { types.push_back(rec->type()); }), 1);
+    EXPECT_EQ(types.front(), millijson::BOOLEAN);
+}
+
+TEST(NdjsonFollower, Errors) {
+    std::string path = "TEST-follow.ndjson";
+    {
+        std::ofstream output(path, std::ios::trunc);
+        output << "1\n[\n2\n";
+    }
+
+    millijson::NdjsonFollower follower(path);
+    std::vector<double> values;
+    auto collect = [&](std::shared_ptr<millijson::Base> rec, size_t) -> void { values.push_back(rec->get_number()); };
+    EXPECT_ANY_THROW({
+        try {
+            follower.poll(collect);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("record at offset 2"));
+            throw;
+        }
+    });
+
+    // Continues after the invalid record.
+    EXPECT_EQ(follower.poll(collect), 1);
+    EXPECT_EQ(values, std::vector<double>({ 1, 2 }));
+
+    // Handles truncation.
+    {
+        std::ofstream output(path, std::ios::trunc);
+        output << "3\n";
+    }
+    EXPECT_EQ(follower.poll(collect), 1);
+    EXPECT_EQ(values.back(), 3);
+
+    EXPECT_ANY_THROW(millijson::NdjsonFollower("TEST-follow-missing.ndjson"));
+}
+
+TEST(NdjsonFollower, Wait) {
+    std::string path = "TEST-follow-wait.ndjson";
+    { std::ofstream output(path, std::ios::trunc); }
+
+    millijson::NdjsonFollower follower(path);
+    size_t count = 0;
+    auto collect = [&](std::shared_ptr<millijson::Base>, size_t) -> void { ++count; };
+    EXPECT_EQ(follower.wait(collect, std::chrono::milliseconds(10)), 0);
+
+    std::thread writer([&]() -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        append(path, "{\"x\": ");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        append(path, "null}\n");
+    });
+
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (total == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        total += follower.wait(collect, std::chrono::milliseconds(5000));
+    }
+    writer.join();
+    EXPECT_EQ(total, 1);
+    EXPECT_EQ(count, 1);
+}
+
+TEST(NdjsonFollower, ThrowingCallback) {
+    std::string path = "TEST-follow-throw.ndjson";
+    { std::ofstream output(path, std::ios::trunc); }
+    append(path, "1\n2\n3\n4\n");
+
+    millijson::NdjsonFollower follower(path);
+    std::vector<double> seen;
+    bool fail = true;
+    auto collect = [&](std::shared_ptr<millijson::Base> rec, size_t) -> void {
+        if (fail && rec->get_number() == 3) {
+            throw std::runtime_error("oops");
+        }
+        seen.push_back(rec->get_number());
+    };
+
+    EXPECT_ANY_THROW(follower.poll(collect));
+    EXPECT_EQ(seen, std::vector<double>({ 1, 2 }));
+    EXPECT_EQ(follower.offset(), 4);
+
+    // Delivered records are not repeated, but the failed record is.
+    fail = false;
+    append(path, "5\n");
+    EXPECT_EQ(follower.poll(collect), 3);
+    EXPECT_EQ(seen, std::vector<double>({ 1, 2, 3, 4, 5 }));
+    EXPECT_EQ(follower.offset(), 10);
+
+    std::remove(path.c_str());
+}
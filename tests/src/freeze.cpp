@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/freeze.hpp"
+
+#include <memory>
+
+TEST(Freeze, Basic) {
+    std::string foo = "[ { \"foo\": \"bar\", \"apple\": [ true, false ], \"zebra\": null }, 1e-2, [ null, 98765 ], \"advancer\", {} ]";
+    auto ptr = millijson::parse_string(foo.c_str(), foo.size());
+    auto frozen = millijson::freeze(*ptr);
+
+    auto root = frozen.root();
+    EXPECT_EQ(root.type(), millijson::ARRAY);
+    EXPECT_EQ(root.size(), 5);
+
+    // Checking the first object, which should have sorted keys.
+    auto obj = root.element(0);
+    EXPECT_EQ(obj.type(), millijson::OBJECT);
+    EXPECT_EQ(obj.size(), 3);
+    EXPECT_EQ(obj.key(0), "apple");
+    EXPECT_EQ(obj.key(1), "foo");
+    EXPECT_EQ(obj.key(2), "zebra");
+
+    EXPECT_EQ(obj.find("foo"), 1);
+    EXPECT_TRUE(obj.has("zebra"));
+    EXPECT_FALSE(obj.has("banana"));
+    EXPECT_EQ(obj.find("zzz"), 3);
+    EXPECT_EQ(obj.element(1).type(), millijson::STRING);
+    EXPECT_EQ(obj.element(1).get_string(), "bar");
+    EXPECT_EQ(obj.element(2).type(), millijson::NOTHING);
+
+    auto bools = obj.element(obj.find("apple"));
+    EXPECT_EQ(bools.type(), millijson::ARRAY);
+    EXPECT_EQ(bools.size(), 2);
+    EXPECT_TRUE(bools.element(0).get_boolean());
+    EXPECT_FALSE(bools.element(1).get_boolean());
+
+    // Checking the rest.
+    EXPECT_EQ(root.element(1).type(), millijson::NUMBER);
+    EXPECT_EQ(root.element(1).get_number(), 0.01);
+
+    auto arr = root.element(2);
+    EXPECT_EQ(arr.size(), 2);
+    EXPECT_EQ(arr.element(0).type(), millijson::NOTHING);
+    EXPECT_EQ(arr.element(1).get_number(), 98765);
+
+    EXPECT_EQ(root.element(3).get_string(), "advancer");
+
+    auto empty = root.element(4);
+    EXPECT_EQ(empty.type(), millijson::OBJECT);
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_FALSE(empty.has("foo"));
+}
+
+TEST(Freeze, Scalar) {
+    auto ptr = millijson::parse_string("\"whee\"", 6);
+    auto frozen = millijson::freeze(*ptr);
+    EXPECT_EQ(frozen.root().type(), millijson::STRING);
+    EXPECT_EQ(frozen.root().get_string(), "whee");
+    EXPECT_EQ(frozen.memory(), sizeof(millijson::Frozen) + sizeof(millijson::FrozenNode) + 4);
+}
+
+TEST(Freeze, Compact) {
+    std::string foo = "{ \"a\": [ 1, 2, 3 ], \"bb\": { \"ccc\": \"dddd\" } }";
+    auto ptr = millijson::parse_string(foo.c_str(), foo.size());
+    std::unique_ptr<millijson::Frozen> frozen(new millijson::Frozen(millijson::freeze(*ptr)));
+
+    // One root, two key-value pairs, three array elements, one inner pair; and all keys and strings, i.e., "abbcccdddd".
+    // Both are allocated exactly.
+    EXPECT_EQ(frozen->memory(), sizeof(millijson::Frozen) + (1 + 4 + 3 + 2) * sizeof(millijson::FrozenNode) + 10);
+
+    // Views remain valid after moving the document and destroying the source,
+    // even when the characters would fit in a small-string buffer.
+    auto root = frozen->root();
+    auto moved = std::move(*frozen);
+    frozen.reset();
+    EXPECT_EQ(root.element(root.find("bb")).element(0).get_string(), "dddd");
+    EXPECT_EQ(root.key(0), "a");
+    EXPECT_EQ(moved.root().key(0), "a");
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include <sstream>
+#include "millijson/generate.hpp"
+#include "millijson/millijson.hpp"
+
+TEST(Generate, Deterministic) {
+    millijson::GenerateOptions opt;
+    opt.seed = 42;
+    opt.size = 10000;
+    auto first = millijson::generate_string(opt);
+    auto second = millijson::generate_string(opt);
+    EXPECT_EQ(first, second);
+    EXPECT_GE(first.size(), 10000);
+
+    opt.seed = 43;
+    auto third = millijson::generate_string(opt);
+    EXPECT_NE(first, third);
+}
+
+TEST(Generate, Valid) {
+    for (size_t seed = 0; seed < 20; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.depth = 5;
+        opt.fanout = 8;
+        opt.escape_density = 0.2;
+        opt.pretty = (seed % 2 == 0);
+        opt.numbers = static_cast<millijson::NumberKind>(seed % 4);
+        opt.size = (seed % 3 == 0 ? 0 : 5000);
+
+        auto output = millijson::generate_string(opt);
+        EXPECT_NO_THROW(millijson::parse_string(output.c_str(), output.size()));
+        if (opt.size) {
+            EXPECT_EQ(millijson::validate_string(output.c_str(), output.size()), millijson::ARRAY);
+        }
+        if (opt.pretty && opt.size) {
+            EXPECT_NE(output.find("\n  "), std::string::npos);
+        }
+    }
+}
+
+TEST(Generate, Ndjson) {
+    millijson::GenerateOptions opt;
+    opt.ndjson = true;
+    opt.pretty = true; // ignored.
+    opt.size = 200000; // more than the internal buffer size.
+    opt.string_length = 100;
+
+    auto output = millijson::generate_string(opt);
+    EXPECT_GE(output.size(), 200000);
+
+    std::istringstream input(output);
+    std::string line;
+    size_t nlines = 0;
+    while (std::getline(input, line)) {
+        EXPECT_NO_THROW(millijson::parse_string(line.c_str(), line.size()));
+        ++nlines;
+    }
+    EXPECT_GT(nlines, 1);
+}
+
+TEST(Generate, File) {
+    millijson::GenerateOptions opt;
+    opt.seed = 10;
+    opt.size = 100000;
+    auto written = millijson::generate_file(opt, "TEST-generate.json");
+    EXPECT_GE(written, 100000);
+
+    auto expected = millijson::generate_string(opt);
+    EXPECT_EQ(written, expected.size());
+    std::ifstream input("TEST-generate.json");
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    EXPECT_EQ(buffer.str(), expected);
+
+    EXPECT_EQ(millijson::validate_file("TEST-generate.json"), millijson::ARRAY);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include <cmath>
+#include "millijson/hints.hpp"
+
+TEST(CapacityHints, Learning) {
+    millijson::CapacityHints hints;
+
+    std::string foo = "[ { \"a\": 1, \"b\": 2 }, { \"a\": [1,2,3,4] }, [] ]";
+    auto output = millijson::parse_string(foo.c_str(), foo.size(), hints);
+    EXPECT_EQ(output->get_array().size(), 3);
+
+    ASSERT_EQ(hints.arrays.size(), 3);
+    EXPECT_EQ(hints.arrays[0], 3);
+    EXPECT_EQ(hints.arrays[1], 0);
+    EXPECT_EQ(hints.arrays[2], 4);
+    ASSERT_EQ(hints.objects.size(), 2);
+    EXPECT_EQ(hints.objects[0], 0);
+    EXPECT_EQ(hints.objects[1], 1.5);
+
+    // Storage is reserved on the next parse.
+    std::string bar = "[ 1, 2 ]";
+    auto output2 = millijson::parse_string(bar.c_str(), bar.size(), hints);
+    EXPECT_GE(output2->get_array().capacity(), 3);
+    EXPECT_EQ(output2->get_array().size(), 2);
+    EXPECT_EQ(hints.arrays[0], 2.5);
+    EXPECT_EQ(hints.arrays[2], 4); // unchanged as nothing was observed.
+}
+
+TEST(CapacityHints, WarmStart) {
+    millijson::CapacityHints hints;
+    hints.arrays = std::vector<double>{ 100 };
+    hints.objects = std::vector<double>{ 0, 50 };
+
+    std::string foo = "[ { \"a\": 1 } ]";
+    auto output = millijson::parse_string(foo.c_str(), foo.size(), hints);
+    EXPECT_GE(output->get_array().capacity(), 100);
+    EXPECT_GE(output->get_array()[0]->get_object().bucket_count(), 50);
+
+    // Checking that the files work too.
+    {
+        std::ofstream out("TEST-hints.json");
+        out << foo << std::endl;
+    }
+    auto output2 = millijson::parse_file("TEST-hints.json", hints, 3);
+    EXPECT_EQ(output2->get_array().size(), 1);
+}
+
+TEST(CapacityHints, Errors) {
+    millijson::CapacityHints hints;
+    std::string foo = "[ { \"a\": 1 ]";
+    EXPECT_ANY_THROW(millijson::parse_string(foo.c_str(), foo.size(), hints));
+    EXPECT_TRUE(hints.arrays.empty());
+}
+
+TEST(CapacityHints, InvalidImports) {
+    millijson::CapacityHints hints;
+    hints.arrays = std::vector<double>{ -5, std::nan(""), 1e300 };
+    hints.weight = std::nan("");
+    hints.max_reserve = 1000;
+
+    EXPECT_EQ(hints.predict(hints.arrays, 0), 0);
+    EXPECT_EQ(hints.predict(hints.arrays, 1), 0);
+    EXPECT_EQ(hints.predict(hints.arrays, 2), 1000);
+
+    std::string foo = "[ [ [ 1, 2 ] ] ]";
+    auto output = millijson::parse_string(foo.c_str(), foo.size(), hints);
+    EXPECT_LE(output->get_array()[0]->get_array()[0]->get_array().capacity(), 1000);
+
+    // Invalid predictions are replaced, rather than mixed with the observed sizes.
+    EXPECT_EQ(hints.arrays[0], 1);
+    EXPECT_EQ(hints.arrays[1], 1);
+    EXPECT_EQ(hints.arrays[2], 0.5 * 2 + 0.5 * 1e300);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/incremental.hpp"
+
+static std::string apply_edit(const std::string& x, size_t start, size_t old_length, const std::string& replacement) {
+    return x.substr(0, start) + replacement + x.substr(start + old_length);
+}
+
+TEST(Incremental, Spans) {
+    std::string foo = "  { \"foo\": [ 1, [2], {\"a\": null} ], \"bar\": \"x\" } ";
+    auto doc = millijson::parse_spanned(foo.c_str(), foo.size());
+    EXPECT_EQ(doc.offset, 2);
+    EXPECT_EQ(doc.root->length, foo.size() - 3);
+    EXPECT_EQ(doc.root->value->type(), millijson::OBJECT);
+
+    ASSERT_EQ(doc.root->keys.size(), 2);
+    EXPECT_EQ(doc.root->keys[0], "foo");
+    EXPECT_EQ(doc.root->keys[1], "bar");
+    EXPECT_EQ(foo[doc.offset + doc.root->offsets[0]], '[');
+    EXPECT_EQ(foo[doc.offset + doc.root->offsets[1]], '"');
+    EXPECT_TRUE(doc.root->children[1] == nullptr);
+
+    const auto& arr = *(doc.root->children[0]);
+    EXPECT_EQ(arr.length, 23);
+    EXPECT_EQ(arr.offsets.size(), 3);
+    EXPECT_TRUE(arr.children[0] == nullptr);
+    EXPECT_EQ(arr.children[1]->length, 3);
+    EXPECT_EQ(arr.children[2]->length, 11);
+
+    // Scalars work as well.
+    auto scalar = millijson::parse_spanned(" 123 ", 5);
+    EXPECT_EQ(scalar.offset, 1);
+    EXPECT_EQ(scalar.root->length, 3);
+    EXPECT_EQ(scalar.root->value->get_number(), 123);
+}
+
+TEST(Incremental, Reparse) {
+    std::string foo = "{ \"foo\": [ 1, [2, 3], {\"a\": null} ], \"bar\": { \"x\": \"y\" } }";
+    auto doc = millijson::parse_spanned(foo.c_str(), foo.size());
+
+    // Modifying the inner array.
+    size_t pos = foo.find("3]");
+    auto foo2 = apply_edit(foo, pos, 1, "345, 6");
+    auto doc2 = millijson::reparse(doc, foo2.c_str(), foo2.size(), { millijson::Edit{ pos, 1, 6 } });
+
+    const auto& obj = doc2.root->value->get_object();
+    const auto& arr = obj.find("foo")->second->get_array();
+    const auto& inner = arr[1]->get_array();
+    ASSERT_EQ(inner.size(), 3);
+    EXPECT_EQ(inner[1]->get_number(), 345);
+    EXPECT_EQ(inner[2]->get_number(), 6);
+
+    // Untouched subtrees are shared.
+    EXPECT_EQ(doc2.root->children[1], doc.root->children[1]);
+    EXPECT_EQ(obj.find("bar")->second, doc.root->value->get_object().find("bar")->second);
+    EXPECT_EQ(arr[2], doc.root->value->get_object().find("foo")->second->get_array()[2]);
+    EXPECT_NE(doc2.root->value, doc.root->value);
+
+    // Spans are updated.
+    auto ref = millijson::parse_spanned(foo2.c_str(), foo2.size());
+    EXPECT_EQ(doc2.root->length, ref.root->length);
+    EXPECT_EQ(doc2.root->offsets, ref.root->offsets);
+    EXPECT_EQ(doc2.root->children[0]->offsets, ref.root->children[0]->offsets);
+
+    // Chaining another edit on the shifted document.
+    pos = foo2.find("\"y\"");
+    auto foo3 = apply_edit(foo2, pos, 3, "[true]");
+    auto doc3 = millijson::reparse(doc2, foo3.c_str(), foo3.size(), { millijson::Edit{ pos, 3, 6 } });
+    const auto& bar = doc3.root->value->get_object().find("bar")->second->get_object();
+    EXPECT_EQ(bar.find("x")->second->type(), millijson::ARRAY);
+    EXPECT_EQ(doc3.root->children[0], doc2.root->children[0]);
+}
+
+TEST(Incremental, Fallback) {
+    std::string foo = "[ [1, 2], [3, 4] ]";
+    auto doc = millijson::parse_spanned(foo.c_str(), foo.size());
+
+    // Splitting the first inner array into two, which can't be handled by the inner array alone.
+    size_t pos = foo.find(", 2");
+    auto foo2 = apply_edit(foo, pos, 1, "], [");
+    auto doc2 = millijson::reparse(doc, foo2.c_str(), foo2.size(), { millijson::Edit{ pos, 1, 4 } });
+    const auto& arr = doc2.root->value->get_array();
+    EXPECT_EQ(arr.size(), 3);
+    EXPECT_EQ(arr[1]->get_array()[0]->get_number(), 2);
+
+    // Modifying the root's brackets requires a full reparse.
+    auto foo3 = "{\"a\": " + foo + "}";
+    auto doc3 = millijson::reparse(doc, foo3.c_str(), foo3.size(), { millijson::Edit{ 0, 0, 6 }, millijson::Edit{ foo.size(), 0, 1 } });
+    EXPECT_EQ(doc3.root->value->type(), millijson::OBJECT);
+
+    // Errors are still reported.
+    auto foo4 = apply_edit(foo, 3, 1, "x");
+    EXPECT_ANY_THROW({
+        try {
+            millijson::reparse(doc, foo4.c_str(), foo4.size(), { millijson::Edit{ 3, 1, 1 } });
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("unknown type starting with 'x' at position 4"));
+            throw;
+        }
+    });
+}
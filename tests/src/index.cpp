@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/index.hpp"
+
+#include <string>
+#include <vector>
+
+static std::shared_ptr<millijson::Base> parse_index_json(const std::string& x) {
+    return millijson::parse_string(x.c_str(), x.size());
+}
+
+TEST(ArrayIndex, SingleKey) {
+    auto doc = parse_index_json("[{\"id\":\"a\",\"v\":1},{\"id\":\"b\",\"v\":2},{\"id\":3,\"v\":3},{\"v\":4},5,{\"id\":[1]},{\"id\":\"c\",\"v\":6}]");
+    millijson::ArrayIndex index(*doc, "/id");
+    EXPECT_EQ(index.size(), 4);
+    EXPECT_EQ(index.unique(), 4);
+
+    EXPECT_EQ(index.find("a"), 0);
+    EXPECT_EQ(index.find("b"), 1);
+    EXPECT_EQ(index.find(3), 2);
+    EXPECT_EQ(index.find("c"), 6);
+    EXPECT_EQ(index.find("d"), millijson::ArrayIndex::npos);
+
+    // Types are respected.
+    EXPECT_EQ(index.find("3"), millijson::ArrayIndex::npos);
+
+    millijson::IndexKey key;
+    key.add_string("b");
+    auto element = index.get(key);
+    ASSERT_TRUE(element);
+    EXPECT_EQ(element->get_object().find("v")->second->get_number(), 2);
+
+    key.clear();
+    key.add_string("missing");
+    EXPECT_FALSE(index.get(key));
+}
+
+TEST(ArrayIndex, Scalars) {
+    auto doc = parse_index_json("[{\"id\":true},{\"id\":false},{\"id\":null},{\"id\":-0},{\"id\":1.5}]");
+    millijson::ArrayIndex index(*doc, "/id");
+
+    millijson::IndexKey key;
+    EXPECT_EQ(index.find(key.add_boolean(true)), 0);
+    key.clear();
+    EXPECT_EQ(index.find(key.add_boolean(false)), 1);
+    key.clear();
+    EXPECT_EQ(index.find(key.add_null()), 2);
+    EXPECT_EQ(index.find(0), 3);
+    EXPECT_EQ(index.find(1.5), 4);
+
+    millijson::String str("foo");
+    key.clear();
+    key.add(str);
+    EXPECT_EQ(key.encoded(), millijson::IndexKey().add_string("foo").encoded());
+
+    millijson::Array arr;
+    EXPECT_ANY_THROW(key.add(arr));
+}
+
+TEST(ArrayIndex, Duplicates) {
+    auto doc = parse_index_json("[{\"k\":1},{\"k\":2},{\"k\":1},{\"k\":3},{\"k\":1}]");
+    millijson::ArrayIndex index(*doc, "/k");
+    EXPECT_EQ(index.size(), 5);
+    EXPECT_EQ(index.unique(), 3);
+
+    millijson::IndexKey key;
+    key.add_number(1);
+    EXPECT_EQ(index.find(key), 0);
+    EXPECT_EQ(index.find_all(key), std::vector<size_t>({ 0, 2, 4 }));
+
+    key.clear();
+    key.add_number(3);
+    EXPECT_EQ(index.find_all(key), std::vector<size_t>({ 3 }));
+
+    key.clear();
+    key.add_number(4);
+    EXPECT_TRUE(index.find_all(key).empty());
+}
+
+TEST(ArrayIndex, CompositeKey) {
+    auto doc = parse_index_json("[{\"ns\":\"x\",\"meta\":{\"id\":1}},{\"ns\":\"y\",\"meta\":{\"id\":1}},{\"ns\":\"x\",\"meta\":{\"id\":2}},{\"ns\":\"x\"},{\"ns\":\"z\",\"meta\":[]}]");
+    millijson::ArrayIndex index(*doc, std::vector<std::string>{ "/ns", "/meta/id" });
+    EXPECT_EQ(index.size(), 3);
+
+    EXPECT_EQ(index.find(millijson::IndexKey().add_string("x").add_number(1)), 0);
+    EXPECT_EQ(index.find(millijson::IndexKey().add_string("y").add_number(1)), 1);
+    EXPECT_EQ(index.find(millijson::IndexKey().add_string("x").add_number(2)), 2);
+    EXPECT_EQ(index.find(millijson::IndexKey().add_string("y").add_number(2)), millijson::ArrayIndex::npos);
+    EXPECT_EQ(index.find(millijson::IndexKey().add_number(1).add_string("x")), millijson::ArrayIndex::npos);
+
+    // Components are length-prefixed, so concatenations are not ambiguous.
+    auto doc2 = parse_index_json("[{\"a\":\"xy\",\"b\":\"z\"},{\"a\":\"x\",\"b\":\"yz\"}]");
+    millijson::ArrayIndex index2(*doc2, std::vector<std::string>{ "/a", "/b" });
+    EXPECT_EQ(index2.unique(), 2);
+    EXPECT_EQ(index2.find(millijson::IndexKey().add_string("x").add_string("yz")), 1);
+}
+
+TEST(ArrayIndex, EscapedPaths) {
+    auto doc = parse_index_json("[{\"a/b\":{\"c~d\":\"foo\"}}]");
+    millijson::ArrayIndex index(*doc, "/a~1b/c~0d");
+    EXPECT_EQ(index.find("foo"), 0);
+}
+
+TEST(ArrayIndex, Errors) {
+    auto doc = parse_index_json("{\"a\":1}");
+    EXPECT_ANY_THROW({
+        try {
+            millijson::ArrayIndex index(*doc, "/id");
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("only be constructed for an array"));
+            throw;
+        }
+    });
+
+    auto arr = parse_index_json("[]");
+    EXPECT_ANY_THROW({
+        try {
+            millijson::ArrayIndex index(*arr, std::vector<std::string>{});
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("at least one key path"));
+            throw;
+        }
+    });
+
+    EXPECT_ANY_THROW({
+        try {
+            millijson::ArrayIndex index(*arr, "id");
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("should start with '/'"));
+            throw;
+        }
+    });
+}
+
+TEST(ArrayIndex, ParseIndexed) {
+    std::string catalog = "{\"version\":1,\"items\":[";
+    for (size_t i = 0; i < 1000; ++i) {
+        if (i) {
+            catalog += ",";
+        }
+        catalog += "{\"id\":\"item" + std::to_string(i) + "\",\"price\":" + std::to_string(i * 2) + "}";
+    }
+    catalog += "]}";
+
+    auto res = millijson::parse_string_indexed(catalog.c_str(), catalog.size(), "/items", { "/id" });
+    EXPECT_EQ(res.index.size(), 1000);
+    for (size_t i = 0; i < 1000; i += 37) {
+        auto pos = res.index.find("item" + std::to_string(i));
+        EXPECT_EQ(pos, i);
+        const auto& items = res.root->get_object().find("items")->second->get_array();
+        EXPECT_EQ(items[pos]->get_object().find("price")->second->get_number(), i * 2);
+    }
+
+    EXPECT_ANY_THROW(millijson::parse_string_indexed(catalog.c_str(), catalog.size(), "/version", { "/id" }));
+    EXPECT_ANY_THROW(millijson::parse_string_indexed(catalog.c_str(), catalog.size(), "/missing", { "/id" }));
+}
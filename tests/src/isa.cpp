@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/isa.hpp"
+#include "millijson/millijson.hpp"
+#include "millijson/serialize.hpp"
+
+#include <fstream>
+#include <vector>
+
+static std::vector<millijson::Isa> available_isas() {
+    std::vector<millijson::Isa> output;
+    for (auto isa : { millijson::Isa::SCALAR, millijson::Isa::SSE2, millijson::Isa::AVX2, millijson::Isa::AVX512 }) {
+        if (isa <= millijson::supported_isa()) {
+            output.push_back(isa);
+        }
+    }
+    return output;
+}
+
+class IsaTest : public ::testing::TestWithParam<millijson::Isa> {
+protected:
+    void SetUp() {
+        original = millijson::active_isa();
+        millijson::set_isa(GetParam());
+    }
+
+    void TearDown() {
+        millijson::set_isa(original);
+    }
+
+    millijson::Isa original;
+};
+
+TEST_P(IsaTest, Kernels) {
+    EXPECT_EQ(millijson::active_isa(), GetParam());
+    const auto& kernels = millijson::scan_kernels();
+
+    // Checking every position and length around the vector widths.
+    for (size_t len = 0; len <= 150; ++len) {
+        std::string plain(len, 'a');
+        EXPECT_EQ(kernels.find_special(plain.data(), len), len);
+        std::string spaces(len, ' ');
+        EXPECT_EQ(kernels.skip_whitespace(spaces.data(), len), len);
+
+        for (size_t i = 0; i < len; ++i) {
+            for (char special : { '"', '\\', '\n', '\0', '\x1f' }) {
+                auto copy = plain;
+                copy[i] = special;
+                EXPECT_EQ(kernels.find_special(copy.data(), len), i);
+            }
+
+            // Non-ASCII bytes are plain.
+            auto high = plain;
+            high[i] = '\xe9';
+            EXPECT_EQ(kernels.find_special(high.data(), len), len);
+
+            auto tokens = spaces;
+            tokens[i] = (i % 2 ? '\t' : '\r');
+            EXPECT_EQ(kernels.skip_whitespace(tokens.data(), len), len);
+            tokens[i] = (i % 3 ? '{' : '\x0b');
+            EXPECT_EQ(kernels.skip_whitespace(tokens.data(), len), i);
+        }
+    }
+}
+
+TEST_P(IsaTest, Parsing) {
+    std::string expected;
+    std::string doc = "{\n";
+    for (size_t i = 0; i < 50; ++i) {
+        if (i) {
+            doc += ",\n";
+        }
+        std::string indent(i, i % 2 ? ' ' : '\t');
+        std::string value(i * 3, 'x');
+        value += "\\\"\\u00e9";
+        value += std::string(i, 'y');
+        doc += indent + "\"key" + std::to_string(i) + "\"" + indent + ":" + indent + "[ \"" + value + "\" ,\r\n" + indent + "null ]";
+    }
+    doc += "\n}\n";
+
+    // Comparing to the scalar kernels, which are always available.
+    millijson::set_isa(millijson::Isa::SCALAR);
+    auto ref = millijson::serialize_string(*millijson::parse_string(doc.c_str(), doc.size()));
+    millijson::set_isa(GetParam());
+
+    EXPECT_EQ(millijson::serialize_string(*millijson::parse_string(doc.c_str(), doc.size())), ref);
+
+    {
+        std::ofstream output("TEST-isa.json");
+        output << doc;
+    }
+    for (size_t buffer_size : { 7, 33, 100, 65536 }) {
+        EXPECT_EQ(millijson::serialize_string(*millijson::parse_file("TEST-isa.json", buffer_size)), ref);
+    }
+
+    // Errors are still detected at the same positions.
+    std::string bad = "[\"" + std::string(100, 'a') + "\n\"]";
+    EXPECT_ANY_THROW({
+        try {
+            millijson::parse_string(bad.c_str(), bad.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("string contains ASCII control character at position 103"));
+            throw;
+        }
+    });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Isa,
+    IsaTest,
+    ::testing::ValuesIn(available_isas())
+);
+
+TEST(Isa, Unsupported) {
+    if (millijson::supported_isa() == millijson::Isa::AVX512) {
+        return;
+    }
+    EXPECT_ANY_THROW({
+        try {
+            millijson::set_isa(millijson::Isa::AVX512);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("not supported"));
+            throw;
+        }
+    });
+}
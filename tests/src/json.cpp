@@ -2,6 +2,12 @@
 #include <gmock/gmock.h>
 #include "millijson/millijson.hpp"
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <type_traits>
+
 std::shared_ptr<millijson::Base> parse_raw_json_string(std::string x) {
     return millijson::parse_string(x.c_str(), x.size());
 }
@@ -101,6 +107,53 @@ TEST(JsonParsingTest, StringLoading) {
     parse_raw_json_error(" \"sdasd\tasdasd\"", "string contains ASCII control character at position 8");
 }
 
+// Reader without the optional bulk access methods, to force the byte-by-byte path.
+struct BytewiseReader {
+    BytewiseReader(const char* p, size_t n) : reader(p, n) {}
+    millijson::RawReader reader;
+    char get() const { return reader.get(); }
+    bool valid() const { return reader.valid(); }
+    bool advance() { return reader.advance(); }
+    size_t position() const { return reader.position(); }
+};
+
+TEST(JsonParsingTest, EscapeDenseStrings) {
+    std::string dense = "\"";
+    std::string expected;
+    for (size_t i = 0; i < 200; ++i) {
+        dense += "C:\\\\dir\\\"x\\\"\\u00e9\\u2665\\u0041\\/\\n";
+        expected += "C:\\dir\"x\"\u00e9\u2665A/\n";
+    }
+    dense += "\"";
+
+    auto output = parse_raw_json_string(dense);
+    EXPECT_EQ(output->get_string(), expected);
+
+    BytewiseReader bytewise(dense.c_str(), dense.size());
+    EXPECT_EQ(millijson::parse(bytewise)->get_string(), expected);
+
+    // Errors in the middle of a dense string are still reported at the right position.
+    auto prefix = dense.substr(0, dense.size() - 1);
+    parse_raw_json_error(prefix + "\\q\"", "unrecognized escape '\\q'");
+    parse_raw_json_error(prefix + "\\u00g0\"", "invalid unicode escape detected at position " + std::to_string(prefix.size() + 5));
+    parse_raw_json_error(prefix + "\t\"", "string contains ASCII control character at position " + std::to_string(prefix.size() + 1));
+    parse_raw_json_error(prefix, "unterminated string");
+    parse_raw_json_error(prefix + "\\", "unterminated string");
+    parse_raw_json_error(prefix + "\\u12", "unterminated string");
+
+    // Escaped quotes are not mistaken for the end of the string.
+    auto quotes = parse_raw_json_string("[\"\\\\\", \"\\\\\\\"\"]");
+    EXPECT_EQ(quotes->get_array()[0]->get_string(), "\\");
+    EXPECT_EQ(quotes->get_array()[1]->get_string(), "\\\"");
+
+    // Without a closing quote in the window, the output is not pre-allocated for the entire window.
+    std::string unterminated = "abc\x01" + std::string(1000000, 'x');
+    std::string decoded;
+    EXPECT_EQ(millijson::decode_string_window(unterminated.data(), unterminated.size(), decoded), 3);
+    EXPECT_EQ(decoded, "abc");
+    EXPECT_LT(decoded.capacity(), 1000);
+}
+
 TEST(JsonParsingTest, IntegerLoading) {
     {
         auto output = parse_raw_json_string(" 12345 ");
@@ -410,6 +463,125 @@ TEST(JsonParsingTest, QuickGet) {
     EXPECT_EQ(array[3]->get_string(), "advancer");
 }
 
+TEST(JsonParsingTest, MutableAccess) {
+    auto output = parse_raw_json_string("[ { \"foo\": \"bar\" }, [ 1, 2, 3 ], \"whee\" ]");
+    auto& array = output->get_array();
+    EXPECT_EQ(array.size(), 3);
+
+    // Modifying in place.
+    array[2]->get_string() += "!";
+    EXPECT_EQ(array[2]->get_string(), "whee!");
+    array[0]->get_object().erase("foo");
+    EXPECT_TRUE(array[0]->get_object().empty());
+
+    // Taking ownership of the payloads.
+    auto str = array[2]->take_string();
+    EXPECT_EQ(str, "whee!");
+    EXPECT_TRUE(array[2]->get_string().empty());
+    auto longstr = parse_raw_json_string("\"" + std::string(100, 'x') + "\"");
+    const char* original = longstr->get_string().data();
+    auto stolen = longstr->take_string();
+    EXPECT_EQ(stolen.data(), original); // no copy.
+
+    auto inner = array[1]->take_array();
+    EXPECT_EQ(inner.size(), 3);
+    EXPECT_EQ(inner[2]->get_number(), 3);
+    EXPECT_TRUE(array[1]->get_array().empty());
+
+    auto obj = parse_raw_json_string("{ \"a\": 1, \"b\": null }");
+    auto map = obj->take_object();
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map["b"]->type(), millijson::NOTHING);
+    EXPECT_TRUE(obj->get_object().empty());
+
+    auto everything = output->take_array();
+    EXPECT_EQ(everything.size(), 3);
+    EXPECT_TRUE(output->get_array().empty());
+}
+
+TEST(JsonParsingTest, KeyHash) {
+    // SipHash-1-3 is seeded, so the same key gives different hashes with different seeds.
+    millijson::KeyHash first(1, 2), second(1, 3);
+    EXPECT_EQ(first("foobar"), millijson::KeyHash(1, 2)("foobar"));
+    EXPECT_NE(first("foobar"), second("foobar"));
+    EXPECT_NE(first("foobar"), first("foobaz"));
+    EXPECT_NE(first(""), first(std::string(1, '\0')));
+
+    // Keys are well-distributed across buckets.
+    std::unordered_set<std::string, millijson::KeyHash> keys;
+    for (size_t i = 0; i < 10000; ++i) {
+        keys.insert("key" + std::to_string(i));
+    }
+    size_t largest = 0;
+    for (size_t b = 0; b < keys.bucket_count(); ++b) {
+        largest = std::max(largest, keys.bucket_size(b));
+    }
+    EXPECT_LT(largest, 20);
+
+    // Objects use the keyed hash for duplicate detection.
+    auto output = parse_raw_json_string("{ \"a\": 1, \"b\": 2 }");
+    EXPECT_EQ(output->get_object().size(), 2);
+    parse_raw_json_error("{ \"a\": 1, \"a\": 2 }", "duplicate keys");
+}
+
+TEST(JsonParsingTest, AdversarialKeys) {
+    // Stand-in for an unseeded hash with known collisions: the sum of the bytes, so all anagrams collide.
+    struct UnseededHash {
+        size_t operator()(const std::string& key) const {
+            size_t total = 0;
+            for (auto c : key) {
+                total += static_cast<unsigned char>(c);
+            }
+            return total;
+        }
+    };
+
+    std::vector<std::string> keys;
+    std::string current = "abcdefgh";
+    do {
+        keys.push_back(current);
+    } while (keys.size() < 2000 && std::next_permutation(current.begin(), current.end()));
+
+    // Counting key comparisons as a platform-independent measure of the insertion cost.
+    size_t comparisons = 0;
+    struct CountingEqual {
+        size_t* counter;
+        bool operator()(const std::string& left, const std::string& right) const {
+            ++(*counter);
+            return left == right;
+        }
+    };
+
+    std::unordered_map<std::string, int, UnseededHash, CountingEqual> unseeded(0, UnseededHash(), CountingEqual{ &comparisons });
+    for (const auto& k : keys) {
+        unseeded.emplace(k, 0);
+    }
+    EXPECT_GE(comparisons, keys.size() * (keys.size() - 1) / 2); // quadratic, as every key lands in the same bucket.
+
+    comparisons = 0;
+    std::unordered_map<std::string, int, millijson::KeyHash, CountingEqual> seeded(0, millijson::KeyHash(), CountingEqual{ &comparisons });
+    for (const auto& k : keys) {
+        seeded.emplace(k, 0);
+    }
+    EXPECT_LT(comparisons, keys.size()); // linear, as the keys no longer collide.
+
+    // Same for an actual parse.
+    std::string doc = "{";
+    for (size_t i = 0; i < keys.size(); ++i) {
+        doc += (i ? ",\"" : "\"") + keys[i] + "\":" + std::to_string(i);
+    }
+    doc += "}";
+    auto output = parse_raw_json_string(doc);
+    static_assert(std::is_same<typename std::decay<decltype(output->get_object())>::type, millijson::ObjectMap>::value, "get_object() should return an ObjectMap");
+    const auto& mapping = output->get_object();
+    EXPECT_EQ(mapping.size(), keys.size());
+    size_t largest = 0;
+    for (size_t b = 0; b < mapping.bucket_count(); ++b) {
+        largest = std::max(largest, mapping.bucket_size(b));
+    }
+    EXPECT_LT(largest, 20);
+}
+
 millijson::Type validate_raw_json_string(std::string x) {
     return millijson::validate_string(x.c_str(), x.size());
 }
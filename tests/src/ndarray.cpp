@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/ndarray.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+static millijson::NdArrayDocument parse_nd(const std::string& x, const millijson::NdArrayOptions& options) {
+    return millijson::parse_string_ndarrays(x.c_str(), x.size(), options);
+}
+
+static millijson::NdArrayOptions nd_paths(std::vector<std::string> paths) {
+    millijson::NdArrayOptions opt;
+    opt.paths = std::move(paths);
+    return opt;
+}
+
+static millijson::NdArrayOptions nd_automatic() {
+    millijson::NdArrayOptions opt;
+    opt.automatic = true;
+    return opt;
+}
+
+TEST(NdArray, ByPath) {
+    auto doc = parse_nd("{\"m\":[[1,2,3],[4,5,6]],\"v\":[1.5,2],\"other\":[[1,2]]}", nd_paths({ "/m", "/v" }));
+    ASSERT_EQ(doc.arrays.size(), 2);
+
+    const auto& m = doc.arrays.at("/m");
+    EXPECT_EQ(m.shape, std::vector<size_t>({ 2, 3 }));
+    EXPECT_TRUE(m.integer);
+    EXPECT_EQ(m.integers, std::vector<int64_t>({ 1, 2, 3, 4, 5, 6 }));
+    EXPECT_TRUE(m.doubles.empty());
+    EXPECT_EQ(m.size(), 6);
+    EXPECT_EQ(m.get(4), 5);
+
+    const auto& v = doc.arrays.at("/v");
+    EXPECT_EQ(v.shape, std::vector<size_t>({ 2 }));
+    EXPECT_FALSE(v.integer);
+    EXPECT_EQ(v.doubles, std::vector<double>({ 1.5, 2 }));
+
+    // Extracted arrays are replaced by nulls, others are left alone.
+    const auto& root = doc.root->get_object();
+    EXPECT_EQ(root.at("m")->type(), millijson::NOTHING);
+    EXPECT_EQ(root.at("v")->type(), millijson::NOTHING);
+    EXPECT_EQ(root.at("other")->type(), millijson::ARRAY);
+    EXPECT_EQ(root.at("other")->get_array()[0]->get_array()[1]->get_number(), 2);
+}
+
+TEST(NdArray, HigherDimensions) {
+    auto doc = parse_nd("[[[1,2],[3,4],[5,6]],[[7,8],[9,10],[11,12]]]", nd_paths({ "" }));
+    const auto& arr = doc.arrays.at("");
+    EXPECT_EQ(arr.shape, std::vector<size_t>({ 2, 3, 2 }));
+    EXPECT_EQ(arr.size(), 12);
+    for (size_t i = 0; i < 12; ++i) {
+        EXPECT_EQ(arr.get(i), i + 1);
+    }
+    EXPECT_EQ(doc.root->type(), millijson::NOTHING);
+
+    // Empty dimensions.
+    auto empty = parse_nd("{\"a\":[],\"b\":[[],[]]}", nd_paths({ "/a", "/b" }));
+    EXPECT_EQ(empty.arrays.at("/a").shape, std::vector<size_t>({ 0 }));
+    EXPECT_EQ(empty.arrays.at("/b").shape, std::vector<size_t>({ 2, 0 }));
+}
+
+TEST(NdArray, Integers) {
+    auto doc = parse_nd("{\"a\":[1,-2,1e3],\"b\":[1,2.5],\"c\":[1e300]}", nd_paths({ "/a", "/b", "/c" }));
+    EXPECT_TRUE(doc.arrays.at("/a").integer);
+    EXPECT_EQ(doc.arrays.at("/a").integers, std::vector<int64_t>({ 1, -2, 1000 }));
+    EXPECT_FALSE(doc.arrays.at("/b").integer);
+    EXPECT_FALSE(doc.arrays.at("/c").integer);
+
+    auto opt = nd_paths({ "/a" });
+    opt.integers = false;
+    auto dbl = parse_nd("{\"a\":[1,2]}", opt);
+    EXPECT_FALSE(dbl.arrays.at("/a").integer);
+    EXPECT_EQ(dbl.arrays.at("/a").doubles, std::vector<double>({ 1, 2 }));
+}
+
+TEST(NdArray, Fallback) {
+    auto opt = nd_paths({ "/ragged", "/mixed", "/deep", "/shallow", "/inner" });
+    auto doc = parse_nd("{\"ragged\":[[1,2],[3,4],[5]],\"mixed\":[[1,2],[3,\"a\"],[5,6]],\"deep\":[[1,2],[[3,4]]],\"shallow\":[[1,2],3],\"inner\":[{\"x\":1}]}", opt);
+    EXPECT_TRUE(doc.arrays.empty());
+
+    const auto& root = doc.root->get_object();
+    const auto& ragged = root.at("ragged")->get_array();
+    ASSERT_EQ(ragged.size(), 3);
+    EXPECT_EQ(ragged[0]->get_array()[1]->get_number(), 2);
+    EXPECT_EQ(ragged[1]->get_array()[0]->get_number(), 3);
+    EXPECT_EQ(ragged[2]->get_array().size(), 1);
+    EXPECT_EQ(ragged[2]->get_array()[0]->get_number(), 5);
+
+    const auto& mixed = root.at("mixed")->get_array();
+    ASSERT_EQ(mixed.size(), 3);
+    EXPECT_EQ(mixed[0]->get_array()[0]->get_number(), 1);
+    EXPECT_EQ(mixed[1]->get_array()[0]->get_number(), 3);
+    EXPECT_EQ(mixed[1]->get_array()[1]->get_string(), "a");
+    EXPECT_EQ(mixed[2]->get_array()[1]->get_number(), 6);
+
+    const auto& deep = root.at("deep")->get_array();
+    ASSERT_EQ(deep.size(), 2);
+    EXPECT_EQ(deep[1]->get_array()[0]->get_array()[1]->get_number(), 4);
+
+    const auto& shallow = root.at("shallow")->get_array();
+    ASSERT_EQ(shallow.size(), 2);
+    EXPECT_EQ(shallow[1]->get_number(), 3);
+
+    EXPECT_EQ(root.at("inner")->get_array()[0]->get_object().at("x")->get_number(), 1);
+}
+
+TEST(NdArray, Automatic) {
+    auto doc = parse_nd("{\"meta\":[{\"m\":[[1,2],[3,4]]},{\"m\":[[5]]}],\"tags\":[],\"names\":[\"a\",\"b\"],\"ragged\":[[1,2],[3],[4,5,6],\"x\"],\"n\":1}", nd_automatic());
+
+    EXPECT_EQ(doc.arrays.at("/meta/0/m").shape, std::vector<size_t>({ 2, 2 }));
+    EXPECT_EQ(doc.arrays.at("/meta/1/m").shape, std::vector<size_t>({ 1, 1 }));
+
+    // Each rectangular piece of a ragged array is extracted by itself.
+    EXPECT_EQ(doc.arrays.at("/ragged/0").integers, std::vector<int64_t>({ 1, 2 }));
+    EXPECT_EQ(doc.arrays.at("/ragged/1").integers, std::vector<int64_t>({ 3 }));
+    EXPECT_EQ(doc.arrays.at("/ragged/2").integers, std::vector<int64_t>({ 4, 5, 6 }));
+    EXPECT_EQ(doc.arrays.size(), 5);
+
+    const auto& root = doc.root->get_object();
+    EXPECT_EQ(root.at("tags")->type(), millijson::ARRAY);
+    EXPECT_EQ(root.at("names")->get_array()[1]->get_string(), "b");
+    const auto& ragged = root.at("ragged")->get_array();
+    ASSERT_EQ(ragged.size(), 4);
+    EXPECT_EQ(ragged[0]->type(), millijson::NOTHING);
+    EXPECT_EQ(ragged[3]->get_string(), "x");
+    EXPECT_EQ(root.at("n")->get_number(), 1);
+
+    // Children that disagree with the depth or extents of their siblings are extracted as new nests.
+    {
+        auto deeper = parse_nd("[[[1],[2]],[3,4]]", nd_automatic());
+        ASSERT_EQ(deeper.arrays.size(), 2);
+        EXPECT_EQ(deeper.arrays.at("/0").shape, std::vector<size_t>({ 2, 1 }));
+        EXPECT_EQ(deeper.arrays.at("/1").shape, std::vector<size_t>({ 2 }));
+        EXPECT_EQ(deeper.arrays.at("/1").integers, std::vector<int64_t>({ 3, 4 }));
+        const auto& arr = deeper.root->get_array();
+        ASSERT_EQ(arr.size(), 2);
+        EXPECT_EQ(arr[0]->type(), millijson::NOTHING);
+        EXPECT_EQ(arr[1]->type(), millijson::NOTHING);
+    }
+
+    {
+        auto narrower = parse_nd("[[[1,2]],[[3,4]],[[5]]]", nd_automatic());
+        ASSERT_EQ(narrower.arrays.size(), 3);
+        EXPECT_EQ(narrower.arrays.at("/0").shape, std::vector<size_t>({ 1, 2 }));
+        EXPECT_EQ(narrower.arrays.at("/1").integers, std::vector<int64_t>({ 3, 4 }));
+        EXPECT_EQ(narrower.arrays.at("/2").shape, std::vector<size_t>({ 1, 1 }));
+        EXPECT_EQ(narrower.arrays.at("/2").integers, std::vector<int64_t>({ 5 }));
+    }
+
+    {
+        auto shallower = parse_nd("[[1,2],[[3,4]]]", nd_automatic());
+        ASSERT_EQ(shallower.arrays.size(), 2);
+        EXPECT_EQ(shallower.arrays.at("/0").shape, std::vector<size_t>({ 2 }));
+        EXPECT_EQ(shallower.arrays.at("/1").shape, std::vector<size_t>({ 1, 2 }));
+        EXPECT_EQ(shallower.arrays.at("/1").integers, std::vector<int64_t>({ 3, 4 }));
+    }
+
+    // Ragged children are not extracted, but their rectangular children are.
+    {
+        auto nested = parse_nd("[[[1,2],[3,4]],[[5,6],[7]],[8]]", nd_automatic());
+        EXPECT_EQ(nested.arrays.at("/0").shape, std::vector<size_t>({ 2, 2 }));
+        EXPECT_EQ(nested.arrays.at("/1/0").shape, std::vector<size_t>({ 2 }));
+        EXPECT_EQ(nested.arrays.at("/1/1").shape, std::vector<size_t>({ 1 }));
+        EXPECT_EQ(nested.arrays.at("/2").shape, std::vector<size_t>({ 1 }));
+        EXPECT_EQ(nested.arrays.size(), 4);
+    }
+}
+
+TEST(NdArray, Errors) {
+    // Same errors as the usual parser, inside and outside of the extracted arrays.
+    std::vector<std::string> bad { "[[1,2],[3,4]", "[1 2]", "[1,2.]", "[1,]", "{\"a\":[1,2],\"a\":[3]}", "[1] 2", "" };
+    for (const auto& b : bad) {
+        EXPECT_ANY_THROW(millijson::parse_string(b.c_str(), b.size()));
+        EXPECT_ANY_THROW(parse_nd(b, nd_automatic()));
+    }
+
+    EXPECT_ANY_THROW({
+        try {
+            parse_nd("[[1,2],[3,4}", nd_automatic());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("unknown character '}' in array"));
+            throw;
+        }
+    });
+}
+
+TEST(NdArray, File) {
+    std::string contents = "{\"x\": [ [0.5, 1], [2, 3] ] }";
+    {
+        std::ofstream output("TEST-ndarray.json");
+        output << contents;
+    }
+    auto doc = millijson::parse_file_ndarrays("TEST-ndarray.json", nd_automatic(), 3);
+    EXPECT_EQ(doc.arrays.at("/x").shape, std::vector<size_t>({ 2, 2 }));
+    EXPECT_EQ(doc.arrays.at("/x").doubles, std::vector<double>({ 0.5, 1, 2, 3 }));
+
+    std::string bad = "{\"x\":[[1,2],[3,]]}";
+    EXPECT_ANY_THROW(parse_nd(bad, nd_automatic()));
+    std::string trailing = "[1] 2";
+    EXPECT_ANY_THROW(parse_nd(trailing, nd_automatic()));
+}
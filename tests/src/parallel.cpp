@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <limits>
+#include "millijson/parallel.hpp"
+#include "millijson/generate.hpp"
+
+TEST(SerializeParallel, Basic) {
+    std::string foo = "[ 1, 2, 3, { \"b\": [4, 5, 6, 7], \"a\": {\"x\": true, \"y\": null, \"z\": \"w\"} }, [], {} ]";
+    auto parsed = millijson::parse_string(foo.c_str(), foo.size());
+    auto expected = millijson::serialize_string(*parsed);
+
+    for (size_t chunk : { 1, 2, 3, 100 }) {
+        for (size_t depth : { 0, 1, 2, 5 }) {
+            millijson::ParallelSerializeOptions opt;
+            opt.chunk_size = chunk;
+            opt.plan_depth = depth;
+            opt.num_threads = 3;
+            opt.window = 2;
+            EXPECT_EQ(millijson::serialize_parallel_string(*parsed, opt), expected);
+        }
+    }
+
+    millijson::Number scalar(1.5);
+    EXPECT_EQ(millijson::serialize_parallel_string(scalar), "1.5");
+}
+
+TEST(SerializeParallel, Generated) {
+    for (size_t seed = 0; seed < 5; ++seed) {
+        millijson::GenerateOptions gopt;
+        gopt.seed = seed;
+        gopt.size = 100000;
+        gopt.escape_density = 0.01;
+        auto doc = millijson::generate_string(gopt);
+        auto parsed = millijson::parse_string(doc.c_str(), doc.size());
+        auto expected = millijson::serialize_string(*parsed);
+
+        millijson::ParallelSerializeOptions opt;
+        opt.chunk_size = 50;
+        opt.num_threads = 4;
+        opt.buffer_size = 100;
+
+        std::string output;
+        size_t n = millijson::serialize_parallel(*parsed, [&](const char* ptr, size_t len) -> void { output.append(ptr, len); }, opt);
+        EXPECT_EQ(output, expected);
+        EXPECT_EQ(n, expected.size());
+    }
+}
+
+TEST(SerializeParallel, Error) {
+    auto arr = new millijson::Array;
+    std::shared_ptr<millijson::Base> ptr(arr);
+    for (size_t i = 0; i < 100; ++i) {
+        arr->add(std::shared_ptr<millijson::Base>(new millijson::Number(i == 77 ? std::numeric_limits<double>::quiet_NaN() : i)));
+    }
+
+    millijson::ParallelSerializeOptions opt;
+    opt.chunk_size = 5;
+    opt.window = 1;
+    EXPECT_ANY_THROW({
+        try {
+            millijson::serialize_parallel_string(*ptr, opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("non-finite"));
+            throw;
+        }
+    });
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/patch.hpp"
+
+static std::shared_ptr<millijson::Base> parse_raw(std::string x) {
+    return millijson::parse_string(x.c_str(), x.size());
+}
+
+static void expect_json(const std::shared_ptr<millijson::Base>& observed, std::string expected) {
+    EXPECT_TRUE(millijson::equal(*observed, *parse_raw(expected)));
+}
+
+TEST(Patch, Equal) {
+    EXPECT_TRUE(millijson::equal(*parse_raw("[1, {\"a\": null, \"b\": [true, \"x\"]}]"), *parse_raw("[1, {\"b\": [true, \"x\"], \"a\": null}]")));
+    EXPECT_FALSE(millijson::equal(*parse_raw("[1, 2]"), *parse_raw("[1, 2, 3]")));
+    EXPECT_FALSE(millijson::equal(*parse_raw("{\"a\": 1}"), *parse_raw("{\"b\": 1}")));
+    EXPECT_FALSE(millijson::equal(*parse_raw("{\"a\": 1}"), *parse_raw("{\"a\": 2}")));
+    EXPECT_FALSE(millijson::equal(*parse_raw("true"), *parse_raw("false")));
+    EXPECT_FALSE(millijson::equal(*parse_raw("\"1\""), *parse_raw("1")));
+}
+
+TEST(Patch, MergePatch) {
+    auto doc = parse_raw("{ \"a\": \"b\", \"c\": { \"d\": \"e\", \"f\": \"g\" }, \"big\": [1, 2, 3] }");
+    auto patch = parse_raw("{ \"a\": \"z\", \"c\": { \"f\": null, \"h\": { \"i\": null, \"j\": 1 } } }");
+    auto patched = millijson::merge_patch(doc, patch);
+    expect_json(patched, "{ \"a\": \"z\", \"c\": { \"d\": \"e\", \"h\": { \"j\": 1 } }, \"big\": [1, 2, 3] }");
+
+    // Original is unchanged, and unmodified subtrees are shared.
+    expect_json(doc, "{ \"a\": \"b\", \"c\": { \"d\": \"e\", \"f\": \"g\" }, \"big\": [1, 2, 3] }");
+    EXPECT_EQ(patched->get_object().find("big")->second, doc->get_object().find("big")->second);
+    EXPECT_EQ(patched->get_object().find("c")->second->get_object().find("d")->second, doc->get_object().find("c")->second->get_object().find("d")->second);
+
+    // Non-object patches replace the document.
+    expect_json(millijson::merge_patch(doc, parse_raw("[1]")), "[1]");
+    expect_json(millijson::merge_patch(parse_raw("[1]"), parse_raw("{\"a\": 2}")), "{\"a\": 2}");
+}
+
+TEST(Patch, JsonPatch) {
+    auto doc = parse_raw("{ \"foo\": [ \"bar\", \"baz\" ], \"a/b\": { \"c~d\": 1 }, \"big\": { \"x\": [1, 2, 3] } }");
+
+    auto patched = millijson::apply_patch(doc, *parse_raw(R"([
+        { "op": "add", "path": "/foo/1", "value": "qux" },
+        { "op": "add", "path": "/foo/-", "value": "end" },
+        { "op": "remove", "path": "/foo/0" },
+        { "op": "replace", "path": "/a~1b/c~0d", "value": 2 },
+        { "op": "copy", "from": "/big/x", "path": "/copied" },
+        { "op": "move", "from": "/foo/2", "path": "/moved" },
+        { "op": "test", "path": "/moved", "value": "end" }
+    ])"));
+    expect_json(patched, "{ \"foo\": [ \"qux\", \"baz\" ], \"a/b\": { \"c~d\": 2 }, \"big\": { \"x\": [1, 2, 3] }, \"copied\": [1, 2, 3], \"moved\": \"end\" }");
+
+    // Unmodified subtrees and copies are shared with the original.
+    const auto& orig = doc->get_object();
+    const auto& obj = patched->get_object();
+    EXPECT_EQ(obj.find("big")->second, orig.find("big")->second);
+    EXPECT_EQ(obj.find("copied")->second, orig.find("big")->second->get_object().find("x")->second);
+    expect_json(doc, "{ \"foo\": [ \"bar\", \"baz\" ], \"a/b\": { \"c~d\": 1 }, \"big\": { \"x\": [1, 2, 3] } }");
+
+    // Replacing the root.
+    expect_json(millijson::apply_patch(doc, *parse_raw(R"([{ "op": "replace", "path": "", "value": [] }])")), "[]");
+}
+
+static void patch_error(const std::shared_ptr<millijson::Base>& doc, std::string patch, std::string msg) {
+    EXPECT_ANY_THROW({
+        try {
+            millijson::apply_patch(doc, *parse_raw(patch));
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(Patch, JsonPatchErrors) {
+    auto doc = parse_raw("{ \"foo\": [ \"bar\" ], \"x\": 1 }");
+    patch_error(doc, "{}", "array of operations");
+    patch_error(doc, "[1]", "should be an object");
+    patch_error(doc, "[{ \"path\": \"/x\" }]", "'op' property");
+    patch_error(doc, "[{ \"op\": \"foo\", \"path\": \"/x\" }]", "unknown JSON patch operation");
+    patch_error(doc, "[{ \"op\": \"remove\", \"path\": \"x\" }]", "should start with '/'");
+    patch_error(doc, "[{ \"op\": \"remove\", \"path\": \"/y\" }]", "missing key 'y'");
+    patch_error(doc, "[{ \"op\": \"remove\", \"path\": \"/foo/1\" }]", "out-of-range");
+    patch_error(doc, "[{ \"op\": \"add\", \"path\": \"/foo/01\", \"value\": 1 }]", "invalid array index");
+    patch_error(doc, "[{ \"op\": \"add\", \"path\": \"/foo/\u00e9\", \"value\": 1 }]", "invalid array index"); // non-ASCII bytes are negative chars on most platforms.
+    patch_error(doc, "[{ \"op\": \"add\", \"path\": \"/x/y\", \"value\": 1 }]", "non-container");
+    patch_error(doc, "[{ \"op\": \"add\", \"path\": \"/foo/0\" }]", "'value' property");
+    patch_error(doc, "[{ \"op\": \"replace\", \"path\": \"/z\", \"value\": 1 }]", "missing key 'z'");
+    patch_error(doc, "[{ \"op\": \"test\", \"path\": \"/x\", \"value\": 2 }]", "test failed");
+    patch_error(doc, "[{ \"op\": \"move\", \"from\": \"/foo\", \"path\": \"/foo/0\" }]", "into one of its children");
+    patch_error(doc, "[{ \"op\": \"remove\", \"path\": \"/x~2\" }]", "invalid '~' escape");
+}
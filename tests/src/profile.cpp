@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/profile.hpp"
+
+TEST(Profile, Basic) {
+    std::string foo = "[ { \"a\\n\": -1.5e2 }, \"x\\\"y\", true, null, [ 12 ] ]";
+    auto prof = millijson::profile_string(foo.c_str(), foo.size());
+
+    EXPECT_EQ(prof.bytes, foo.size());
+    EXPECT_EQ(prof.numbers, 2);
+    EXPECT_EQ(prof.strings, 1);
+    EXPECT_EQ(prof.booleans, 1);
+    EXPECT_EQ(prof.nothings, 1);
+    EXPECT_EQ(prof.arrays, 2);
+    EXPECT_EQ(prof.objects, 1);
+    EXPECT_EQ(prof.keys, 1);
+    EXPECT_EQ(prof.max_depth, 2);
+
+    EXPECT_EQ(prof.string_bytes, 5 + 6);
+    EXPECT_EQ(prof.number_bytes, 6 + 2);
+    EXPECT_EQ(prof.escapes, 2);
+    EXPECT_EQ(prof.whitespace_bytes, 11);
+    EXPECT_GT(prof.dom_bytes, 0);
+}
+
+TEST(Profile, Scalar) {
+    auto prof = millijson::profile_string("  123 ", 6);
+    EXPECT_EQ(prof.numbers, 1);
+    EXPECT_EQ(prof.max_depth, 0);
+    EXPECT_EQ(prof.number_bytes, 3);
+    EXPECT_EQ(prof.whitespace_bytes, 3);
+
+    EXPECT_ANY_THROW(millijson::profile_string("[", 1));
+}
+
+TEST(Profile, NonAscii) {
+    std::string foo = "[\"\xc3\xa9\", 12]";
+    auto prof = millijson::profile_string(foo.c_str(), foo.size());
+    EXPECT_EQ(prof.string_bytes, 4);
+    EXPECT_EQ(prof.number_bytes, 2);
+    EXPECT_EQ(prof.whitespace_bytes, 1);
+}
+
+TEST(Profile, MemoryFootprint) {
+    auto small = millijson::parse_string("[1]", 3);
+    auto large = millijson::parse_string("[1,2,3,4]", 9);
+    EXPECT_LT(millijson::memory_footprint(*small), millijson::memory_footprint(*large));
+
+    std::string longstr = "\"" + std::string(1000, 'a') + "\"";
+    auto str = millijson::parse_string(longstr.c_str(), longstr.size());
+    EXPECT_GT(millijson::memory_footprint(*str), 1000);
+
+    auto shortstr = millijson::parse_string("\"a\"", 3);
+    EXPECT_LT(millijson::memory_footprint(*shortstr), 1000);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fstream>
+#include <sstream>
+#include "millijson/rewrite.hpp"
+#include "millijson/generate.hpp"
+
+static std::string rewrite_raw(const std::string& x, const std::vector<millijson::Rewrite>& operations) {
+    return millijson::rewrite_string(x.c_str(), x.size(), operations);
+}
+
+static void expect_rewrite_error(const std::string& x, const std::vector<millijson::Rewrite>& operations, const std::string& msg) {
+    EXPECT_ANY_THROW({
+        try {
+            rewrite_raw(x, operations);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(Rewrite, Untouched) {
+    std::string foo = " { \"a\" : [1, 2.50, \"\\u0041\"], \"b\":{}}\n";
+    EXPECT_EQ(rewrite_raw(foo, {}), foo);
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REPLACE, "/a/1", "3" } }), " { \"a\" : [1, 3, \"\\u0041\"], \"b\":{}}\n");
+}
+
+TEST(Rewrite, Replace) {
+    std::string foo = "{ \"a\": { \"b\": [ 1, {\"c\": 2} ] }, \"d~/\": \"x\" }";
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REPLACE, "/a/b/1/c", "[true]" } }), "{ \"a\": { \"b\": [ 1, {\"c\": [true]} ] }, \"d~/\": \"x\" }");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REPLACE, "/d~0~1", "null" } }), "{ \"a\": { \"b\": [ 1, {\"c\": 2} ] }, \"d~/\": null }");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REPLACE, "", "1" } }), "1");
+    EXPECT_EQ(rewrite_raw(foo, {
+        { millijson::RewriteType::REPLACE, "/a/b/0", "false" },
+        { millijson::RewriteType::REPLACE, "/d~0~1", "0" }
+    }), "{ \"a\": { \"b\": [ false, {\"c\": 2} ] }, \"d~/\": 0 }");
+}
+
+TEST(Rewrite, Remove) {
+    std::string foo = "[1, 2, 3]";
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REMOVE, "/0", "" } }), "[2, 3]");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REMOVE, "/1", "" } }), "[1, 3]");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::REMOVE, "/2", "" } }), "[1, 2]");
+    EXPECT_EQ(rewrite_raw(foo, {
+        { millijson::RewriteType::REMOVE, "/0", "" },
+        { millijson::RewriteType::REMOVE, "/1", "" },
+        { millijson::RewriteType::REMOVE, "/2", "" }
+    }), "[]");
+
+    std::string pretty = "{\n  \"a\": 1,\n  \"b\": [2],\n  \"c\": 3\n}";
+    EXPECT_EQ(rewrite_raw(pretty, { { millijson::RewriteType::REMOVE, "/a", "" } }), "{\n  \"b\": [2],\n  \"c\": 3\n}");
+    EXPECT_EQ(rewrite_raw(pretty, { { millijson::RewriteType::REMOVE, "/b", "" } }), "{\n  \"a\": 1,\n  \"c\": 3\n}");
+    EXPECT_EQ(rewrite_raw(pretty, { { millijson::RewriteType::REMOVE, "/c", "" } }), "{\n  \"a\": 1,\n  \"b\": [2]\n}");
+}
+
+TEST(Rewrite, Insert) {
+    std::string foo = "[1, 2]";
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::INSERT, "/0", "0" } }), "[0,1, 2]");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::INSERT, "/1", "\"x\"" } }), "[1, \"x\", 2]");
+    EXPECT_EQ(rewrite_raw(foo, { { millijson::RewriteType::INSERT, "/2", "3" } }), "[1, 2, 3]");
+    EXPECT_EQ(rewrite_raw(foo, {
+        { millijson::RewriteType::INSERT, "/-", "4" },
+        { millijson::RewriteType::INSERT, "/2", "3" },
+        { millijson::RewriteType::REMOVE, "/0", "" }
+    }), "[2, 3, 4]");
+    EXPECT_EQ(rewrite_raw("[]", { { millijson::RewriteType::INSERT, "/-", "1" } }), "[1]");
+
+    std::string pretty = "{\n  \"a\": 1\n}";
+    EXPECT_EQ(rewrite_raw(pretty, { { millijson::RewriteType::INSERT, "/b\"", "[]" } }), "{\n  \"a\": 1,\n  \"b\\\"\":[]\n}");
+    EXPECT_EQ(rewrite_raw("{}", { { millijson::RewriteType::INSERT, "/a", "1" } }), "{\"a\":1}");
+
+    auto output = rewrite_raw(pretty, { { millijson::RewriteType::INSERT, "/b", "2" }, { millijson::RewriteType::REMOVE, "/a", "" } });
+    auto parsed = millijson::parse_string(output.c_str(), output.size());
+    EXPECT_EQ(parsed->get_object().size(), 1);
+    EXPECT_EQ(parsed->get_object().at("b")->get_number(), 2);
+}
+
+TEST(Rewrite, Errors) {
+    expect_rewrite_error("[1]", { { millijson::RewriteType::REPLACE, "/1", "2" } }, "failed to find '/1'");
+    expect_rewrite_error("{\"a\":1}", { { millijson::RewriteType::REMOVE, "/b", "" } }, "failed to find '/b'");
+    expect_rewrite_error("{\"a\":1}", { { millijson::RewriteType::REPLACE, "/a/b", "2" } }, "failed to find '/a/b'");
+    expect_rewrite_error("{\"a\":1}", { { millijson::RewriteType::INSERT, "/a", "2" } }, "already exists");
+    expect_rewrite_error("1", { { millijson::RewriteType::INSERT, "/a", "2" } }, "failed to find an array or object");
+    expect_rewrite_error("[1]", { { millijson::RewriteType::INSERT, "/3", "2" } }, "cannot insert at index 3");
+    expect_rewrite_error("[1, 2]", { { millijson::RewriteType::INSERT, "/2", "3" }, { millijson::RewriteType::INSERT, "/5", "99" } }, "cannot insert at index 5");
+    expect_rewrite_error("[1]", { { millijson::RewriteType::REPLACE, "/0", "[" } }, "unterminated array");
+    expect_rewrite_error("[1]", { { millijson::RewriteType::REMOVE, "", "" } }, "cannot remove the root");
+    expect_rewrite_error("[[1]]", { { millijson::RewriteType::REMOVE, "/0", "" }, { millijson::RewriteType::REPLACE, "/0/0", "1" } }, "conflicting edits");
+    expect_rewrite_error("[[1]]", { { millijson::RewriteType::REPLACE, "/0/0", "1" }, { millijson::RewriteType::REMOVE, "/0", "" } }, "conflicting edits");
+
+    expect_rewrite_error("[1, [2, 3]", {}, "unterminated array");
+    expect_rewrite_error("{\"a\": [1, 2}", {}, "mismatched");
+    expect_rewrite_error("[\"a]", {}, "unterminated string");
+    expect_rewrite_error("[1] 2", {}, "trailing non-space");
+    expect_rewrite_error("{\"a\" 1}", { { millijson::RewriteType::REPLACE, "/b", "2" } }, "expected ':'");
+    expect_rewrite_error("[1 2]", { { millijson::RewriteType::REPLACE, "/1", "2" } }, "unknown character '2' in array");
+}
+
+TEST(Rewrite, Generated) {
+    for (size_t seed = 0; seed < 10; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.size = 10000;
+        opt.pretty = (seed % 2 == 0);
+        opt.escape_density = 0.05;
+        auto doc = millijson::generate_string(opt);
+
+        auto output = rewrite_raw(doc, {
+            { millijson::RewriteType::REPLACE, "/0", "\"foo\"" },
+            { millijson::RewriteType::REMOVE, "/1", "" },
+            { millijson::RewriteType::INSERT, "/-", "{\"bar\":null}" }
+        });
+
+        auto before = millijson::parse_string(doc.c_str(), doc.size());
+        auto after = millijson::parse_string(output.c_str(), output.size());
+        const auto& barray = before->get_array();
+        const auto& aarray = after->get_array();
+        ASSERT_EQ(aarray.size(), barray.size());
+        EXPECT_EQ(aarray.front()->get_string(), "foo");
+        EXPECT_EQ(aarray.back()->get_object().at("bar")->type(), millijson::NOTHING);
+    }
+}
+
+TEST(Rewrite, File) {
+    millijson::GenerateOptions opt;
+    opt.size = 200000;
+    opt.pretty = true;
+    millijson::generate_file(opt, "TEST-rewrite-in.json");
+
+    millijson::rewrite_file("TEST-rewrite-in.json", "TEST-rewrite-out.json", { { millijson::RewriteType::INSERT, "/0", "\"first\"" } }, 1000);
+
+    std::ifstream input("TEST-rewrite-in.json"), output("TEST-rewrite-out.json");
+    std::stringstream ibuf, obuf;
+    ibuf << input.rdbuf();
+    obuf << output.rdbuf();
+    auto istr = ibuf.str(), ostr = obuf.str();
+
+    // Everything but the first element should be identical.
+    auto prefix = std::string("[\n  \"first\",");
+    ASSERT_EQ(ostr.substr(0, prefix.size()), prefix);
+    EXPECT_EQ(ostr.substr(prefix.size()), istr.substr(1));
+}
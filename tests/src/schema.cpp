@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <thread>
+#include "millijson/schema.hpp"
+#include "millijson/serialize.hpp"
+#include "millijson/generate.hpp"
+
+TEST(Schema, Basic) {
+    millijson::SchemaInferrer inferrer;
+    std::string records =
+        "{ \"id\": 1, \"name\": \"foo\", \"tags\": [\"a\", \"bc\"], \"score\": 1.5 }\n"
+        "\n"
+        "{ \"id\": 20, \"name\": null, \"tags\": [], \"extra\": { \"x\": true } }\n"
+        "{ \"id\": -3, \"name\": \"\", \"tags\": [\"abcdefgh\"] }";
+    EXPECT_EQ(inferrer.add_ndjson(records.c_str(), records.size()), 3);
+    EXPECT_EQ(inferrer.documents(), 3);
+
+    const auto& root = inferrer.root();
+    EXPECT_EQ(root.count, 3);
+    EXPECT_EQ(root.objects, 3);
+    EXPECT_EQ(root.properties.size(), 5);
+
+    const auto& id = *(root.properties.at("id"));
+    EXPECT_EQ(id.numbers, 3);
+    EXPECT_EQ(id.integers, 3);
+    EXPECT_EQ(id.min_number, -3);
+    EXPECT_EQ(id.max_number, 20);
+
+    const auto& name = *(root.properties.at("name"));
+    EXPECT_EQ(name.strings, 2);
+    EXPECT_EQ(name.nulls, 1);
+    EXPECT_EQ(name.min_length, 0);
+    EXPECT_EQ(name.max_length, 3);
+    EXPECT_EQ(name.length_buckets[0], 1);
+    EXPECT_EQ(name.length_buckets[2], 1);
+
+    const auto& tags = *(root.properties.at("tags"));
+    EXPECT_EQ(tags.arrays, 3);
+    EXPECT_EQ(tags.min_items, 0);
+    EXPECT_EQ(tags.max_items, 2);
+    EXPECT_EQ(tags.items->strings, 3);
+    EXPECT_EQ(tags.items->total_length, 11);
+    EXPECT_EQ(tags.items->length_buckets[4], 1);
+
+    EXPECT_EQ(root.properties.at("score")->count, 1);
+    EXPECT_EQ(root.properties.at("score")->integers, 0);
+    EXPECT_EQ(root.properties.at("extra")->properties.at("x")->booleans, 1);
+
+    auto schema = millijson::serialize_string(*inferrer.json_schema());
+    EXPECT_EQ(schema,
+        "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\","
+        "\"properties\":{"
+            "\"extra\":{\"properties\":{\"x\":{\"type\":\"boolean\"}},\"required\":[\"x\"],\"type\":\"object\"},"
+            "\"id\":{\"maximum\":20,\"minimum\":-3,\"type\":\"integer\"},"
+            "\"name\":{\"maxLength\":3,\"minLength\":0,\"type\":[\"null\",\"string\"]},"
+            "\"score\":{\"maximum\":1.5,\"minimum\":1.5,\"type\":\"number\"},"
+            "\"tags\":{\"items\":{\"maxLength\":8,\"minLength\":1,\"type\":\"string\"},\"maxItems\":2,\"minItems\":0,\"type\":\"array\"}"
+        "},"
+        "\"required\":[\"id\",\"name\",\"tags\"],"
+        "\"type\":\"object\"}"
+    );
+
+    std::string broken = "{\"id\": 1}\n[1, 2";
+    EXPECT_ANY_THROW(inferrer.add_ndjson(broken.c_str(), broken.size()));
+}
+
+TEST(Schema, Merge) {
+    millijson::GenerateOptions opt;
+    opt.ndjson = true;
+    opt.size = 50000;
+    auto records = millijson::generate_string(opt);
+
+    millijson::SchemaInferrer serial;
+    size_t n = serial.add_ndjson(records.c_str(), records.size());
+
+    // Splitting the records across threads at a line boundary.
+    size_t mid = records.find('\n', records.size() / 2) + 1;
+    millijson::SchemaInferrer first, second;
+    size_t n1 = 0, n2 = 0;
+    std::thread t1([&]() -> void { n1 = first.add_ndjson(records.c_str(), mid); });
+    std::thread t2([&]() -> void { n2 = second.add_ndjson(records.c_str() + mid, records.size() - mid); });
+    t1.join();
+    t2.join();
+    EXPECT_EQ(n1 + n2, n);
+
+    first.merge(second);
+    EXPECT_EQ(first.documents(), serial.documents());
+    EXPECT_EQ(first.root().count, serial.root().count);
+    EXPECT_EQ(first.root().arrays, serial.root().arrays);
+    EXPECT_EQ(first.root().length_buckets, serial.root().length_buckets);
+    EXPECT_EQ(millijson::serialize_string(*first.json_schema()), millijson::serialize_string(*serial.json_schema()));
+}
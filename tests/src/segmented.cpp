@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/segmented.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+TEST(SegmentedVector, Basic) {
+    millijson::SegmentedVector<int> vec(4);
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(vec.begin(), vec.end());
+
+    for (int i = 0; i < 10; ++i) {
+        vec.push_back(i);
+    }
+    EXPECT_EQ(vec.size(), 10);
+    EXPECT_EQ(vec.num_blocks(), 3);
+    EXPECT_EQ(vec.block_size(), 4);
+    EXPECT_EQ(vec.block(2).size(), 2);
+    EXPECT_EQ(vec.back(), 9);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(vec[i], i);
+    }
+    vec[5] = 50;
+
+    std::vector<int> iterated(vec.begin(), vec.end());
+    EXPECT_EQ(iterated, std::vector<int>({ 0, 1, 2, 3, 4, 50, 6, 7, 8, 9 }));
+
+    const auto& cvec = vec;
+    std::vector<int> citerated;
+    for (auto x : cvec) {
+        citerated.push_back(x);
+    }
+    EXPECT_EQ(citerated, iterated);
+
+    // Blocks after the first are allocated at their full size, so existing elements are never moved.
+    const int* address = &(vec[4]);
+    vec.push_back(10);
+    vec.push_back(11);
+    vec.push_back(12);
+    EXPECT_EQ(&(vec[4]), address);
+    EXPECT_GE(vec.block(1).capacity(), 4);
+
+    auto released = vec.release();
+    EXPECT_EQ(released.size(), 13);
+    EXPECT_EQ(released.capacity(), 13);
+    EXPECT_EQ(released[5], 50);
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(vec.num_blocks(), 0);
+
+    EXPECT_ANY_THROW(millijson::SegmentedVector<int>(0));
+}
+
+TEST(SegmentedVector, Parsing) {
+    std::string doc = " [";
+    for (size_t i = 0; i < 1000; ++i) {
+        if (i) {
+            doc += ", ";
+        }
+        doc += (i % 2 ? "{\"x\":" + std::to_string(i) + "}" : std::to_string(i));
+    }
+    doc += "] \n";
+
+    auto ref = millijson::parse_string(doc.c_str(), doc.size());
+    const auto& expected = ref->get_array();
+
+    for (size_t block_size : { 1, 7, 100, 1000, 65536 }) {
+        auto output = millijson::parse_string_segmented(doc.c_str(), doc.size(), block_size);
+        ASSERT_EQ(output.size(), expected.size());
+        EXPECT_EQ(output.num_blocks(), (expected.size() + block_size - 1) / block_size);
+        for (size_t i = 0; i < expected.size(); i += 99) {
+            if (i % 2) {
+                EXPECT_EQ(output[i]->get_object().find("x")->second->get_number(), expected[i]->get_object().find("x")->second->get_number());
+            } else {
+                EXPECT_EQ(output[i]->get_number(), expected[i]->get_number());
+            }
+        }
+    }
+
+    {
+        std::ofstream output("TEST-segmented.json");
+        output << doc;
+    }
+    auto from_file = millijson::parse_file_segmented("TEST-segmented.json", 64, 13);
+    EXPECT_EQ(from_file.size(), 1000);
+    EXPECT_EQ(from_file[998]->get_number(), 998);
+
+    auto empty = millijson::parse_string_segmented(" [ ] ", 5);
+    EXPECT_TRUE(empty.empty());
+}
+
+static void parse_segmented_error(std::string x, std::string msg) {
+    EXPECT_ANY_THROW({
+        try {
+            millijson::parse_string_segmented(x.c_str(), x.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(SegmentedVector, Errors) {
+    parse_segmented_error("{}", "expected a top-level array at position 1");
+    parse_segmented_error("  ", "expected a top-level array");
+    parse_segmented_error("[1, 2", "unterminated array starting at position 1");
+    parse_segmented_error("[1, ", "unterminated array");
+    parse_segmented_error("[1 2]", "unknown character '2' in array at position 4");
+    parse_segmented_error("[1] 2", "trailing non-space characters at position 5");
+    parse_segmented_error("[{\"a\":1,\"a\":2}]", "duplicate keys");
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <limits>
+#include <cmath>
+#include <clocale>
+#include <string>
+#include "millijson/serialize.hpp"
+#include "millijson/patch.hpp"
+#include "millijson/generate.hpp"
+
+static std::string roundtrip(const std::string& x) {
+    auto parsed = millijson::parse_string(x.c_str(), x.size());
+    return millijson::serialize_string(*parsed);
+}
+
+TEST(Serialize, Scalars) {
+    EXPECT_EQ(roundtrip(" true "), "true");
+    EXPECT_EQ(roundtrip("false"), "false");
+    EXPECT_EQ(roundtrip("null"), "null");
+    EXPECT_EQ(roundtrip("123"), "123");
+    EXPECT_EQ(roundtrip("-0.1"), "-0.1");
+    EXPECT_EQ(roundtrip("1e100"), "1e+100");
+    EXPECT_EQ(roundtrip("\"a\\\"b\\\\c\\n\\u0001\\u00e9\""), "\"a\\\"b\\\\c\\n\\u0001\u00e9\"");
+
+    millijson::Number inf(std::numeric_limits<double>::infinity());
+    EXPECT_ANY_THROW(millijson::serialize_string(inf));
+}
+
+TEST(Serialize, Locale) {
+    std::string previous = std::setlocale(LC_NUMERIC, nullptr);
+    bool found = false;
+    const char* candidates[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "de_DE", "fr_FR" };
+    for (auto name : candidates) {
+        if (std::setlocale(LC_NUMERIC, name)) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        GTEST_SKIP() << "no locale with a comma decimal separator is available";
+    }
+
+    // Numbers should always use a period as the decimal separator.
+    auto output = roundtrip("[1.5, -0.25, 1e-7]");
+    std::setlocale(LC_NUMERIC, previous.c_str());
+    EXPECT_EQ(output, "[1.5,-0.25,1e-07]");
+}
+
+TEST(Serialize, Containers) {
+    EXPECT_EQ(roundtrip("[ 1, [ ], { } ]"), "[1,[],{}]");
+    EXPECT_EQ(roundtrip("{ \"b\": 1, \"a\": [2], \"c\": {\"z\": null, \"y\": \"x\"} }"), "{\"a\":[2],\"b\":1,\"c\":{\"y\":\"x\",\"z\":null}}");
+}
+
+// The parser is not always correctly rounded, so numbers may differ in the last bits after a round trip.
+static bool nearly_equal(const millijson::Base& left, const millijson::Base& right) {
+    if (left.type() != right.type()) {
+        return false;
+    }
+    switch (left.type()) {
+        case millijson::NUMBER:
+            return std::abs(left.get_number() - right.get_number()) <= std::abs(left.get_number()) * 1e-14;
+        case millijson::ARRAY:
+            {
+                const auto& larray = left.get_array();
+                const auto& rarray = right.get_array();
+                if (larray.size() != rarray.size()) {
+                    return false;
+                }
+                for (size_t i = 0; i < larray.size(); ++i) {
+                    if (!nearly_equal(*(larray[i]), *(rarray[i]))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        case millijson::OBJECT:
+            {
+                const auto& lobject = left.get_object();
+                const auto& robject = right.get_object();
+                if (lobject.size() != robject.size()) {
+                    return false;
+                }
+                for (const auto& x : lobject) {
+                    auto it = robject.find(x.first);
+                    if (it == robject.end() || !nearly_equal(*(x.second), *(it->second))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        default:
+            return millijson::equal(left, right);
+    }
+}
+
+TEST(Serialize, Generated) {
+    for (size_t seed = 0; seed < 10; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.depth = 5;
+        opt.escape_density = 0.1;
+        auto doc = millijson::generate_string(opt);
+
+        auto parsed = millijson::parse_string(doc.c_str(), doc.size());
+        auto output = millijson::serialize_string(*parsed);
+        auto reparsed = millijson::parse_string(output.c_str(), output.size());
+        EXPECT_TRUE(nearly_equal(*parsed, *reparsed));
+
+        // Chunked writes give the same output.
+        std::string chunked;
+        size_t n = millijson::serialize(*parsed, [&](const char* ptr, size_t len) -> void { chunked.append(ptr, len); }, 10);
+        EXPECT_EQ(chunked, output);
+        EXPECT_EQ(n, output.size());
+    }
+}
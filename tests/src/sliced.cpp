@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/sliced.hpp"
+#include "millijson/serialize.hpp"
+
+#include <string>
+#include <chrono>
+
+static std::string sliced_example() {
+    std::string doc = "  {\"list\": [";
+    for (size_t i = 0; i < 500; ++i) {
+        if (i) {
+            doc += ", ";
+        }
+        doc += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\\n" + std::to_string(i) + "\", \"ok\": " + (i % 2 ? "true" : "false") + ", \"x\": null, \"nested\": [[], {}, [1.5e2]]}";
+    }
+    doc += "], \"empty\": {}, \"str\": \"\\u00e9\"}\n";
+    return doc;
+}
+
+TEST(SlicedParser, ByteBudget) {
+    auto doc = sliced_example();
+    auto expected = millijson::serialize_string(*millijson::parse_string(doc.c_str(), doc.size()));
+
+    for (size_t budget : { 0, 1, 10, 100, 1000, 1000000 }) {
+        millijson::SlicedParser parser(doc.c_str(), doc.size());
+        EXPECT_EQ(parser.size(), doc.size());
+        EXPECT_FALSE(parser.done());
+        EXPECT_ANY_THROW(parser.result());
+
+        size_t nsteps = 0, last = 0;
+        while (!parser.step(budget)) {
+            ++nsteps;
+            EXPECT_GT(parser.position(), last);
+            last = parser.position();
+        }
+        EXPECT_TRUE(parser.done());
+        EXPECT_EQ(parser.position(), doc.size());
+        EXPECT_EQ(millijson::serialize_string(*parser.result()), expected);
+
+        if (budget >= 10) {
+            EXPECT_LE(nsteps, doc.size() / budget + 1);
+        }
+        if (budget < doc.size()) {
+            EXPECT_GT(nsteps, 0);
+        }
+
+        // Further steps are no-ops.
+        EXPECT_TRUE(parser.step(budget));
+    }
+}
+
+TEST(SlicedParser, TimeBudget) {
+    auto doc = sliced_example();
+    auto expected = millijson::serialize_string(*millijson::parse_string(doc.c_str(), doc.size()));
+
+    millijson::SlicedParser parser(doc.c_str(), doc.size());
+    while (!parser.step_for(std::chrono::microseconds(10), 4)) {}
+    EXPECT_EQ(millijson::serialize_string(*parser.result()), expected);
+
+    millijson::SlicedParser once(doc.c_str(), doc.size());
+    EXPECT_TRUE(once.step_for(std::chrono::seconds(10)));
+    EXPECT_EQ(millijson::serialize_string(*once.result()), expected);
+}
+
+TEST(SlicedParser, Scalars) {
+    for (std::string x : { " 123 ", "\"foo\"", "true", "null", "-1.5e3", "[]" }) {
+        millijson::SlicedParser parser(x.c_str(), x.size());
+        while (!parser.step(0)) {}
+        auto expected = millijson::parse_string(x.c_str(), x.size());
+        EXPECT_EQ(millijson::serialize_string(*parser.result()), millijson::serialize_string(*expected));
+    }
+}
+
+static void sliced_error(std::string x, std::string msg) {
+    EXPECT_ANY_THROW({
+        try {
+            millijson::SlicedParser parser(x.c_str(), x.size());
+            while (!parser.step(1)) {}
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(SlicedParser, Errors) {
+    sliced_error("", "no JSON value");
+    sliced_error("[1, 2", "unterminated array starting at position 1");
+    sliced_error("{\"a\":1,\"a\":2}", "duplicate keys");
+    sliced_error("[1] x", "trailing non-space characters at position 5");
+    sliced_error("{\"a\" 1}", "expected ':'");
+    sliced_error("[1 2]", "unknown character '2' in array");
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "millijson/source.hpp"
+#include "millijson/generate.hpp"
+
+TEST(SourceDocument, Unmodified) {
+    std::string foo = " {\n  \"a\": [1.50, 2e0],\n  \"b\": \"\\u0041\"\n}\n";
+    millijson::SourceDocument doc(foo);
+    EXPECT_EQ(doc.serialize_string(), foo);
+    EXPECT_EQ(doc.source(), foo);
+    EXPECT_EQ(doc.root()->get_object().at("b")->get_string(), "A");
+    EXPECT_FALSE(doc.dirty(*doc.root()));
+
+    EXPECT_ANY_THROW(millijson::SourceDocument("[1, 2"));
+    EXPECT_ANY_THROW(millijson::SourceDocument("[1] 2"));
+}
+
+TEST(SourceDocument, Modify) {
+    std::string foo = "{\n  \"z\": [1.50, 2e0, {\"x\": 1.0}],\n  \"b\": \"\\u0041\",\n  \"a\": { \"c\" : 3.0 }\n}";
+    millijson::SourceDocument doc(foo);
+
+    auto& arr = doc.modify("/z");
+    EXPECT_TRUE(doc.dirty(*doc.root()));
+    EXPECT_TRUE(doc.dirty(arr));
+    arr.get_array().push_back(std::shared_ptr<millijson::Base>(new millijson::Number(4)));
+
+    // Entries of the dirty root are kept in their original order with their original whitespace, and clean values are copied verbatim.
+    EXPECT_EQ(doc.serialize_string(), "{\n  \"z\": [1.50, 2e0, {\"x\": 1.0}, 4],\n  \"b\": \"\\u0041\",\n  \"a\": { \"c\" : 3.0 }\n}");
+
+    doc.replace("/z/2/x", std::shared_ptr<millijson::Base>(new millijson::String("y")));
+    doc.replace("/z/0", std::shared_ptr<millijson::Base>(new millijson::Boolean(false)));
+    EXPECT_EQ(doc.serialize_string(), "{\n  \"z\": [false, 2e0, {\"x\": \"y\"}, 4],\n  \"b\": \"\\u0041\",\n  \"a\": { \"c\" : 3.0 }\n}");
+
+    // New keys are added after the existing ones.
+    auto& root = doc.modify("");
+    root.get_object().erase("b");
+    static_cast<millijson::Object&>(root).add("0", std::shared_ptr<millijson::Base>(new millijson::Nothing));
+    EXPECT_EQ(doc.serialize_string(), "{\n  \"z\": [false, 2e0, {\"x\": \"y\"}, 4],\n  \"a\": { \"c\" : 3.0 },\n  \"0\": null\n}");
+
+    doc.replace("", std::shared_ptr<millijson::Base>(new millijson::Array));
+    EXPECT_EQ(doc.serialize_string(), "[]");
+}
+
+TEST(SourceDocument, Removed) {
+    // New nodes that reuse the address of a removed node should not be mistaken for the removed node.
+    millijson::SourceDocument doc("[1,   2]");
+    for (int i = 0; i < 10; ++i) {
+        auto& arr = doc.modify("").get_array();
+        arr.pop_back();
+        arr.push_back(std::shared_ptr<millijson::Base>(new millijson::Number(5 + i)));
+        EXPECT_EQ(doc.serialize_string(), "[1,   " + std::to_string(5 + i) + "]");
+    }
+
+    // The document does not keep removed nodes alive.
+    millijson::SourceDocument doc2("[[1], 2]");
+    std::weak_ptr<millijson::Base> first = doc2.root()->get_array().front();
+    doc2.modify("").get_array().erase(doc2.root()->get_array().begin());
+    EXPECT_TRUE(first.expired());
+    EXPECT_EQ(doc2.serialize_string(), "[2]");
+}
+
+TEST(SourceDocument, Order) {
+    // Entries are ordered by their keys, not by their values.
+    {
+        millijson::SourceDocument doc("{\"a\":1,\"b\":2,\"c\":3}");
+        doc.replace("/a", std::shared_ptr<millijson::Base>(new millijson::Number(10)));
+        EXPECT_EQ(doc.serialize_string(), "{\"a\":10,\"b\":2,\"c\":3}");
+    }
+
+    // Whitespace and escaped keys of dirty containers are preserved.
+    {
+        std::string foo = "  { \"a\" : 1 ,\n\t\"\\u0062\" : [ 1 , 2 ] }  ";
+        millijson::SourceDocument doc(foo);
+        doc.replace("/a", std::shared_ptr<millijson::Base>(new millijson::Number(10)));
+        EXPECT_EQ(doc.serialize_string(), "  { \"a\" : 10 ,\n\t\"\\u0062\" : [ 1 , 2 ] }  ");
+        doc.replace("/b/1", std::shared_ptr<millijson::Base>(new millijson::Number(3)));
+        EXPECT_EQ(doc.serialize_string(), "  { \"a\" : 10 ,\n\t\"\\u0062\" : [ 1 , 3 ] }  ");
+
+        auto& root = doc.modify("");
+        static_cast<millijson::Object&>(root).add("c", std::shared_ptr<millijson::Base>(new millijson::Boolean(true)));
+        EXPECT_EQ(doc.serialize_string(), "  { \"a\" : 10 ,\n\t\"\\u0062\" : [ 1 , 3 ] ,\n\t\"c\" : true }  ");
+
+        root.get_object().erase("a");
+        EXPECT_EQ(doc.serialize_string(), "  { \"\\u0062\" : [ 1 , 3 ] ,\n\t\"c\" : true }  ");
+    }
+
+    // Empty containers fall back to compact formatting for new children.
+    {
+        millijson::SourceDocument doc("{ \"a\": [ ], \"b\": { } }");
+        doc.modify("/a").get_array().push_back(std::shared_ptr<millijson::Base>(new millijson::Number(1)));
+        doc.modify("/a").get_array().push_back(std::shared_ptr<millijson::Base>(new millijson::Number(2)));
+        static_cast<millijson::Object&>(doc.modify("/b")).add("x", std::shared_ptr<millijson::Base>(new millijson::Nothing));
+        EXPECT_EQ(doc.serialize_string(), "{ \"a\": [1,2], \"b\": {\"x\":null} }");
+    }
+}
+
+TEST(SourceDocument, Errors) {
+    millijson::SourceDocument doc("{ \"a\": [1], \"b\": 2 }");
+    EXPECT_ANY_THROW(doc.modify("/c"));
+    EXPECT_ANY_THROW(doc.replace("/a/1", nullptr));
+    EXPECT_ANY_THROW(doc.replace("/b/1", nullptr));
+    EXPECT_ANY_THROW(doc.replace("/c", nullptr));
+}
+
+TEST(SourceDocument, Generated) {
+    for (size_t seed = 0; seed < 10; ++seed) {
+        millijson::GenerateOptions opt;
+        opt.seed = seed;
+        opt.size = 5000;
+        opt.pretty = true;
+        auto str = millijson::generate_string(opt);
+
+        millijson::SourceDocument doc(str);
+        EXPECT_EQ(doc.serialize_string(), str);
+
+        doc.replace("/0", std::shared_ptr<millijson::Base>(new millijson::Number(1)));
+        auto output = doc.serialize_string();
+        auto before = millijson::parse_string(str.c_str(), str.size());
+        auto after = millijson::parse_string(output.c_str(), output.size());
+
+        const auto& barray = before->get_array();
+        const auto& aarray = after->get_array();
+        ASSERT_EQ(barray.size(), aarray.size());
+        EXPECT_EQ(aarray[0]->get_number(), 1);
+        for (size_t i = 1; i < barray.size(); ++i) {
+            EXPECT_TRUE(millijson::equal(*(barray[i]), *(aarray[i])));
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include "millijson/generate.hpp"
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+static void usage() {
+    std::cerr << "Usage: millijson-gen [OPTIONS]\n"
+        "\n"
+        "Generate a synthetic JSON document.\n"
+        "\n"
+        "Options:\n"
+        "  --seed INT            Seed for the random number generator (default: 0).\n"
+        "  --depth INT           Maximum nesting depth (default: 3).\n"
+        "  --fanout INT          Maximum number of children per array/object (default: 5).\n"
+        "  --string-length INT   Maximum length of each string (default: 10).\n"
+        "  --escape-density NUM  Probability of escaping each string character (default: 0).\n"
+        "  --numbers KIND        One of 'integers', 'decimals', 'scientific' or 'mixed' (default: mixed).\n"
+        "  --size INT            Target size in bytes, with optional K/M/G suffix (default: single value).\n"
+        "  --ndjson              Generate newline-delimited JSON.\n"
+        "  --pretty              Pretty-print the output.\n"
+        "  --output PATH         Output file (default: stdout).\n";
+}
+
+static unsigned long long parse_integer(const std::string& value) {
+    size_t used = 0;
+    auto output = std::stoull(value, &used);
+    if (used + 1 == value.size()) {
+        switch (value.back()) {
+            case 'K': case 'k': return output << 10;
+            case 'M': case 'm': return output << 20;
+            case 'G': case 'g': return output << 30;
+        }
+    }
+    if (used != value.size()) {
+        throw std::runtime_error("invalid integer '" + value + "'");
+    }
+    return output;
+}
+
+int main(int argc, char** argv) {
+    millijson::GenerateOptions options;
+    std::string output;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                usage();
+                return 0;
+            } else if (arg == "--ndjson") {
+                options.ndjson = true;
+                continue;
+            } else if (arg == "--pretty") {
+                options.pretty = true;
+                continue;
+            }
+
+            if (i + 1 == argc) {
+                throw std::runtime_error("missing value for '" + arg + "'");
+            }
+            std::string value = argv[++i];
+
+            if (arg == "--seed") {
+                options.seed = parse_integer(value);
+            } else if (arg == "--depth") {
+                options.depth = parse_integer(value);
+            } else if (arg == "--fanout") {
+                options.fanout = parse_integer(value);
+            } else if (arg == "--string-length") {
+                options.string_length = parse_integer(value);
+            } else if (arg == "--escape-density") {
+                options.escape_density = std::stod(value);
+            } else if (arg == "--numbers") {
+                if (value == "integers") {
+                    options.numbers = millijson::INTEGERS;
+                } else if (value == "decimals") {
+                    options.numbers = millijson::DECIMALS;
+                } else if (value == "scientific") {
+                    options.numbers = millijson::SCIENTIFIC;
+                } else if (value == "mixed") {
+                    options.numbers = millijson::MIXED;
+                } else {
+                    throw std::runtime_error("unknown number kind '" + value + "'");
+                }
+            } else if (arg == "--size") {
+                options.size = parse_integer(value);
+            } else if (arg == "--output") {
+                output = value;
+            } else {
+                throw std::runtime_error("unknown option '" + arg + "'");
+            }
+        }
+
+        if (output.empty()) {
+            millijson::generate(options, [](const char* ptr, size_t len) -> void {
+                if (std::fwrite(ptr, sizeof(char), len, stdout) != len) {
+                    throw std::runtime_error("failed to write to stdout");
+                }
+            });
+            std::fflush(stdout);
+        } else {
+            millijson::generate_file(options, output.c_str());
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << "millijson-gen: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "millijson/millijson.hpp"
+#include "millijson/corpus.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+static void usage() {
+    std::cerr << "Usage: millijson-index build [OPTIONS] DIRECTORY INDEX\n"
+        "       millijson-index query INDEX [--key PATH] [--value JSON]\n"
+        "\n"
+        "Build an inverted index of the keys and values in a directory of JSON files,\n"
+        "or query an existing index for the files that contain a key and/or value.\n"
+        "\n"
+        "Key paths are JSON pointers in which array elements are represented by '*', e.g., '/a/*/b'.\n"
+        "Values are JSON scalars, e.g., '\"foo\"', '1.5', 'true' or 'null'.\n"
+        "Value queries may report a small fraction of false positives.\n"
+        "\n"
+        "Build options:\n"
+        "  --keys-only       Do not index values.\n"
+        "  --fpr NUM         Target false positive rate for value queries (default: 0.01).\n"
+        "  --threads INT     Number of threads (default: 4).\n"
+        "  --extension EXT   Extension of the files to index (default: .json).\n";
+}
+
+static std::string next_value(int& i, int argc, char** argv) {
+    if (i + 1 == argc) {
+        throw std::runtime_error("missing value for '" + std::string(argv[i]) + "'");
+    }
+    return argv[++i];
+}
+
+static int build(int argc, char** argv) {
+    millijson::CorpusIndexOptions opt;
+    std::vector<std::string> positional;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--keys-only") {
+            opt.values = false;
+        } else if (arg == "--fpr") {
+            opt.false_positive_rate = std::stod(next_value(i, argc, argv));
+        } else if (arg == "--threads") {
+            opt.num_threads = std::stoull(next_value(i, argc, argv));
+        } else if (arg == "--extension") {
+            opt.extension = next_value(i, argc, argv);
+        } else if (arg.rfind("--", 0) == 0) {
+            throw std::runtime_error("unknown option '" + arg + "'");
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        usage();
+        return 1;
+    }
+
+    millijson::CorpusIndex index(opt);
+    auto failed = index.add_directory(positional[0]);
+    for (const auto& f : failed) {
+        std::cerr << "millijson-index: skipping '" << f.first << "': " << f.second << "\n";
+    }
+    index.save(positional[1]);
+    std::cout << "Indexed " << index.size() << " files with " << index.num_keys() << " distinct key paths\n";
+    return 0;
+}
+
+static int query(int argc, char** argv) {
+    std::string path, key, value;
+    bool has_key = false, has_value = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--key") {
+            key = next_value(i, argc, argv);
+            has_key = true;
+        } else if (arg == "--value") {
+            value = next_value(i, argc, argv);
+            has_value = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            throw std::runtime_error("unknown option '" + arg + "'");
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            throw std::runtime_error("unexpected argument '" + arg + "'");
+        }
+    }
+    if (path.empty() || (!has_key && !has_value)) {
+        usage();
+        return 1;
+    }
+
+    millijson::CorpusIndex index;
+    index.load(path);
+
+    std::vector<size_t> hits;
+    if (has_value) {
+        auto parsed = millijson::parse_string(value.data(), value.size());
+        hits = (has_key ? index.with_value(key, *parsed) : index.with_value(*parsed));
+    } else {
+        hits = index.with_key(key);
+    }
+
+    for (auto i : hits) {
+        std::cout << index.name(i) << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::string command = (argc > 1 ? argv[1] : "");
+        if (command == "build") {
+            return build(argc, argv);
+        } else if (command == "query") {
+            return query(argc, argv);
+        } else if (command == "--help" || command == "-h") {
+            usage();
+            return 0;
+        }
+        usage();
+        return 1;
+
+    } catch (std::exception& e) {
+        std::cerr << "millijson-index: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,163 @@
+#include "millijson/millijson.hpp"
+#include "millijson/hints.hpp"
+#include "millijson/profile.hpp"
+#include "millijson/freeze.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+static void usage() {
+    std::cerr << "Usage: millijson-stat [OPTIONS] FILE\n"
+        "\n"
+        "Profile the parsing of a JSON file with each available mode.\n"
+        "\n"
+        "Options:\n"
+        "  --min-time NUM   Minimum time in seconds to spend timing each mode (default: 0.5).\n";
+}
+
+struct Mode {
+    std::string name;
+    std::function<void()> run;
+    bool dom; // whether the mode produces a DOM.
+};
+
+static double time_mode(const Mode& mode, double min_time) {
+    double best = -1, total = 0;
+    do {
+        auto start = std::chrono::steady_clock::now();
+        mode.run();
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+        total += elapsed;
+    } while (total < min_time);
+    return best;
+}
+
+static std::string percent(size_t part, size_t whole) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << (whole ? 100.0 * part / whole : 0.0) << "%";
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    double min_time = 0.5;
+    std::string path;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                usage();
+                return 0;
+            } else if (arg == "--min-time") {
+                if (i + 1 == argc) {
+                    throw std::runtime_error("missing value for '" + arg + "'");
+                }
+                min_time = std::stod(argv[++i]);
+            } else if (path.empty()) {
+                path = arg;
+            } else {
+                throw std::runtime_error("unexpected argument '" + arg + "'");
+            }
+        }
+        if (path.empty()) {
+            usage();
+            return 1;
+        }
+
+        std::string contents;
+        {
+            std::ifstream input(path, std::ios::binary);
+            if (!input) {
+                throw std::runtime_error("failed to open file at '" + path + "'");
+            }
+            std::ostringstream buffer;
+            buffer << input.rdbuf();
+            contents = buffer.str();
+        }
+
+        auto prof = millijson::profile_string(contents.data(), contents.size());
+        size_t nodes = prof.numbers + prof.strings + prof.booleans + prof.nothings + prof.arrays + prof.objects;
+
+        std::cout << "File: " << path << "\n";
+        std::cout << "Size: " << prof.bytes << " bytes\n\n";
+
+        std::cout << "Nodes: " << nodes << "\n";
+        std::cout << "  numbers:  " << prof.numbers << "\n";
+        std::cout << "  strings:  " << prof.strings << "\n";
+        std::cout << "  booleans: " << prof.booleans << "\n";
+        std::cout << "  nulls:    " << prof.nothings << "\n";
+        std::cout << "  arrays:   " << prof.arrays << "\n";
+        std::cout << "  objects:  " << prof.objects << " (" << prof.keys << " keys)\n";
+        std::cout << "Maximum depth: " << prof.max_depth << "\n\n";
+
+        std::cout << "Byte composition:\n";
+        std::cout << "  strings:    " << percent(prof.string_bytes, prof.bytes) << "\n";
+        std::cout << "  numbers:    " << percent(prof.number_bytes, prof.bytes) << "\n";
+        std::cout << "  whitespace: " << percent(prof.whitespace_bytes, prof.bytes) << "\n";
+        std::cout << "  other:      " << percent(prof.bytes - prof.string_bytes - prof.number_bytes - prof.whitespace_bytes, prof.bytes) << "\n";
+        std::cout << "Escape density: " << prof.escapes << " escapes (" << percent(prof.escapes, prof.string_bytes) << " of string bytes)\n\n";
+
+        auto parsed = millijson::parse_string(contents.data(), contents.size());
+        auto frozen = millijson::freeze(*parsed);
+        std::cout << "Memory footprint:\n";
+        std::cout << "  DOM:    " << prof.dom_bytes << " bytes (" << std::fixed << std::setprecision(1) << (prof.bytes ? static_cast<double>(prof.dom_bytes) / prof.bytes : 0.0) << "x file size)\n";
+        std::cout << "  frozen: " << frozen.memory() << " bytes\n\n";
+        parsed.reset();
+
+        millijson::CapacityHints hints;
+        millijson::parse_string(contents.data(), contents.size(), hints); // warming up the hints.
+
+        std::vector<Mode> modes;
+        for (size_t buffer_size : { 4096, 65536, 1048576 }) {
+            modes.push_back(Mode{ "parse_file (" + std::to_string(buffer_size / 1024) + " KB buffer)", [&path,buffer_size]() -> void { millijson::parse_file(path.c_str(), buffer_size); }, true });
+        }
+        modes.push_back(Mode{ "parse_string (in memory)", [&contents]() -> void { millijson::parse_string(contents.data(), contents.size()); }, true });
+        modes.push_back(Mode{ "parse_string (capacity hints)", [&contents,&hints]() -> void { millijson::parse_string(contents.data(), contents.size(), hints); }, true });
+        modes.push_back(Mode{ "validate_file (no DOM)", [&path]() -> void { millijson::validate_file(path.c_str()); }, false });
+        modes.push_back(Mode{ "validate_string (no DOM)", [&contents]() -> void { millijson::validate_string(contents.data(), contents.size()); }, false });
+
+        std::cout << "Throughput:\n";
+        size_t width = 0;
+        for (const auto& m : modes) {
+            width = std::max(width, m.name.size());
+        }
+
+        const Mode* fastest = nullptr;
+        double fastest_time = 0;
+        for (const auto& m : modes) {
+            double best = time_mode(m, min_time);
+            double mbps = (best > 0 ? prof.bytes / best / 1e6 : 0);
+            std::cout << "  " << std::left << std::setw(width) << m.name << "  " << std::right << std::setw(10) << std::setprecision(1) << mbps << " MB/s\n";
+            if (m.dom && (!fastest || best < fastest_time)) {
+                fastest = &m;
+                fastest_time = best;
+            }
+        }
+
+        std::cout << "\nRecommendations:\n";
+        std::cout << "  - Fastest mode for this file: " << fastest->name << "\n";
+        if (prof.dom_bytes > 2 * frozen.memory()) {
+            std::cout << "  - For long-lived documents, freeze() reduces memory usage by " << std::setprecision(1) << static_cast<double>(prof.dom_bytes) / frozen.memory() << "x\n";
+        }
+        if (prof.whitespace_bytes > prof.bytes / 4) {
+            std::cout << "  - Over a quarter of this file is whitespace; minifying it would reduce parse time\n";
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << "millijson-stat: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}